@@ -0,0 +1,92 @@
+// insert, lookup, iteration and memory per entry for PyDict, with the
+// std::map<string, PyObject> it replaced as the baseline
+// usage: ./dict-bench [n]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include "pyobject.h"
+#include "pydict.h"
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+double ns_per_op(Clock::time_point start, int n) {
+    return chrono::duration<double, nano>(Clock::now() - start).count() / n;
+}
+
+void report(string name, double insert, double lookup, double iterate, double bytes) {
+    cout << left << setw(22) << name << right << fixed << setprecision(1)
+         << setw(12) << insert << setw(12) << lookup << setw(12) << iterate 
+         << setw(14) << bytes << endl;
+}
+
+void bench_pydict(string name, const vector<PyObject>& keys) {
+    int n = keys.size();
+    PyDict dict;
+    Clock::time_point start = Clock::now();
+    for (int i=0; i < n; i++) dict.set(keys[i], keys[i]);
+    double insert = ns_per_op(start, n);
+
+    start = Clock::now();
+    int found = 0;
+    for (int i=0; i < n; i++) found += dict.find(keys[i]) != nullptr;
+    double lookup = ns_per_op(start, n);
+
+    start = Clock::now();
+    int seen = 0;
+    for (const PyDict::Entry& e : dict.entries()) seen += e.value.type.size() > 0;
+    double iterate = ns_per_op(start, n);
+
+    if (found != n || seen != n) cout << "ERROR: " << found << " " << seen << endl;
+    report(name, insert, lookup, iterate, (double)dict.memory_usage() / n);
+}
+
+void bench_map(string name, const vector<PyObject>& keys) {
+    int n = keys.size();
+    // the old layout could only key by string
+    vector<string> skeys;
+    for (const PyObject& k : keys) skeys.push_back(k.as_string());
+    map<string, PyObject> m;
+    Clock::time_point start = Clock::now();
+    for (int i=0; i < n; i++) m[skeys[i]] = keys[i];
+    double insert = ns_per_op(start, n);
+
+    start = Clock::now();
+    int found = 0;
+    for (int i=0; i < n; i++) found += m.find(skeys[i]) != m.end();
+    double lookup = ns_per_op(start, n);
+
+    start = Clock::now();
+    int seen = 0;
+    for (auto& it : m) seen += it.second.type.size() > 0;
+    double iterate = ns_per_op(start, n);
+
+    // red-black node: 3 pointers and a color, plus malloc's 16 byte header
+    double node = 32 + sizeof(string) + sizeof(PyObject) + 16;
+    if (found != n || seen != n) cout << "ERROR: " << found << " " << seen << endl;
+    report(name, insert, lookup, iterate, node);
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? stoi(argv[1]) : 100000;
+
+    vector<PyObject> int_keys, str_keys;
+    for (int i=0; i < n; i++) {
+        // spread out so neither structure gets sequential keys for free
+        int k = (int)((unsigned)i * 2654435761u >> 1);
+        int_keys.push_back(PyObject(k, "int"));
+        str_keys.push_back(PyObject("key" + to_string(k), "str"));
+    }
+
+    cout << "n = " << n << ", sizeof(PyObject) = " << sizeof(PyObject) << endl;
+    cout << left << setw(22) << "" << right << setw(12) << "insert ns" << setw(12) << "lookup ns"
+         << setw(12) << "iterate ns" << setw(14) << "bytes/entry" << endl;
+    bench_pydict("PyDict int keys", int_keys);
+    bench_pydict("PyDict str keys", str_keys);
+    bench_map("std::map str keys", str_keys);
+    return 0;
+}
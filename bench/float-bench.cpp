@@ -0,0 +1,69 @@
+// str(float) through PyObject against the old to_string based formatting,
+// and how many of each read back as the same double
+// usage: ./float-bench [n]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include "pyobject.h"
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+double ns_per_op(Clock::time_point start, int n) {
+    return chrono::duration<double, nano>(Clock::now() - start).count() / n;
+}
+
+// what as_string() did before, six fixed decimals with the zeros cut
+string old_format(double d) {
+    string s = to_string((float)d);
+    s = s.substr(0, s.find_last_not_of('0')+1);
+    if (s.find('.') == s.size()-1) {
+        s += '0';
+    }
+    return s;
+}
+
+void report(string name, const vector<double>& values, string (*format)(double)) {
+    int n = values.size();
+    size_t chars = 0;
+    Clock::time_point start = Clock::now();
+    for (double d : values) chars += format(d).size();
+    double ns = ns_per_op(start, n);
+
+    int exact = 0;
+    for (double d : values) exact += strtod(format(d).c_str(), nullptr) == d;
+    cout << left << setw(18) << name << right << fixed << setprecision(1)
+         << setw(10) << ns << setw(12) << (double)chars / n
+         << setw(13) << 100.0 * exact / n << "%" << endl;
+}
+
+string new_format(double d) {
+    return PyObject(d, "float").as_string();
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? stoi(argv[1]) : 1000000;
+
+    // short decimals like prices, and full precision values over a wide range
+    vector<double> simple, full;
+    unsigned x = 12345;
+    for (int i=0; i < n; i++) {
+        x = x * 1103515245u + 12345u;
+        simple.push_back((x % 100000) / 100.0);
+        full.push_back((x / 4294967296.0) * pow(10.0, (int)(x % 13) - 6));
+    }
+
+    cout << "n = " << n << endl;
+    cout << left << setw(18) << "" << right << setw(10) << "ns/op" << setw(12) << "chars"
+         << setw(14) << "round trips" << endl;
+    report("old simple", simple, old_format);
+    report("repr simple", simple, new_format);
+    report("old full", full, old_format);
+    report("repr full", full, new_format);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// tokenizer and parser throughput on generated sources of growing size:
+// tokens/s and MB/s for Tokenizer, the time strip() takes after it,
+// nodes/s for Parser::parse and the peak RSS of each size. The source
+// repeats a block of defs, nested expressions, strings and comments
+// with the names numbered so nothing is identical
+// usage: ./frontend-bench [size ...]    sizes like 1K 1M 100M, default 1K 1M
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <sys/resource.h>
+#include "tokenizer.h"
+#include "parser.h"
+#include "ast.h"
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// lines end in '\r' like read_lines() leaves them
+vector<string> generate_source(size_t bytes) {
+    vector<string> lines;
+    size_t size = 0;
+    for (int n=0; size < bytes; n++) {
+        string i = to_string(n);
+        vector<string> block = {
+            "# helper " + i + ", the comments are skipped but still tokenized",
+            "def helper_" + i + "(a, b, c):",
+            "    total = (a + b * " + i + ") // (c - 1) % 7 - (-a)",
+            "    name = 'helper number " + i + "' + \"with a 'nested' quote\"",
+            "    items = [a, b, c, {\"key_" + i + "\": total, 'other': [1, 2.5, 3e-05]}]",
+            "    if total > " + i + " and not (a == b or b != c):",
+            "        for k in range(a, b):",
+            "            # comments only on their own line, a trailing one does not parse yet",
+            "            total += items[0] * k",
+            "    elif a <= b < c:",
+            "        total = helper_" + i + "(b, c, a) + len(items) - sum([a, b], " + i + ")",
+            "    return total << 2 | a & b ^ c",
+            "",
+        };
+        for (string& line : block) {
+            size += line.size() + 1;
+            lines.push_back(line + "\r");
+        }
+    }
+    return lines;
+}
+
+// high water mark since the last reset, the kernel clears it when '5'
+// is written to clear_refs. falls back to ru_maxrss (whole run) if not
+void reset_peak_rss() {
+    ofstream clear_refs("/proc/self/clear_refs");
+    if (clear_refs) clear_refs << "5";
+}
+
+long peak_rss_kb() {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.find("VmHWM:") == 0) {
+            return stol(line.substr(6));
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+size_t parse_size(string s) {
+    size_t scale = 1;
+    char suffix = toupper(s.back());
+    if (suffix == 'K') scale = 1 << 10;
+    if (suffix == 'M') scale = 1 << 20;
+    if (suffix == 'G') scale = 1 << 30;
+    if (scale > 1) s.pop_back();
+    return stoull(s) * scale;
+}
+
+int main(int argc, char** argv) {
+    vector<string> sizes;
+    for (int i=1; i < argc; i++) sizes.push_back(argv[i]);
+    if (sizes.size() == 0) sizes = {"1K", "1M"};
+
+    cout << left << setw(8) << "size" << right << setw(10) << "tokens"
+         << setw(12) << "tokens/s" << setw(8) << "MB/s" << setw(10) << "strip s"
+         << setw(10) << "nodes" << setw(12) << "nodes/s" << setw(12) << "peak RSS" << endl;
+    for (const string& size : sizes) {
+        reset_peak_rss();
+        vector<string> source = generate_source(parse_size(size));
+        size_t bytes = 0;
+        for (const string& line : source) bytes += line.size();
+
+        // size() is the count before strip(), every token the tokenizer made
+        Clock::time_point start = Clock::now();
+        Tokenizer tokenizer(source);
+        double tokenize_time = seconds(start);
+        int tokens = tokenizer.size();
+        start = Clock::now();
+        tokenizer.strip();
+        double strip_time = seconds(start);
+
+        size_t created = AST::created;
+        start = Clock::now();
+        Parser parser(&tokenizer);
+        AST* tree = parser.parse("file");
+        double parse_time = seconds(start);
+        size_t nodes = AST::created - created;
+        long rss = peak_rss_kb();
+        delete tree;
+
+        cout << left << setw(8) << size << right << setw(10) << tokens
+             << fixed << setprecision(0) << setw(12) << tokens / tokenize_time
+             << setprecision(2) << setw(8) << bytes / tokenize_time / (1 << 20)
+             << setprecision(3) << setw(10) << strip_time
+             << setw(10) << nodes << setprecision(0) << setw(12) << nodes / parse_time
+             << setw(9) << rss / 1024 << " MB" << endl;
+    }
+    return 0;
+}
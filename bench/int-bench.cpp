@@ -0,0 +1,83 @@
+// small int arithmetic through PyObject, which has to stay as fast as the
+// plain int path it replaced, and BigInt multiply and to_string as the
+// numbers grow
+// usage: ./int-bench [n]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "pyobject.h"
+#include "bigint.h"
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+double ns_per_op(Clock::time_point start, int n) {
+    return chrono::duration<double, nano>(Clock::now() - start).count() / n;
+}
+
+void bench_small(const vector<PyObject>& a, const vector<PyObject>& b) {
+    int n = a.size();
+    int checks = 0;
+
+    Clock::time_point start = Clock::now();
+    for (int i=0; i < n; i++) checks += (a[i] + b[i]).type.size();
+    double add = ns_per_op(start, n);
+
+    start = Clock::now();
+    for (int i=0; i < n; i++) checks += (a[i] * b[i]).type.size();
+    double mul = ns_per_op(start, n);
+
+    start = Clock::now();
+    for (int i=0; i < n; i++) checks += a[i].floordiv(b[i]).type.size();
+    double div = ns_per_op(start, n);
+
+    start = Clock::now();
+    for (int i=0; i < n; i++) checks += (a[i] < b[i]).as_bool();
+    double less = ns_per_op(start, n);
+
+    if (checks == 0) cout << "ERROR" << endl;
+    cout << fixed << setprecision(1)
+         << "small int ns/op:  +" << setw(7) << add << "   *" << setw(7) << mul
+         << "   //" << setw(7) << div << "   <" << setw(7) << less << endl;
+}
+
+// 'digits' decimal digits, multiplied by itself and printed back
+void bench_big(int digits) {
+    string s = "";
+    for (int i=0; i < digits; i++) s += (char)('1' + (i * 7) % 9);
+    BigInt x = BigInt::from_string(s);
+
+    int reps = digits < 1000 ? 2000 : digits < 10000 ? 50 : 3;
+    Clock::time_point start = Clock::now();
+    BigInt product;
+    for (int i=0; i < reps; i++) product = x * x;
+    double mul = ns_per_op(start, reps) / 1000;
+
+    start = Clock::now();
+    string back = x.to_string();
+    double str = ns_per_op(start, 1) / 1000;
+
+    if (back != s) cout << "ERROR: to_string round trip" << endl;
+    cout << setw(8) << digits << setw(14) << mul << setw(14) << str << endl;
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? stoi(argv[1]) : 1000000;
+
+    vector<PyObject> a, b;
+    for (int i=0; i < n; i++) {
+        a.push_back(PyObject((int)((unsigned)i * 2654435761u % 1000003u), "int"));
+        b.push_back(PyObject((int)((unsigned)i * 40503u % 997u) + 1, "int"));
+    }
+    cout << "n = " << n << endl;
+    bench_small(a, b);
+
+    cout << endl << setw(8) << "digits" << setw(14) << "x*x us" << setw(14) << "to_string us" << endl;
+    for (int digits : {100, 1000, 3000, 10000, 30000}) {
+        bench_big(digits);
+    }
+    return 0;
+}
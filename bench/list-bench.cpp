@@ -0,0 +1,68 @@
+// memory per item, iteration, sum and sort for packed int and float
+// lists against the same numbers boxed in generic PyObject storage
+// usage: ./list-bench [n]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "pyobject.h"
+#include "pylist.h"
+#include "builtins.h"
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+double ns_per_op(Clock::time_point start, int n) {
+    return chrono::duration<double, nano>(Clock::now() - start).count() / n;
+}
+
+void report(string name, double iterate, double total, double sort, double bytes) {
+    cout << left << setw(22) << name << right << fixed << setprecision(1)
+         << setw(12) << iterate << setw(12) << total << setw(12) << sort 
+         << setw(14) << bytes << endl;
+}
+
+void bench_list(string name, const vector<PyObject>& numbers, bool pack) {
+    int n = numbers.size();
+    PyObject list = PyObject(PyList(numbers, pack), "list");
+
+    Clock::time_point start = Clock::now();
+    int64_t idx = 0;
+    int seen = 0;
+    PyObject item;
+    while (list.iter_next(idx, item)) seen += item.type.size() > 0;
+    double iterate = ns_per_op(start, n);
+
+    start = Clock::now();
+    PyObject total = sum(&list, 1, nullptr);
+    double summed = ns_per_op(start, n);
+
+    start = Clock::now();
+    PyObject ordered = sorted(&list, 1, nullptr);
+    double sort = ns_per_op(start, n);
+
+    if (seen != n || ordered.size() != n) cout << "ERROR: " << seen << " " << ordered.size() << endl;
+    report(name, iterate, summed, sort, (double)list.as_list().memory_usage() / n);
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? stoi(argv[1]) : 1000000;
+
+    vector<PyObject> ints, floats;
+    for (int i=0; i < n; i++) {
+        int k = (int)((unsigned)i * 2654435761u % 1000003u);
+        ints.push_back(PyObject(k, "int"));
+        floats.push_back(PyObject(k * 0.5, "float"));
+    }
+
+    cout << "n = " << n << ", sizeof(PyObject) = " << sizeof(PyObject) << endl;
+    cout << left << setw(22) << "" << right << setw(12) << "iterate ns" << setw(12) << "sum ns"
+         << setw(12) << "sort ns" << setw(14) << "bytes/item" << endl;
+    bench_list("packed ints", ints, true);
+    bench_list("boxed ints", ints, false);
+    bench_list("packed floats", floats, true);
+    bench_list("boxed floats", floats, false);
+    return 0;
+}
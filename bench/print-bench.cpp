@@ -0,0 +1,58 @@
+// prints n lines through the print builtin and through the old
+// 'cout << ... << endl' path, which flushed every line. Output goes to
+// stdout so it can be pointed at a file, a pipe or /dev/null, the
+// timings go to stderr
+// usage: ./print-bench [n] > /dev/null
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "pyobject.h"
+#include "builtins.h"
+#include "output.h"
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+double seconds(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// the print builtin before the buffered output, and before builtins
+// took their arguments as a span
+void old_print(PyObject arguments) {
+    for (int i=0; i < arguments.size(); i++) {
+        if (i > 0) cout << " ";
+        cout << arguments.at(i).as_string();
+    }
+    cout << endl;
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? stoi(argv[1]) : 10000000;
+    PyObject line = PyObject("line", "str");
+
+    vector<PyObject> args = {line, PyObject(0, "int")};
+    Clock::time_point start = Clock::now();
+    for (int i=0; i < n; i++) {
+        args[1] = PyObject(i, "int");
+        old_print(PyObject(args, "tuple"));
+    }
+    double old_path = seconds(start);
+
+    start = Clock::now();
+    for (int i=0; i < n; i++) {
+        args[1] = PyObject(i, "int");
+        print(args.data(), args.size(), nullptr);
+    }
+    Output::get_instance()->flush();
+    double buffered = seconds(start);
+
+    cerr << "n = " << n << (Output::get_instance()->is_line_buffered() ? ", line" : ", block")
+         << " buffered" << endl << fixed << setprecision(2)
+         << "old print      " << setw(8) << old_path << " s" << endl
+         << "print()        " << setw(8) << buffered << " s" << endl;
+    return 0;
+}
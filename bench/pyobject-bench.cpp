@@ -0,0 +1,129 @@
+// nanoseconds and allocations per call for the PyObject basics: making
+// and copying values, operator+ on every pair of types, as_string,
+// as_bool, at and the print builtin. Run it before and after touching
+// PyObject's layout
+// usage: ./pyobject-bench [--min-time=MS] [--samples=N] [case ...]
+
+#define BENCH_MAIN
+#include "bench.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "pyobject.h"
+#include "pydict.h"
+#include "pyset.h"
+#include "builtins.h"
+#include "output.h"
+using namespace std;
+
+// one value of each kind, built once
+vector<pair<string, PyObject>> samples() {
+    PyDict dict;
+    dict.set(PyObject(string("a"), "str"), PyObject(1, "int"));
+    PySet set;
+    set.insert(PyObject(1, "int"));
+    set.insert(PyObject(2, "int"));
+    vector<PyObject> ints = {PyObject(1, "int"), PyObject(2, "int"), PyObject(3, "int")};
+    vector<PyObject> mixed = {PyObject(1, "int"), PyObject(string("x"), "str")};
+    return {
+        {"None", PyObject()},
+        {"int", PyObject(42, "int")},
+        {"big int", PyObject((int64_t)INT64_MAX, "int") + PyObject(1, "int")},
+        {"float", PyObject(1.5, "float")},
+        {"bool", PyObject(true, "bool")},
+        {"str", PyObject(string("hello"), "str")},
+        {"list", PyObject(mixed, "list")},
+        {"list of ints", PyObject(ints, "list")},
+        {"tuple", PyObject(mixed, "tuple")},
+        {"dict", PyObject(dict, "dict")},
+        {"set", PyObject(set, "set")},
+    };
+}
+
+// swallows the output of the print benchmarks
+class NullBuffer : public streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+        streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+BENCH_CASE("construct") {
+    vector<PyObject> ints = {PyObject(1, "int"), PyObject(2, "int"), PyObject(3, "int")};
+    bench.measure("None", [] { return PyObject(); });
+    bench.measure("int", [] { return PyObject(42, "int"); });
+    bench.measure("float", [] { return PyObject(1.5, "float"); });
+    bench.measure("bool", [] { return PyObject(true, "bool"); });
+    bench.measure("str", [] { return PyObject(string("hello"), "str"); });
+    bench.measure("list of 3 ints", [&] { return PyObject(ints, "list"); });
+    bench.measure("empty dict", [] { return PyObject(PyDict(), "dict"); });
+}
+
+BENCH_CASE("copy") {
+    for (auto& sample : samples()) {
+        const PyObject& value = sample.second;
+        bench.measure(sample.first, [&] { return PyObject(value); });
+    }
+}
+
+// unsupported pairs are timed too, raising the TypeError is their cost
+BENCH_CASE("operator+") {
+    vector<pair<string, PyObject>> values = samples();
+    for (auto& a : values) {
+        for (auto& b : values) {
+            const PyObject& x = a.second;
+            const PyObject& y = b.second;
+            string name = a.first + " + " + b.first;
+            try {
+                x + y;
+            } catch (runtime_error&) {
+                name += " (raises)";
+            }
+            bench.measure(name, [&] {
+                try {
+                    return x + y;
+                } catch (runtime_error&) {
+                    return PyObject();
+                }
+            });
+        }
+    }
+}
+
+BENCH_CASE("as_string") {
+    for (auto& sample : samples()) {
+        const PyObject& value = sample.second;
+        bench.measure(sample.first, [&] { return value.as_string(); });
+    }
+}
+
+BENCH_CASE("as_bool") {
+    for (auto& sample : samples()) {
+        const PyObject& value = sample.second;
+        bench.measure(sample.first, [&] { return value.as_bool(); });
+    }
+}
+
+BENCH_CASE("at") {
+    for (auto& sample : samples()) {
+        const PyObject& value = sample.second;
+        if (value.type == "list" || value.type == "tuple" || value.type == "str") {
+            bench.measure(sample.first + "[1]", [&] { return value.at(1); });
+        }
+    }
+}
+
+BENCH_CASE("print") {
+    NullBuffer null;
+    streambuf* old = cout.rdbuf(&null);
+    vector<PyObject> one = {PyObject(42, "int")};
+    vector<PyObject> line = {PyObject(string("line"), "str"), PyObject(7, "int")};
+    vector<PyObject> list = {samples().at(6).second};
+    bench.measure("print(42)", [&] { return print(one.data(), one.size(), nullptr); });
+    bench.measure("print('line', 7)", [&] { return print(line.data(), line.size(), nullptr); });
+    bench.measure("print([1, 'x'])", [&] { return print(list.data(), list.size(), nullptr); });
+    Output::get_instance()->flush();
+    cout.rdbuf(old);
+}
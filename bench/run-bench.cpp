@@ -0,0 +1,269 @@
+// times the scripts in bench/workloads with ./mypy, after some warmup
+// runs, and reports the median and spread of the repetitions. Results
+// are written to JSON, named after the commit by default, so runs on two
+// commits can be compared with --compare. --perf runs mypy with
+// --perf-counters and adds IPC and misses per 1000 instructions (medians
+// over the repetitions) where the machine has the counters
+// usage: ./run-bench [--warmups=N] [--reps=N] [--json=FILE] [--perf]
+//                    [--compare=FILE] [--mypy=PATH] [workload ...]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <filesystem>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+#define WORKLOAD_DIR "bench/workloads"
+
+struct Result {
+    string name;
+    vector<double> times;
+    double median;
+    double mean;
+    double stddev;
+    double min;
+    // median of each hardware counter mypy reported, by name
+    map<string, double> counters;
+};
+
+// stdout of a shell command, "" and status -1 if it could not be run
+string capture(string command, int* status = nullptr) {
+    string out;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe == nullptr) {
+        if (status != nullptr) *status = -1;
+        return out;
+    }
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        out.append(buffer, n);
+    }
+    int exit_status = pclose(pipe);
+    if (status != nullptr) *status = exit_status;
+    return out;
+}
+
+string current_commit() {
+    string commit = capture("git rev-parse --short HEAD 2>/dev/null");
+    while (commit.size() > 0 && isspace(commit.back())) commit.pop_back();
+    if (commit == "") {
+        return "unknown";
+    }
+    if (capture("git status --porcelain --untracked-files=no 2>/dev/null") != "") {
+        commit += "-dirty";
+    }
+    return commit;
+}
+
+// one run of the interpreter, output is read through a pipe so printing
+// costs the same on every run. a python exception is printed, not
+// returned, so the output is checked for it
+double run_once(string mypy, string script, string* output = nullptr) {
+    int status;
+    Clock::time_point start = Clock::now();
+    string out = capture(mypy + " " + script + " 2>&1", &status);
+    if (output != nullptr) *output = out;
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+    if (status != 0 || out.find("exception: ") != string::npos) {
+        size_t at = out.find("exception: ");
+        throw runtime_error(script + " failed"
+                            + (at == string::npos ? "" : ": " + out.substr(at, out.find('\n', at) - at)));
+    }
+    return seconds;
+}
+
+// the 'perf-counters: name=value ...' line --perf-counters ends with
+map<string, double> parse_counters(const string& out) {
+    map<string, double> counters;
+    size_t at = out.rfind("perf-counters:");
+    if (at == string::npos) {
+        return counters;
+    }
+    stringstream line(out.substr(at + 14, out.find('\n', at) - at - 14));
+    string field;
+    while (line >> field) {
+        size_t eq = field.find('=');
+        if (eq != string::npos) counters[field.substr(0, eq)] = stod(field.substr(eq + 1));
+    }
+    return counters;
+}
+
+double median(vector<double> values) {
+    sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 == 1 ? values[n/2] : (values[n/2 - 1] + values[n/2]) / 2;
+}
+
+// '-' when the counters it needs were not reported
+string ratio_column(const map<string, double>& counters, string numerator, string denominator, double scale) {
+    auto n = counters.find(numerator);
+    auto d = counters.find(denominator);
+    if (n == counters.end() || d == counters.end() || d->second == 0) {
+        return "-";
+    }
+    stringstream out;
+    out << fixed << setprecision(2) << scale * n->second / d->second;
+    return out.str();
+}
+
+Result summarize(string name, vector<double> times) {
+    Result result;
+    result.name = name;
+    result.times = times;
+    sort(times.begin(), times.end());
+    size_t n = times.size();
+    result.median = median(times);
+    result.min = times.front();
+    double sum = 0;
+    for (double t : times) sum += t;
+    result.mean = sum / n;
+    double squares = 0;
+    for (double t : times) squares += (t - result.mean) * (t - result.mean);
+    result.stddev = n > 1 ? sqrt(squares / (n - 1)) : 0;
+    return result;
+}
+
+void write_json(string path, string commit, int warmups, int reps, const vector<Result>& results) {
+    ofstream out(path);
+    out << setprecision(6) << fixed;
+    out << "{" << endl
+        << "  \"commit\": \"" << commit << "\"," << endl
+        << "  \"warmups\": " << warmups << "," << endl
+        << "  \"repetitions\": " << reps << "," << endl
+        << "  \"workloads\": {" << endl;
+    for (size_t i=0; i < results.size(); i++) {
+        const Result& r = results.at(i);
+        out << "    \"" << r.name << "\": {\"median\": " << r.median
+            << ", \"mean\": " << r.mean << ", \"stddev\": " << r.stddev
+            << ", \"min\": " << r.min << ", \"times\": [";
+        for (size_t j=0; j < r.times.size(); j++) {
+            out << (j > 0 ? ", " : "") << r.times.at(j);
+        }
+        out << "]";
+        if (r.counters.size() > 0) {
+            out << ", \"counters\": {";
+            for (auto it = r.counters.begin(); it != r.counters.end(); it++) {
+                out << (it != r.counters.begin() ? ", " : "") << "\"" << it->first << "\": "
+                    << setprecision(0) << it->second << setprecision(6);
+            }
+            out << "}";
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    out << "  }" << endl << "}" << endl;
+}
+
+// the median recorded for a workload in an earlier run's JSON, -1 when
+// it is not there. the file is one this program wrote, so finding the
+// key is enough
+double baseline_median(const string& json, string name) {
+    string key = "\"" + name + "\": {\"median\": ";
+    size_t at = json.find(key);
+    if (at == string::npos) {
+        return -1;
+    }
+    return strtod(json.c_str() + at + key.size(), nullptr);
+}
+
+int main(int argc, char** argv) {
+    int warmups = 1;
+    int reps = 5;
+    string mypy = "./mypy";
+    string json_path = "";
+    string compare_path = "";
+    bool perf = false;
+    vector<string> names;
+    for (int i=1; i < argc; i++) {
+        string arg = argv[i];
+        string value = arg.substr(arg.find('=') + 1);
+        if (arg.find("--warmups=") == 0) warmups = stoi(value);
+        else if (arg.find("--reps=") == 0) reps = max(1, stoi(value));
+        else if (arg.find("--json=") == 0) json_path = value;
+        else if (arg.find("--compare=") == 0) compare_path = value;
+        else if (arg.find("--mypy=") == 0) mypy = value;
+        else if (arg == "--perf") perf = true;
+        else names.push_back(arg);
+    }
+    if (names.size() == 0) {
+        for (const auto& entry : filesystem::directory_iterator(WORKLOAD_DIR)) {
+            if (entry.path().extension() == ".py") {
+                names.push_back(entry.path().stem().string());
+            }
+        }
+        sort(names.begin(), names.end());
+    }
+
+    string commit = current_commit();
+    if (json_path == "") {
+        json_path = "bench-" + commit + ".json";
+    }
+    string baseline = "";
+    if (compare_path != "") {
+        ifstream in(compare_path);
+        if (!in) {
+            cerr << "could not read '" << compare_path << "'" << endl;
+            return 1;
+        }
+        stringstream contents;
+        contents << in.rdbuf();
+        baseline = contents.str();
+    }
+
+    cout << "commit " << commit << ", " << warmups << " warmup(s), " << reps << " repetition(s)" << endl
+         << left << setw(16) << "workload" << right << setw(10) << "median s"
+         << setw(10) << "stddev s" << setw(10) << "min s"
+         << (perf ? "       IPC br-miss/k  $-miss/k" : "")
+         << (baseline != "" ? "  vs " + compare_path : "") << endl;
+
+    vector<Result> results;
+    for (const string& name : names) {
+        string script = string(WORKLOAD_DIR) + "/" + name + ".py";
+        string command = perf ? mypy + " --perf-counters" : mypy;
+        vector<double> times;
+        map<string, vector<double>> counters;
+        try {
+            for (int i=0; i < warmups; i++) run_once(command, script);
+            for (int i=0; i < reps; i++) {
+                string out;
+                times.push_back(run_once(command, script, &out));
+                for (auto& it : parse_counters(out)) counters[it.first].push_back(it.second);
+            }
+        }
+        catch (exception& e) {
+            cout << left << setw(16) << name << e.what() << endl;
+            continue;
+        }
+        Result r = summarize(name, times);
+        for (auto& it : counters) r.counters[it.first] = median(it.second);
+        results.push_back(r);
+        cout << left << setw(16) << name << right << fixed << setprecision(3)
+             << setw(10) << r.median << setw(10) << r.stddev << setw(10) << r.min;
+        if (perf) {
+            cout << setw(10) << ratio_column(r.counters, "instructions", "cycles", 1)
+                 << setw(10) << ratio_column(r.counters, "branch-misses", "instructions", 1000)
+                 << setw(10) << ratio_column(r.counters, "cache-misses", "instructions", 1000);
+        }
+        double old = baseline != "" ? baseline_median(baseline, name) : -1;
+        if (old > 0) {
+            double ratio = old / r.median;
+            cout << "  " << setprecision(2) << (ratio >= 1 ? ratio : 1 / ratio) << "x "
+                 << (ratio >= 1 ? "faster" : "slower");
+        }
+        cout << endl;
+    }
+    write_json(json_path, commit, warmups, reps, results);
+    cout << "results written to " << json_path << endl;
+    return results.size() == names.size() ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+// insert, hit and miss lookups, union and memory per entry for PySet,
+// with a PyDict used as a set as the baseline
+// usage: ./set-bench [n]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "pyobject.h"
+#include "pydict.h"
+#include "pyset.h"
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+double ns_per_op(Clock::time_point start, int n) {
+    return chrono::duration<double, nano>(Clock::now() - start).count() / n;
+}
+
+void report(string name, double insert, double hit, double miss, double merge, double bytes) {
+    cout << left << setw(22) << name << right << fixed << setprecision(1)
+         << setw(12) << insert << setw(12) << hit << setw(12) << miss 
+         << setw(12) << merge << setw(14) << bytes << endl;
+}
+
+void bench_pyset(string name, const vector<PyObject>& keys, const vector<PyObject>& misses) {
+    int n = keys.size();
+    PySet set;
+    Clock::time_point start = Clock::now();
+    for (int i=0; i < n; i++) set.insert(keys[i]);
+    double insert = ns_per_op(start, n);
+
+    start = Clock::now();
+    int found = 0;
+    for (int i=0; i < n; i++) found += set.contains(keys[i]);
+    double hit = ns_per_op(start, n);
+
+    start = Clock::now();
+    int missed = 0;
+    for (int i=0; i < n; i++) missed += !set.contains(misses[i]);
+    double miss = ns_per_op(start, n);
+
+    PySet other;
+    for (int i=0; i < n; i += 2) other.insert(misses[i]);
+    start = Clock::now();
+    PySet merged = PySet::set_union(set, other);
+    double merge = ns_per_op(start, n + n/2);
+
+    if (found != n || missed != n || merged.size() != n + n/2) {
+        cout << "ERROR: " << found << " " << missed << " " << merged.size() << endl;
+    }
+    report(name, insert, hit, miss, merge, (double)set.memory_usage() / n);
+}
+
+void bench_pydict(string name, const vector<PyObject>& keys, const vector<PyObject>& misses) {
+    int n = keys.size();
+    PyObject none;
+    PyDict dict;
+    Clock::time_point start = Clock::now();
+    for (int i=0; i < n; i++) dict.set(keys[i], none);
+    double insert = ns_per_op(start, n);
+
+    start = Clock::now();
+    int found = 0;
+    for (int i=0; i < n; i++) found += dict.find(keys[i]) != nullptr;
+    double hit = ns_per_op(start, n);
+
+    start = Clock::now();
+    int missed = 0;
+    for (int i=0; i < n; i++) missed += dict.find(misses[i]) == nullptr;
+    double miss = ns_per_op(start, n);
+
+    PyDict other;
+    for (int i=0; i < n; i += 2) other.set(misses[i], none);
+    start = Clock::now();
+    PyDict merged = dict;
+    for (const PyDict::Entry& e : other.entries()) merged.set(e.key, e.value);
+    double merge = ns_per_op(start, n + n/2);
+
+    if (found != n || missed != n || merged.size() != n + n/2) {
+        cout << "ERROR: " << found << " " << missed << " " << merged.size() << endl;
+    }
+    report(name, insert, hit, miss, merge, (double)dict.memory_usage() / n);
+}
+
+int main(int argc, char** argv) {
+    int n = argc > 1 ? stoi(argv[1]) : 100000;
+
+    vector<PyObject> int_keys, int_misses, str_keys, str_misses;
+    for (int i=0; i < n; i++) {
+        int k = (int)((unsigned)i * 2654435761u >> 1);
+        int_keys.push_back(PyObject(2 * k, "int"));
+        int_misses.push_back(PyObject(2 * k + 1, "int"));
+        str_keys.push_back(PyObject("key" + to_string(k), "str"));
+        str_misses.push_back(PyObject("miss" + to_string(k), "str"));
+    }
+
+    cout << "n = " << n << ", sizeof(PyObject) = " << sizeof(PyObject) << endl;
+    cout << left << setw(22) << "" << right << setw(12) << "insert ns" << setw(12) << "hit ns"
+         << setw(12) << "miss ns" << setw(12) << "union ns" << setw(14) << "bytes/entry" << endl;
+    bench_pyset("PySet int keys", int_keys, int_misses);
+    bench_pydict("PyDict int keys", int_keys, int_misses);
+    bench_pyset("PySet str keys", str_keys, str_misses);
+    bench_pydict("PyDict str keys", str_keys, str_misses);
+    return 0;
+}
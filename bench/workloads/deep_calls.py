@@ -0,0 +1,30 @@
+# call overhead: a chain of small functions and deep recursion
+def f1(x):
+    return x + 1
+
+def f2(x):
+    return f1(x) + 1
+
+def f3(x):
+    return f2(x) + 1
+
+def f4(x):
+    return f3(x) + 1
+
+def f5(x):
+    return f4(x) + 1
+
+def depth(n):
+    if n == 0:
+        return 0
+    return 1 + depth(n - 1)
+
+total = 0
+for i in range(2000):
+    total += f5(i)
+print(total)
+
+total = 0
+for i in range(20):
+    total += depth(500)
+print(total)
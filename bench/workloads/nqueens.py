@@ -0,0 +1,20 @@
+# backtracking with recursion and lists of flags
+def place(row, n, cols, diag1, diag2):
+    if row == n:
+        return 1
+    count = 0
+    for col in range(n):
+        if not cols[col] and not diag1[row + col] and not diag2[row - col + n - 1]:
+            cols[col] = True
+            diag1[row + col] = True
+            diag2[row - col + n - 1] = True
+            count += place(row + 1, n, cols, diag1, diag2)
+            cols[col] = False
+            diag1[row + col] = False
+            diag2[row - col + n - 1] = False
+    return count
+
+def queens(n):
+    return place(0, n, [False] * n, [False] * (2 * n - 1), [False] * (2 * n - 1))
+
+print(queens(7))
@@ -0,0 +1,40 @@
+# float division and nested loops over lists, after the pyperformance
+# spectral_norm
+def eval_a(i, j):
+    return 1.0 / ((i + j) * (i + j + 1) // 2 + i + 1)
+
+def mul_av(v, n):
+    out = [0.0] * n
+    for i in range(n):
+        total = 0.0
+        for j in range(n):
+            total += eval_a(i, j) * v[j]
+        out[i] = total
+    return out
+
+def mul_atv(v, n):
+    out = [0.0] * n
+    for i in range(n):
+        total = 0.0
+        for j in range(n):
+            total += eval_a(j, i) * v[j]
+        out[i] = total
+    return out
+
+def mul_atav(v, n):
+    return mul_atv(mul_av(v, n), n)
+
+def spectral_norm(n):
+    u = [1.0] * n
+    v = u
+    for i in range(10):
+        v = mul_atav(u, n)
+        u = mul_atav(v, n)
+    vbv = 0.0
+    vv = 0.0
+    for i in range(n):
+        vbv += u[i] * v[i]
+        vv += v[i] * v[i]
+    return (vbv / vv) ** 0.5
+
+print(spectral_norm(16))
@@ -0,0 +1,16 @@
+# building strings by concatenation and str() of ints
+def build(n):
+    s = ""
+    for i in range(n):
+        s = s + str(i) + ","
+    return s
+
+def repeat(n):
+    total = 0
+    for i in range(n):
+        line = "item " + str(i) + " of " + str(n)
+        total += len(line)
+    return total
+
+print(len(build(3000)))
+print(repeat(5000))
@@ -0,0 +1,19 @@
+# dict heavy: counting words drawn from a fixed vocabulary with a
+# linear congruential generator, so every run sees the same text
+vocabulary = ["the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit", "sed", "do", "eiusmod", "tempor"]
+
+def count_words(n):
+    counts = {}
+    seed = 12345
+    size = len(vocabulary)
+    for i in range(n):
+        seed = (seed * 1103515245 + 12345) % 2147483648
+        word = vocabulary[seed % size] + str(seed % 7)
+        if word in counts:
+            counts[word] += 1
+        else:
+            counts[word] = 1
+    return counts
+
+counts = count_words(8000)
+print(len(counts), counts["the0"])
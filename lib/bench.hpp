@@ -0,0 +1,206 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+// a small microbenchmark harness in the spirit of catch.hpp: one header,
+// no dependencies
+//
+//   #define BENCH_MAIN  // in exactly one file, adds main() and the allocation hook
+//   #include "bench.hpp"
+//
+//   BENCH_CASE("operator+") {
+//       PyObject a(1, "int"), b(2, "int");
+//       bench.measure("int + int", [&] { return a + b; });
+//   }
+//
+// measure() grows a batch of calls until one batch takes --min-time
+// (default 20 ms), times --samples batches (default 5) and reports the
+// median nanoseconds per call, with the allocations and bytes per call
+// counted by replacing the global operator new. Arguments that are not
+// options pick the cases whose names contain them
+//   ./x-bench [--min-time=MS] [--samples=N] [filter ...]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <type_traits>
+#include <new>
+#include <cstdlib>
+
+namespace bench {
+
+struct Counters {
+    size_t allocations = 0;
+    size_t bytes = 0;
+};
+
+// counted by the operator new below, zero without BENCH_MAIN
+inline Counters& counters() {
+    static Counters c;
+    return c;
+}
+
+// makes the compiler keep a result it would otherwise throw away
+template <typename T>
+inline void keep(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+    std::string name;
+    double ns;
+    double allocations;
+    double bytes;
+    size_t batch;
+};
+
+class Bench {
+private:
+    double min_time;  // seconds per batch
+    int samples;
+    std::vector<Result> results;
+    // rows go to the buffer cout had at the start, so a case can point
+    // cout somewhere else to silence what it measures
+    std::ostream& out;
+
+    typedef std::chrono::steady_clock Clock;
+
+    template <typename F>
+    double run_batch(F& op, size_t batch) {
+        Clock::time_point start = Clock::now();
+        for (size_t i=0; i < batch; i++) {
+            if constexpr (std::is_void_v<decltype(op())>) {
+                op();
+            } else {
+                keep(op());
+            }
+        }
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+public:
+    Bench(double min_time, int samples, std::ostream& out)
+        : min_time(min_time), samples(samples), out(out) {}
+
+    template <typename F>
+    void measure(const std::string& name, F op) {
+        size_t batch = 1;
+        double t = run_batch(op, batch);
+        while (t < this->min_time && batch < ((size_t)1 << 32)) {
+            // aim a little past the target, at most 10x per step
+            double scale = t <= 0 ? 10 : std::min(10.0, std::max(2.0, 1.2 * this->min_time / t));
+            batch = (size_t)(batch * scale);
+            t = run_batch(op, batch);
+        }
+        std::vector<double> ns;
+        size_t allocations = 0;
+        size_t bytes = 0;
+        for (int s=0; s < this->samples; s++) {
+            Counters before = counters();
+            ns.push_back(run_batch(op, batch) * 1e9 / batch);
+            allocations += counters().allocations - before.allocations;
+            bytes += counters().bytes - before.bytes;
+        }
+        std::sort(ns.begin(), ns.end());
+        double calls = (double)batch * this->samples;
+        Result result{name, ns.at(ns.size() / 2), allocations / calls, bytes / calls, batch};
+        this->results.push_back(result);
+        this->out << "  " << std::left << std::setw(34) << name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(12) << result.ns
+                  << std::setprecision(2) << std::setw(12) << result.allocations
+                  << std::setprecision(1) << std::setw(12) << result.bytes << std::endl;
+    }
+
+    const std::vector<Result>& get_results() const {
+        return this->results;
+    }
+};
+
+struct Case {
+    std::string name;
+    void (*fn)(Bench&);
+};
+
+inline std::vector<Case>& registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+struct Registrar {
+    Registrar(const std::string& name, void (*fn)(Bench&)) {
+        registry().push_back(Case{name, fn});
+    }
+};
+
+inline int run(int argc, char** argv) {
+    double min_time = 0.02;
+    int samples = 5;
+    std::vector<std::string> filters;
+    for (int i=1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+        if (arg.find("--min-time=") == 0) min_time = std::stod(value) / 1000;
+        else if (arg.find("--samples=") == 0) samples = std::max(1, std::stoi(value));
+        else filters.push_back(arg);
+    }
+    std::ostream out(std::cout.rdbuf());
+    Bench bench(min_time, samples, out);
+    out << "  " << std::left << std::setw(34) << "operation" << std::right
+        << std::setw(12) << "ns/op" << std::setw(12) << "allocs/op"
+        << std::setw(12) << "bytes/op" << std::endl;
+    for (const Case& c : registry()) {
+        bool selected = filters.size() == 0;
+        for (const std::string& f : filters) {
+            if (c.name.find(f) != std::string::npos) selected = true;
+        }
+        if (!selected) continue;
+        out << c.name << std::endl;
+        c.fn(bench);
+    }
+    return 0;
+}
+
+}  // namespace bench
+
+#define BENCH_CONCAT2(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT2(a, b)
+#define BENCH_CASE(name) \
+    static void BENCH_CONCAT(bench_case_, __LINE__)(bench::Bench& bench); \
+    static bench::Registrar BENCH_CONCAT(bench_registrar_, __LINE__)(name, BENCH_CONCAT(bench_case_, __LINE__)); \
+    static void BENCH_CONCAT(bench_case_, __LINE__)(bench::Bench& bench)
+
+#ifdef BENCH_MAIN
+// every allocation in the program goes through here, the nothrow and
+// array forms forward to these by default
+void* operator new(std::size_t size) {
+    bench::counters().allocations++;
+    bench::counters().bytes += size;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    return bench::run(argc, argv);
+}
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "instrument.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    // no cycle counter, nanoseconds are the next best unit
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+CounterScope::CounterScope(Counter* counter) {
+    Instrumentation* instrumentation = Instrumentation::get_instance();
+    this->counter = counter;
+    this->parent = instrumentation->current;
+    this->child_cycles = 0;
+    counter->calls++;
+    counter->active++;
+    instrumentation->current = this;
+    this->start = read_cycles();
+}
+
+// runs on the way out of an exception too, the scopes stay balanced
+CounterScope::~CounterScope() {
+    uint64_t elapsed = read_cycles() - this->start;
+    this->counter->self += elapsed - this->child_cycles;
+    if (--this->counter->active == 0) {
+        this->counter->total += elapsed;
+    }
+    if (this->parent != nullptr) {
+        this->parent->child_cycles += elapsed;
+    }
+    Instrumentation::get_instance()->current = this->parent;
+}
+
+Instrumentation* Instrumentation::instrumentation = nullptr;
+
+Instrumentation::Instrumentation() {
+    this->current = nullptr;
+}
+
+Instrumentation* Instrumentation::get_instance() {
+    if (instrumentation == nullptr) {
+        instrumentation = new Instrumentation();
+    }
+    return instrumentation;
+}
+
+Counter* Instrumentation::counter(const std::string& name) {
+    Counter& counter = this->counters[name];
+    counter.name = name;
+    return &counter;
+}
+
+static std::vector<const Counter*> by_self(const std::unordered_map<std::string, Counter>& counters) {
+    std::vector<const Counter*> sorted;
+    for (auto& it : counters) {
+        if (it.second.calls > 0) sorted.push_back(&it.second);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Counter* a, const Counter* b) {
+        return a->self != b->self ? a->self > b->self : a->name < b->name;
+    });
+    return sorted;
+}
+
+void Instrumentation::write_table(std::ostream& os) {
+    std::vector<const Counter*> sorted = by_self(this->counters);
+    uint64_t all = 0;
+    for (const Counter* counter : sorted) all += counter->self;
+
+    os << "instrumented counters, self excludes cycles in other counted scopes" << std::endl
+       << std::setw(12) << "calls" << std::setw(16) << "total cycles"
+       << std::setw(16) << "self cycles" << std::setw(8) << "self %"
+       << std::setw(12) << "self/call" << "  name" << std::endl;
+    for (const Counter* counter : sorted) {
+        os << std::setw(12) << counter->calls
+           << std::setw(16) << counter->total
+           << std::setw(16) << counter->self
+           << std::setw(7) << std::fixed << std::setprecision(1)
+           << (all == 0 ? 0.0 : 100.0 * counter->self / all) << "%"
+           << std::setw(12) << counter->self / counter->calls
+           << "  " << counter->name << std::endl;
+    }
+}
+
+static std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+void Instrumentation::write_json(std::ostream& os) {
+    std::vector<const Counter*> sorted = by_self(this->counters);
+    os << "[" << std::endl;
+    for (size_t i=0; i < sorted.size(); i++) {
+        const Counter* counter = sorted.at(i);
+        os << "  {\"name\": " << json_string(counter->name)
+           << ", \"calls\": " << counter->calls
+           << ", \"total_cycles\": " << counter->total
+           << ", \"self_cycles\": " << counter->self << "}"
+           << (i + 1 < sorted.size() ? "," : "") << std::endl;
+    }
+    os << "]" << std::endl;
+}
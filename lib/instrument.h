@@ -0,0 +1,77 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+// counters for an instrumentation build of the evaluator
+//   make clean; make mypy INSTRUMENT=1
+// every AST node's evaluate, every PyObject operator on a pair of types
+// and every builtin counts its executions and the cycles (rdtsc) spent
+// inside. The table is written to stderr at exit, or JSON with
+// --counters-json=FILE. A normal build compiles the macros away
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+struct Counter {
+    std::string name;
+    uint64_t calls = 0;
+    // cycles between entering and leaving, only the outermost of
+    // recursive activations is added so it never exceeds the run
+    uint64_t total = 0;
+    // cycles not spent in another counted scope started inside this one
+    uint64_t self = 0;
+    int active = 0;
+};
+
+// times one activation of a counter, the scopes nest like the calls
+class CounterScope {
+private:
+    Counter* counter;
+    CounterScope* parent;
+    uint64_t start;
+    uint64_t child_cycles;
+public:
+    CounterScope(Counter* counter);
+    ~CounterScope();
+};
+
+class Instrumentation {
+private:
+    std::unordered_map<std::string, Counter> counters;
+protected:
+    Instrumentation();
+
+    static Instrumentation* instrumentation;
+public:
+    // the innermost open scope
+    CounterScope* current;
+
+    // not cloneable
+    Instrumentation(Instrumentation &other) = delete;
+    // not assignable
+    void operator=(const Instrumentation&) = delete;
+
+    static Instrumentation* get_instance();
+
+    // map nodes dont move, call sites keep the pointer
+    Counter* counter(const std::string& name);
+    // most self cycles first
+    void write_table(std::ostream& os);
+    void write_json(std::ostream& os);
+};
+
+#ifdef INSTRUMENT
+// a fixed name, looked up once per call site
+#define INSTRUMENT_SCOPE(name) \
+    static Counter* instrument_counter = Instrumentation::get_instance()->counter(name); \
+    CounterScope instrument_scope(instrument_counter)
+// a name built per call, like an operator and its operand types
+#define INSTRUMENT_DYNAMIC(name) \
+    CounterScope instrument_scope(Instrumentation::get_instance()->counter(name))
+#else
+#define INSTRUMENT_SCOPE(name)
+#define INSTRUMENT_DYNAMIC(name)
+#endif
+
+#endif
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include "logging.h"
+#include "memstats.h"
 
 // #define DEBUG   3
 // #define INFO    2
@@ -14,17 +15,18 @@ using std::endl;
 Logger* Logger::logger = nullptr;
 
 Logger::Logger() {
-    cout << "Logger set to '" << "output_log" << "'" << endl;
     this->f.open("output_log", std::fstream::out | std::fstream::trunc); 
     this->mode = WARNING;
     this->indent = "";
+    // stdout is the program's, only -v shows where the log goes
+    this->log("Logger set to 'output_log'", INFO);
 }
 
 Logger::Logger(std::string fname) {
-    cout << "Logger set to '" << fname << "'" << endl;
     this->f.open(fname, std::fstream::out | std::fstream::trunc);
     this->mode = WARNING;
     this->indent = "";
+    this->log("Logger set to '" + fname + "'", INFO);
 }
 
 Logger* Logger::get_instance() {
@@ -53,20 +55,24 @@ std::string Logger::get_mode_string() {
 }
 
 void Logger::log(std::string msg, int mode) {
+    MemScope mem_scope(MEM_LOGGER);
     if (mode <= this-> mode) {
         cout << this->indent << msg << endl;
         if (this->f.is_open()) this->f << this->indent << msg << '\n';
     }
 }
     
+bool Logger::enabled(int mode) {
+    return mode <= this->mode;
+}
+
 void Logger::set_mode(int mode) {
     if (mode == 1 || mode == 2 || mode == 3) this->mode = mode;
 }
 
 void Logger::add_indent(int amt) {
-    for (int i=0; i < amt; i++) {
-        this->indent += " ";
-    }
+    MemScope mem_scope(MEM_LOGGER);
+    this->indent.append(amt, ' ');
 }
 
 void Logger::sub_indent(int amt) {
@@ -74,7 +80,18 @@ void Logger::sub_indent(int amt) {
         throw std::runtime_error("Attempted to subtract '" + std::to_string(amt) 
                 + "' from indent of size '" + std::to_string(this->indent.size()) + "'");
     }
-    this->indent = this->indent.substr(0, this->indent.size()-amt);
+    // in place, deep recursion makes the indent long
+    this->indent.resize(this->indent.size()-amt);
+}
+
+int Logger::get_indent() {
+    return this->indent.size();
+}
+
+void Logger::set_indent(int amt) {
+    MemScope mem_scope(MEM_LOGGER);
+    // an exception skips the sub_indent() calls on its way to a handler
+    this->indent.resize(amt, ' ');
 }
 
 void Logger::close() {
@@ -39,9 +39,12 @@ public:
 
 
     void log(std::string msg, int mode);
+    bool enabled(int mode);
     void set_mode(int mode);
     void add_indent(int amt);
     void sub_indent(int amt);
+    int get_indent();
+    void set_indent(int amt);
     void close();
 };
 
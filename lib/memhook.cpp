@@ -0,0 +1,36 @@
+// the global operator new/delete of the interpreter, reporting to
+// MemStats while it traces. Only linked into mypy and the tests, the
+// benches count allocations their own way (bench.hpp). The nothrow and
+// array forms forward to these by default
+#include <new>
+#include <cstdlib>
+#include "memstats.h"
+
+void* operator new(std::size_t size) {
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    if (MemStats::tracing) {
+        MemStats::record_alloc(p, size);
+    }
+    return p;
+}
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+void operator delete(void* p) noexcept {
+    if (MemStats::tracing && p != nullptr) {
+        MemStats::record_free(p);
+    }
+    std::free(p);
+}
+void operator delete[](void* p) noexcept {
+    ::operator delete(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    ::operator delete(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+    ::operator delete(p);
+}
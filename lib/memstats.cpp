@@ -0,0 +1,166 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "memstats.h"
+
+MemStats::RawMap<void*, MemStats::Block>* MemStats::blocks = nullptr;
+MemStats::RawMap<int, MemStats::LineCounts>* MemStats::lines = nullptr;
+MemCounts MemStats::categories[MEM_CATEGORIES];
+MemCounts MemStats::total;
+bool MemStats::recording = false;
+bool MemStats::tracing = false;
+MemCategory MemStats::category = MEM_OTHER;
+int (*MemStats::line_source)() = nullptr;
+
+// the tables are made with malloc too, so they never show up in them
+template <typename T>
+static T* make_raw() {
+    return new (RawAllocator<T>().allocate(1)) T();
+}
+
+template <typename T>
+static void free_raw(T* p) {
+    if (p != nullptr) {
+        p->~T();
+        RawAllocator<T>().deallocate(p, 1);
+    }
+}
+
+void MemStats::start() {
+    if (tracing) {
+        return;
+    }
+    blocks = make_raw<RawMap<void*, Block>>();
+    lines = make_raw<RawMap<int, LineCounts>>();
+    tracing = true;
+}
+
+void MemStats::stop() {
+    tracing = false;
+    free_raw(blocks);
+    free_raw(lines);
+    blocks = nullptr;
+    lines = nullptr;
+    for (MemCounts& counts : categories) counts = MemCounts();
+    total = MemCounts();
+}
+
+bool MemStats::is_tracing() {
+    return tracing;
+}
+
+void MemStats::reset_peak() {
+    for (MemCounts& counts : categories) counts.peak = counts.live;
+    total.peak = total.live;
+}
+
+size_t MemStats::traced_current() {
+    return total.live;
+}
+
+size_t MemStats::traced_peak() {
+    return total.peak;
+}
+
+static void add(MemCounts& counts, size_t size) {
+    counts.live += size;
+    counts.allocations++;
+    counts.peak = std::max(counts.peak, counts.live);
+}
+
+static void remove(MemCounts& counts, size_t size) {
+    counts.live -= size;
+    counts.frees++;
+}
+
+void MemStats::record_alloc(void* p, size_t size) {
+    if (recording || blocks == nullptr) {
+        return;
+    }
+    recording = true;
+    int line = line_source != nullptr ? line_source() : 0;
+    (*blocks)[p] = Block{size, category, line};
+    add(categories[category], size);
+    add(total, size);
+    LineCounts& counts = (*lines)[line];
+    counts.bytes += size;
+    counts.allocations++;
+    counts.live += size;
+    recording = false;
+}
+
+void MemStats::record_free(void* p) {
+    if (recording || blocks == nullptr) {
+        return;
+    }
+    recording = true;
+    auto it = blocks->find(p);
+    if (it != blocks->end()) {
+        Block block = it->second;
+        blocks->erase(it);
+        remove(categories[block.category], block.size);
+        remove(total, block.size);
+        (*lines)[block.line].live -= block.size;
+    }
+    recording = false;
+}
+
+const char* MemStats::category_name(MemCategory category) {
+    switch (category) {
+        case MEM_TOKENS: return "tokens";
+        case MEM_AST: return "AST nodes";
+        case MEM_FRAMES: return "frames";
+        case MEM_STR: return "str";
+        case MEM_LIST: return "list/tuple";
+        case MEM_DICT: return "dict";
+        case MEM_SET: return "set";
+        case MEM_INT: return "big int";
+        case MEM_LOGGER: return "logger";
+        default: return "other";
+    }
+}
+
+static void write_row(std::ostream& os, const std::string& name, const MemCounts& counts) {
+    os << std::left << std::setw(14) << name << std::right
+       << std::setw(14) << counts.live << std::setw(14) << counts.peak
+       << std::setw(14) << counts.allocations << std::setw(14) << counts.frees << std::endl;
+}
+
+void MemStats::write_report(std::ostream& os, size_t top_lines) {
+    // the report allocates, keep it out of the numbers it prints
+    bool was_recording = recording;
+    recording = true;
+
+    os << "memory traced since start, in bytes" << std::endl
+       << std::left << std::setw(14) << "category" << std::right
+       << std::setw(14) << "live" << std::setw(14) << "peak"
+       << std::setw(14) << "allocations" << std::setw(14) << "frees" << std::endl;
+    for (int c=0; c < MEM_CATEGORIES; c++) {
+        if (categories[c].allocations > 0) {
+            write_row(os, category_name((MemCategory)c), categories[c]);
+        }
+    }
+    write_row(os, "total", total);
+
+    if (lines != nullptr && lines->size() > 0) {
+        std::vector<std::pair<int, LineCounts>> sorted(lines->begin(), lines->end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+            return a.second.bytes != b.second.bytes ? a.second.bytes > b.second.bytes : a.first < b.first;
+        });
+        os << std::endl << "top allocation sites" << std::endl
+           << std::left << std::setw(14) << "line" << std::right
+           << std::setw(14) << "allocated" << std::setw(14) << "allocations"
+           << std::setw(14) << "live" << std::endl;
+        for (size_t i=0; i < sorted.size() && i < top_lines; i++) {
+            const auto& it = sorted.at(i);
+            // line 0 is the interpreter itself: reading, tokenizing, parsing
+            std::string line = it.first == 0 ? "(no line)" : "line " + std::to_string(it.first);
+            os << std::left << std::setw(14) << line << std::right
+               << std::setw(14) << it.second.bytes << std::setw(14) << it.second.allocations
+               << std::setw(14) << it.second.live << std::endl;
+        }
+    }
+    recording = was_recording;
+}
@@ -0,0 +1,120 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+// allocation tracking for --mem-stats and the tracemalloc_* builtins.
+// memhook.o replaces the global operator new/delete and reports every
+// block here while tracing is on, nothing is kept while it is off. A
+// block is charged to the innermost open MemScope (tokens, AST nodes,
+// frames, str/list/dict/set/int payloads, logger) and to the Python
+// line running when it was made. Blocks made before start() are not
+// traced, like tracemalloc, and neither is memory from malloc directly
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+enum MemCategory {
+    MEM_OTHER,
+    MEM_TOKENS,
+    MEM_AST,
+    MEM_FRAMES,
+    MEM_STR,
+    MEM_LIST,
+    MEM_DICT,
+    MEM_SET,
+    MEM_INT,
+    MEM_LOGGER,
+    MEM_CATEGORIES
+};
+
+struct MemCounts {
+    size_t live = 0;
+    size_t peak = 0;
+    size_t allocations = 0;
+    size_t frees = 0;
+};
+
+// the side tables allocate with malloc so recording a block does not
+// make another one
+template <typename T>
+struct RawAllocator {
+    typedef T value_type;
+    RawAllocator() = default;
+    template <typename U>
+    RawAllocator(const RawAllocator<U>&) {}
+    T* allocate(size_t n) {
+        if (T* p = static_cast<T*>(std::malloc(n * sizeof(T)))) return p;
+        throw std::bad_alloc();
+    }
+    void deallocate(T* p, size_t) { std::free(p); }
+    template <typename U>
+    bool operator==(const RawAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const RawAllocator<U>&) const { return false; }
+};
+
+class MemStats {
+private:
+    struct Block {
+        size_t size;
+        MemCategory category;
+        int line;
+    };
+    struct LineCounts {
+        size_t bytes = 0;
+        size_t allocations = 0;
+        size_t live = 0;
+    };
+    template <typename K, typename V>
+    using RawMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>,
+                                      RawAllocator<std::pair<const K, V>>>;
+
+    static RawMap<void*, Block>* blocks;
+    static RawMap<int, LineCounts>* lines;
+    static MemCounts categories[MEM_CATEGORIES];
+    static MemCounts total;
+    // set while a block is being recorded, the hook skips its own work
+    static bool recording;
+
+public:
+    // checked by the hook on every allocation
+    static bool tracing;
+    static MemCategory category;
+    // the Python line for a new block, 0 outside the program
+    static int (*line_source)();
+
+    static void start();
+    // drops the traces, like tracemalloc.stop()
+    static void stop();
+    static bool is_tracing();
+    static void reset_peak();
+    static size_t traced_current();
+    static size_t traced_peak();
+
+    static void record_alloc(void* p, size_t size);
+    static void record_free(void* p);
+
+    static const char* category_name(MemCategory category);
+    // live and peak bytes per category, then the lines that allocated
+    // the most bytes
+    static void write_report(std::ostream& os, size_t top_lines = 10);
+};
+
+// charges the blocks made while it is open to a category
+class MemScope {
+private:
+    MemCategory previous;
+public:
+    MemScope(MemCategory category) {
+        this->previous = MemStats::category;
+        MemStats::category = category;
+    }
+    ~MemScope() {
+        MemStats::category = this->previous;
+    }
+};
+
+#endif
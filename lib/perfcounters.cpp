@@ -0,0 +1,182 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "perfcounters.h"
+
+// value, time enabled and time running, see PERF_FORMAT_TOTAL_TIME_*
+struct PerfRead {
+    uint64_t value;
+    uint64_t enabled;
+    uint64_t running;
+};
+
+static int open_event(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // this thread only, on any cpu. glibc has no wrapper
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+PerfCounters* PerfCounters::perf_counters = nullptr;
+
+PerfCounters::PerfCounters() {
+    for (int& fd : this->fds) fd = -1;
+}
+
+PerfCounters* PerfCounters::get_instance() {
+    if (perf_counters == nullptr) {
+        perf_counters = new PerfCounters();
+    }
+    return perf_counters;
+}
+
+const char* PerfCounters::event_name(PerfEvent event) {
+    switch (event) {
+        case PERF_INSTRUCTIONS: return "instructions";
+        case PERF_CYCLES: return "cycles";
+        case PERF_BRANCH_MISSES: return "branch-misses";
+        case PERF_CACHE_MISSES: return "cache-misses";
+        case PERF_TASK_CLOCK: return "task-clock-ns";
+        default: return "?";
+    }
+}
+
+bool PerfCounters::open() {
+    this->close();
+    this->fds[PERF_INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    this->fds[PERF_CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    this->fds[PERF_BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    this->fds[PERF_CACHE_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    this->fds[PERF_TASK_CLOCK] = open_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
+    return this->is_open();
+}
+
+void PerfCounters::close() {
+    for (int& fd : this->fds) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+}
+
+bool PerfCounters::is_open() {
+    for (int fd : this->fds) {
+        if (fd >= 0) return true;
+    }
+    return false;
+}
+
+bool PerfCounters::is_supported(PerfEvent event) {
+    return this->fds[event] >= 0;
+}
+
+PerfReading PerfCounters::read() {
+    PerfReading reading;
+    for (int e=0; e < PERF_EVENTS; e++) {
+        PerfRead r;
+        if (this->fds[e] < 0 || ::read(this->fds[e], &r, sizeof(r)) != sizeof(r)) {
+            continue;
+        }
+        reading.values[e] = r.running == 0 || r.running == r.enabled
+            ? r.value : (uint64_t)((double)r.value * r.enabled / r.running);
+    }
+    return reading;
+}
+
+void PerfCounters::add(const std::string& region, const PerfReading& start, const PerfReading& end) {
+    if (this->regions.count(region) == 0) {
+        this->names.push_back(region);
+    }
+    PerfTotals& totals = this->regions[region];
+    for (int e=0; e < PERF_EVENTS; e++) {
+        totals.values[e] += end.values[e] - start.values[e];
+    }
+    totals.calls++;
+}
+
+const PerfTotals* PerfCounters::region(const std::string& name) {
+    auto it = this->regions.find(name);
+    return it == this->regions.end() ? nullptr : &it->second;
+}
+
+// per thousand instructions, the usual unit for misses
+static double per_kilo(uint64_t n, uint64_t instructions) {
+    return instructions == 0 ? 0 : 1000.0 * n / instructions;
+}
+
+void PerfCounters::write_report(std::ostream& os, const std::string& total_region) {
+    os << "hardware counters, user space only, misses per 1000 instructions" << std::endl
+       << std::left << std::setw(12) << "region" << std::right;
+    for (int e=0; e < PERF_EVENTS; e++) {
+        os << std::setw(16) << event_name((PerfEvent)e);
+    }
+    os << std::setw(8) << "IPC" << std::setw(12) << "br-miss/k" << std::setw(12) << "$-miss/k" << std::endl;
+    for (const std::string& name : this->names) {
+        const PerfTotals& totals = this->regions.at(name);
+        os << std::left << std::setw(12) << name << std::right;
+        for (int e=0; e < PERF_EVENTS; e++) {
+            if (this->is_supported((PerfEvent)e)) os << std::setw(16) << totals.values[e];
+            else os << std::setw(16) << "n/a";
+        }
+        const uint64_t* v = totals.values;
+        os << std::fixed << std::setprecision(2);
+        if (this->is_supported(PERF_INSTRUCTIONS) && this->is_supported(PERF_CYCLES) && v[PERF_CYCLES] > 0) {
+            os << std::setw(8) << (double)v[PERF_INSTRUCTIONS] / v[PERF_CYCLES];
+        } else {
+            os << std::setw(8) << "n/a";
+        }
+        for (PerfEvent e : {PERF_BRANCH_MISSES, PERF_CACHE_MISSES}) {
+            if (this->is_supported(PERF_INSTRUCTIONS) && this->is_supported(e)) {
+                os << std::setw(12) << per_kilo(v[e], v[PERF_INSTRUCTIONS]);
+            } else {
+                os << std::setw(12) << "n/a";
+            }
+        }
+        os << std::endl;
+    }
+    for (int e=0; e < PERF_EVENTS; e++) {
+        if (!this->is_supported((PerfEvent)e)) {
+            os << event_name((PerfEvent)e) << " not supported here" << std::endl;
+        }
+    }
+
+    const PerfTotals* total = this->region(total_region);
+    if (total != nullptr) {
+        os << "perf-counters:";
+        for (int e=0; e < PERF_EVENTS; e++) {
+            if (this->is_supported((PerfEvent)e)) {
+                os << " " << event_name((PerfEvent)e) << "=" << total->values[e];
+            }
+        }
+        os << std::endl;
+    }
+}
+
+PerfRegion::PerfRegion(const std::string& name) {
+    this->name = name;
+    this->running = PerfCounters::get_instance()->is_open();
+    if (this->running) {
+        this->start = PerfCounters::get_instance()->read();
+    }
+}
+
+PerfRegion::~PerfRegion() {
+    this->stop();
+}
+
+void PerfRegion::stop() {
+    if (this->running) {
+        PerfCounters* counters = PerfCounters::get_instance();
+        counters->add(this->name, this->start, counters->read());
+        this->running = false;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+// hardware counters through Linux perf_event_open for --perf-counters:
+// instructions, cycles, branch misses and cache misses (last level
+// references that missed), plus task-clock so there is a time to put
+// them against. Each counter is opened on its own and only counts this
+// thread in user space, one the kernel or a VM does not offer is left
+// out instead of failing the rest. A PerfRegion adds what the counters
+// moved while it was open to a named total, the interpreter keeps
+// tokenize, parse, evaluate and the whole run
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+enum PerfEvent {
+    PERF_INSTRUCTIONS,
+    PERF_CYCLES,
+    PERF_BRANCH_MISSES,
+    PERF_CACHE_MISSES,
+    PERF_TASK_CLOCK,
+    PERF_EVENTS
+};
+
+struct PerfReading {
+    uint64_t values[PERF_EVENTS] = {};
+};
+
+struct PerfTotals {
+    uint64_t values[PERF_EVENTS] = {};
+    uint64_t calls = 0;
+};
+
+class PerfCounters {
+private:
+    int fds[PERF_EVENTS];
+    std::unordered_map<std::string, PerfTotals> regions;
+    // report order, first added first
+    std::vector<std::string> names;
+protected:
+    PerfCounters();
+
+    static PerfCounters* perf_counters;
+public:
+    // not cloneable
+    PerfCounters(PerfCounters &other) = delete;
+    // not assignable
+    void operator=(const PerfCounters&) = delete;
+
+    static PerfCounters* get_instance();
+    static const char* event_name(PerfEvent event);
+
+    // counts the calling thread from here on, false if no counter could
+    // be opened (perf_event_paranoid, seccomp, no PMU in a VM)
+    bool open();
+    void close();
+    bool is_open();
+    bool is_supported(PerfEvent event);
+
+    // scaled up if the kernel had to multiplex the counters
+    PerfReading read();
+    void add(const std::string& region, const PerfReading& start, const PerfReading& end);
+    const PerfTotals* region(const std::string& name);
+
+    // a row per region with IPC and misses per thousand instructions,
+    // then one 'perf-counters: name=value ...' line for the whole run
+    // that run-bench picks out of the output
+    void write_report(std::ostream& os, const std::string& total_region);
+};
+
+// counts one stretch of the program towards a region, stop() ends it
+// early and the destructor ends it on the way out of an exception
+class PerfRegion {
+private:
+    std::string name;
+    PerfReading start;
+    bool running;
+public:
+    PerfRegion(const std::string& name);
+    ~PerfRegion();
+    void stop();
+};
+
+#endif
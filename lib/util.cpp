@@ -11,6 +11,9 @@ bool is_number(const string& s) {
         stod(s);
         return true;
     }
+    catch(const out_of_range&) {
+        return true;  // 1e999 and 5e-324 are still numbers
+    }
     catch(...) {
         return false;
     }
@@ -52,6 +55,11 @@ vector<string> read_lines(string fname) {
     if (file.is_open()) {
         string tp;
         while(getline(file, tp)) {
+            // the tokenizer expects '\r\n' line endings, files saved with
+            // plain '\n' need the '\r' put back
+            if (tp.size() == 0 || tp.back() != '\r') {
+                tp += '\r';
+            }
             results.push_back(tp);
         }
     }
@@ -7,6 +7,7 @@
 #include <cstdlib>
 #include <numeric>
 #include <typeinfo>
+#include <new>
 #include "logging.h"
 #include "tokenizer.h"
 #include "token.h"
@@ -14,6 +15,18 @@
 #include "ast.h"
 #include "ast_helpers.h"
 #include "pyobject.h"
+#include "pyexception.h"
+#include "pydict.h"
+#include "pyset.h"
+#include "pylist.h"
+#include "bigint.h"
+#include "output.h"
+#include "builtins.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "coverage.h"
+#include "instrument.h"
+#include "memstats.h"
 #include "stack.h"
 using namespace std;
 
@@ -27,11 +40,42 @@ void sub_indent(int amt) {
     Logger::get_instance()->sub_indent(amt);
 }
 
+// how many loops the parser is inside of, 'break' and 'continue' are
+// only valid when this is above 0
+static int loop_depth = 0;
+// how many try statements the parser is inside of, a tail call would
+// leave the try before the call runs so they are turned off in there
+static int try_depth = 0;
+
+// tokens that can follow a trailing ',' in an expression list
+bool ends_expressions(Token t) {
+    return t.type == "NEWLINE" || t.value == "=" || t.value == ")" || t.value == "]" 
+        || t.value == "}" || t.value == ":" || t.value == ";" || is_augassign_op(t.value);
+}
+
+// walks down a chain of single child nodes, returns the Primary
+// if the whole expression is nothing but a call
+Primary* find_call(AST* node) {
+    while (node->children.size() == 1) {
+        node = node->children.at(0);
+    }
+    Primary* primary = dynamic_cast<Primary*>(node);
+    if (primary != nullptr && primary->is_call()) {
+        return primary;
+    }
+    return nullptr;
+}
+
 //===============================================================
 // AST: parent class of all nodes
 
-AST::AST() { }
+size_t AST::created = 0;
+
+AST::AST() {
+    created++;
+}
 AST::AST(Tokenizer *tokenizer, string indent) {
+    created++;
     this->tokenizer = tokenizer;
     this->indent = indent;
 }
@@ -71,7 +115,8 @@ void AST::eat_type(string exp_type, string func_name) {
     }
     rewind_amt++;
 }
-PyObject AST::evaluate(Stack stack) {
+PyObject AST::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("AST::evaluate");
     throw runtime_error("Attempted to evaluate an AST - start evaluation at a subclass");
 }
 ostream& operator<<(ostream& os, const AST& ast) {
@@ -87,6 +132,9 @@ ostream& AST::print(ostream& os) const {
     }
     return os;
 }
+vector<AST*> AST::all_children() const {
+    return this->children;
+}
 
 //===============================================================
 // File: starting non-terminal for file mode
@@ -110,9 +158,18 @@ void File::parse() {
     children.push_back(new Statements(tokenizer, indent));
     eat_type("ENDMARKER", "File");
 }
-PyObject File::evaluate(Stack stack) {
+// buffered output goes out when the program ends, and before an uncaught
+// error is reported so it shows up after what was printed
+PyObject File::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("File::evaluate");
     log("File::evaluate()", DEBUG); add_indent(2);
-    children.at(0)->evaluate(stack);
+    try {
+        children.at(0)->evaluate(stack);
+    } catch (exception& e) {
+        Output::get_instance()->flush();
+        throw;
+    }
+    Output::get_instance()->flush();
     sub_indent(2);
     return PyObject();
 }
@@ -144,9 +201,17 @@ Interactive::~Interactive() {
 void Interactive::parse() {
     children.push_back(new StatementNewline(tokenizer, indent));
 }
-PyObject Interactive::evaluate(Stack stack) {
+PyObject Interactive::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Interactive::evaluate");
     log("Interactive::evaluate()", DEBUG); add_indent(2);
-    PyObject ret = children.at(0)->evaluate(stack);
+    PyObject ret;
+    try {
+        ret = children.at(0)->evaluate(stack);
+    } catch (exception& e) {
+        Output::get_instance()->flush();
+        throw;
+    }
+    Output::get_instance()->flush();
     sub_indent(2);
     return ret;
 }
@@ -178,7 +243,8 @@ void Statements::parse() {
         children.push_back(new Statement(tokenizer, indent));
     }
 }
-PyObject Statements::evaluate(Stack stack) {
+PyObject Statements::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Statements::evaluate");
     log("Statements::evaluate()", DEBUG); add_indent(2);
     for (AST* child : children) {
         child->evaluate(stack);
@@ -212,6 +278,8 @@ Statement::~Statement() {
     sub_indent(2);
 }
 void Statement::parse() {
+    this->line = peek("Statement").line_start;
+    Coverage::get_instance()->add_statement(this->line);
     CompoundStmt *temp = new CompoundStmt(tokenizer, indent);
     if (temp->children.size() == 0) {
         delete temp;
@@ -220,8 +288,13 @@ void Statement::parse() {
         children.push_back(temp);
     }
 }
-PyObject Statement::evaluate(Stack stack) {
+PyObject Statement::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Statement::evaluate");
     log("Statement::evaluate()", DEBUG); add_indent(2);
+    Profiler::get_instance()->set_line(this->line);
+    if (Tracer::active) {
+        Tracer::line(stack, this->line);
+    }
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
     return ret;
@@ -275,7 +348,8 @@ void StatementNewline::parse() {
         }
     }
 }
-PyObject StatementNewline::evaluate(Stack stack) {
+PyObject StatementNewline::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("StatementNewline::evaluate");
     log("StatementNewline::evaluate()", DEBUG); add_indent(2);
     if (children.size() > 0) {
         sub_indent(2);
@@ -314,7 +388,8 @@ void SimpleStmt::parse() {
     children.push_back(new SmallStmt(tokenizer, indent));
     eat_type("NEWLINE", "SimpleStmt");
 }
-PyObject SimpleStmt::evaluate(Stack stack) {
+PyObject SimpleStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("SimpleStmt::evaluate");
     log("SimpleStmt::evaluate()", DEBUG); add_indent(2);
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -367,10 +442,11 @@ void SmallStmt::parse() {
         throw runtime_error("SmallStmt: 'import' not implemented");
     }
     else if (peek("SmallStmt").value == "raise") {
-        throw runtime_error("SmallStmt: 'raise' not implemented");
+        children.push_back(new RaiseStmt(tokenizer, indent));
     }
     else if (peek("SmallStmt").value == "pass") {
-        throw runtime_error("SmallStmt: 'pass' not implemented");
+        this->keyword = "pass";
+        children.push_back(new Op(tokenizer, indent));
     }
     else if (peek("SmallStmt").value == "del") {
         throw runtime_error("SmallStmt: 'del' not implemented");
@@ -381,11 +457,12 @@ void SmallStmt::parse() {
     else if (peek("SmallStmt").value == "assert") {
         throw runtime_error("SmallStmt: 'assert' not implemented");
     }
-    else if (peek("SmallStmt").value == "break") {
-        throw runtime_error("SmallStmt: 'break' not implemented");
-    }
-    else if (peek("SmallStmt").value == "continue") {
-        throw runtime_error("SmallStmt: 'continue' not implemented");
+    else if (peek("SmallStmt").value == "break" || peek("SmallStmt").value == "continue") {
+        this->keyword = peek("SmallStmt").value;
+        if (loop_depth == 0) {
+            throw PyException("SyntaxError", "'" + this->keyword + "' outside loop");
+        }
+        children.push_back(new Op(tokenizer, indent));
     }
     else if (peek("SmallStmt").value == "global") {
         throw runtime_error("SmallStmt: 'global' not implemented");
@@ -393,14 +470,23 @@ void SmallStmt::parse() {
     else if (peek("SmallStmt").value == "nonlocal") {
         throw runtime_error("SmallStmt: 'nonlocal' not implemented");
     }
+    else if (find_assignment_op(tokenizer) != "") {
+        children.push_back(new Assignment(tokenizer, indent));
+    }
     else {
-        // assignment
-        // star_expressions
         children.push_back(new StarExpressions(tokenizer, indent));
     }
 }
-PyObject SmallStmt::evaluate(Stack stack) {
+PyObject SmallStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("SmallStmt::evaluate");
     log("SmallStmt::evaluate()", DEBUG); add_indent(2);
+    if (this->keyword != "") {
+        // the enclosing Blocks unwind up to the loop
+        if (this->keyword == "break") stack.set_breaking();
+        else if (this->keyword == "continue") stack.set_continuing();
+        sub_indent(2);
+        return PyObject();
+    }
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
     return ret;
@@ -448,9 +534,13 @@ void CompoundStmt::parse() {
     else if (peek("CompoundStmt").value == "def") {
         children.push_back(new FunctionDef(tokenizer, indent));
     }
-    // TODO: class_def, with_stmt, try_stmt
+    else if (peek("CompoundStmt").value == "try") {
+        children.push_back(new TryStmt(tokenizer, indent));
+    }
+    // TODO: class_def, with_stmt
 }
-PyObject CompoundStmt::evaluate(Stack stack) {
+PyObject CompoundStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("CompoundStmt::evaluate");
     log("CompoundStmt::evaluate()", DEBUG); add_indent(2);
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -496,22 +586,233 @@ Assignment::~Assignment() {
     log(__FUNCTION__, DEBUG); add_indent(2);
     for (AST* child : children) delete child;
     children.clear();
+    for (StarTargets* target : targets) delete target;
+    targets.clear();
+    if (augassign != nullptr) delete augassign;
     sub_indent(2);
 }
 void Assignment::parse() {
-    // TODO:
+    // NOTE: annotated assignments are not supported
+    this->augassign = nullptr;
+    if (is_augassign_op(find_assignment_op(tokenizer))) {
+        targets.push_back(new StarTargets(tokenizer, indent));
+        if (!targets.back()->is_single()) {
+            throw PyException("SyntaxError", "illegal expression for augmented assignment");
+        }
+        this->augassign = new Op(tokenizer, indent);
+    }
+    else {
+        // a = b = value
+        while (find_assignment_op(tokenizer) == "=") {
+            targets.push_back(new StarTargets(tokenizer, indent));
+            eat_value("=", "Assignment");
+        }
+    }
+    children.push_back(new StarExpressions(tokenizer, indent));
 }
-PyObject Assignment::evaluate(Stack stack) {
-    // TODO:
-    log("Assignment::evaluate()", DEBUG); add_indent(2); sub_indent(2);
+PyObject Assignment::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Assignment::evaluate");
+    log("Assignment::evaluate()", DEBUG); add_indent(2);
+    PyObject value = children.at(0)->evaluate(stack);
+    if (this->augassign != nullptr) {
+        targets.at(0)->augassign(stack, this->augassign->token.value, value);
+    }
+    else {
+        for (StarTargets* target : targets) {
+            target->assign(stack, value);
+        }
+    }
+    sub_indent(2);
     return PyObject(); // returns None
 }
 ostream& Assignment::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
+    for (StarTargets* target : targets) {
+        os << *target << (augassign != nullptr ? " " + augassign->token.value + " " : " = ");
+    }
+    os << *children.at(0);
+    return os;
+}
+vector<AST*> Assignment::all_children() const {
+    vector<AST*> all(this->targets.begin(), this->targets.end());
+    if (this->augassign != nullptr) all.push_back(this->augassign);
+    all.insert(all.end(), this->children.begin(), this->children.end());
+    return all;
+}
+
+//===============================================================
+// StarTargets
+
+// NOTE: unpack is forced for '[' star_targets ']', [a] = [1] unpacks
+
+// star_targets:
+//     | star_target !',' 
+//     | star_target (',' star_target )* [','] 
+StarTargets::StarTargets(Tokenizer *tokenizer, string indent, bool unpack) {
+    log(__FUNCTION__, DEBUG); add_indent(2);
+    this->tokenizer = tokenizer;
+    this->indent = indent;
+    this->unpack = unpack;
+    parse();
+    sub_indent(2);
+    log(__FUNCTION__ + (string)" - children.size() == " + to_string(children.size()), DEBUG);
+}
+StarTargets::~StarTargets() {
+    log(__FUNCTION__, DEBUG); add_indent(2);
+    for (AST* child : children) delete child;
+    children.clear();
+    sub_indent(2);
+}
+void StarTargets::parse() {
+    children.push_back(new StarTarget(tokenizer, indent));
+    while (peek("StarTargets").value == ",") {
+        eat_value(",", "StarTargets");
+        this->unpack = true;
+        string next = peek("StarTargets").value;
+        if (next == "=" || next == ")" || next == "]" || next == "in") break;
+        children.push_back(new StarTarget(tokenizer, indent));
+    }
+}
+bool StarTargets::is_single() const {
+    return !unpack && dynamic_cast<StarTarget*>(children.at(0))->is_single();
+}
+void StarTargets::assign(Stack& stack, PyObject value) {
+    if (!unpack) {
+        dynamic_cast<StarTarget*>(children.at(0))->assign(stack, value);
+        return;
+    }
+    vector<PyObject> items;
+    int64_t idx = 0;
+    PyObject item;
+    while (value.iter_next(idx, item)) {
+        if (items.size() == children.size()) {
+            throw PyException("ValueError", "too many values to unpack (expected " 
+                                            + to_string(children.size()) + ")");
+        }
+        items.push_back(item);
+    }
+    if (items.size() < children.size()) {
+        throw PyException("ValueError", "not enough values to unpack (expected " 
+            + to_string(children.size()) + ", got " + to_string(items.size()) + ")");
+    }
+    for (int i=0; i < children.size(); i++) {
+        dynamic_cast<StarTarget*>(children.at(i))->assign(stack, items.at(i));
+    }
+}
+void StarTargets::augassign(Stack& stack, string op, PyObject value) {
+    dynamic_cast<StarTarget*>(children.at(0))->augassign(stack, op, value);
+}
+PyObject StarTargets::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("StarTargets::evaluate");
+    throw runtime_error("StarTargets::evaluate() targets are assigned, not evaluated");
+}
+ostream& StarTargets::print(ostream& os) const {
+    for (int i=0; i < children.size(); i++) {
+        if (i > 0) os << ", ";
+        os << *children.at(i);
+    }
+    if (unpack && children.size() == 1) os << ",";
+    return os;
+}
+
+//===============================================================
+// StarTarget
+
+// NOTE: '*' targets and attributes are not supported
+
+// star_target:
+//     | '*' (!'*' star_target) 
+//     | target_with_star_atom
+// target_with_star_atom:
+//     | t_primary '.' NAME !t_lookahead 
+//     | t_primary '[' slices ']' !t_lookahead 
+//     | star_atom
+// star_atom:
+//     | NAME 
+//     | '(' target_with_star_atom ')' 
+//     | '(' [star_targets_tuple_seq] ')' 
+//     | '[' [star_targets_list_seq] ']' 
+StarTarget::StarTarget(Tokenizer *tokenizer, string indent) {
+    log(__FUNCTION__, DEBUG); add_indent(2);
+    this->tokenizer = tokenizer;
+    this->indent = indent;
+    this->targets = nullptr;
+    this->primary = nullptr;
+    parse();
+    sub_indent(2);
+    log(__FUNCTION__ + (string)" - children.size() == " + to_string(children.size()), DEBUG);
+}
+StarTarget::~StarTarget() {
+    log(__FUNCTION__, DEBUG); add_indent(2);
+    for (AST* child : children) delete child;
+    children.clear();
+    if (targets != nullptr) delete targets;
+    if (primary != nullptr) delete primary;
+    sub_indent(2);
+}
+void StarTarget::parse() {
+    if (peek("StarTarget").value == "*") {
+        throw runtime_error("StarTarget: '*' not implemented");
+    }
+    if (peek("StarTarget").value == "(") {
+        eat_value("(", "StarTarget");
+        this->targets = new StarTargets(tokenizer, indent);
+        eat_value(")", "StarTarget");
+    }
+    else if (peek("StarTarget").value == "[") {
+        eat_value("[", "StarTarget");
+        this->targets = new StarTargets(tokenizer, indent, true);
+        eat_value("]", "StarTarget");
     }
+    else {
+        string first = peek("StarTarget").value;
+        this->primary = new Primary(tokenizer, indent);
+        if (primary->is_call()) {
+            throw PyException("SyntaxError", "cannot assign to function call");
+        }
+        if (primary->is_constant()) {
+            throw PyException("SyntaxError", "cannot assign to " + first);
+        }
+        if (!primary->is_name() && !primary->is_subscript()) {
+            throw PyException("SyntaxError", "cannot assign to literal");
+        }
+    }
+}
+bool StarTarget::is_single() const {
+    return primary != nullptr || targets->is_single();
+}
+void StarTarget::assign(Stack& stack, PyObject value) {
+    if (targets != nullptr) {
+        targets->assign(stack, value);
+    }
+    else if (primary->is_name()) {
+        stack.assign(primary->get_symbol(), value);
+    }
+    else {
+        primary->assign_item(stack, value);
+    }
+}
+void StarTarget::augassign(Stack& stack, string op, PyObject value) {
+    if (targets != nullptr) {
+        targets->augassign(stack, op, value);
+        return;
+    }
+    primary->augassign(stack, op, value);
+}
+PyObject StarTarget::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("StarTarget::evaluate");
+    throw runtime_error("StarTarget::evaluate() targets are assigned, not evaluated");
+}
+ostream& StarTarget::print(ostream& os) const {
+    if (targets != nullptr) os << "(" << *targets << ")";
+    else os << *primary;
     return os;
 }
+vector<AST*> StarTarget::all_children() const {
+    vector<AST*> all = this->children;
+    if (this->targets != nullptr) all.push_back(this->targets);
+    if (this->primary != nullptr) all.push_back(this->primary);
+    return all;
+}
 
 
 //===============================================================
@@ -548,7 +849,8 @@ void IfStmt::parse() {
         children.push_back(new ElseBlock(tokenizer, indent));
     }
 }
-PyObject IfStmt::evaluate(Stack stack) {
+PyObject IfStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("IfStmt::evaluate");
     log("IfStmt::evaluate()", DEBUG); add_indent(2);
     PyObject ret;
     if (children.at(0)->evaluate(stack)) {
@@ -610,7 +912,8 @@ void ElifStmt::parse() {
         _else = new ElseBlock(tokenizer, indent);
     }
 }
-PyObject ElifStmt::evaluate(Stack stack) {
+PyObject ElifStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("ElifStmt::evaluate");
     log("ElifStmt::evaluate()", DEBUG); add_indent(2);
     PyObject ret;
     map<NamedExpression*, Block*>::iterator it;
@@ -667,7 +970,8 @@ void ElseBlock::parse() {
     eat_value(":", "ElseBlock");
     children.push_back(new Block(tokenizer, indent));
 }
-PyObject ElseBlock::evaluate(Stack stack) {
+PyObject ElseBlock::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("ElseBlock::evaluate");
     log("ElseBlock::evaluate()", DEBUG); add_indent(2);
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -698,16 +1002,43 @@ WhileStmt::~WhileStmt() {
     sub_indent(2);
 }
 void WhileStmt::parse() {
-    // TODO:
+    eat_value("while", "WhileStmt");
+    children.push_back(new NamedExpression(tokenizer, indent));
+    eat_value(":", "WhileStmt");
+    loop_depth++;
+    children.push_back(new Block(tokenizer, indent));
+    loop_depth--;
+    if (peek("WhileStmt").value == "else") {
+        children.push_back(new ElseBlock(tokenizer, indent));
+    }
 }
-PyObject WhileStmt::evaluate(Stack stack) {
-    // TODO:
-    log("WhileStmt::evaluate()", DEBUG); add_indent(2); sub_indent(2);
+PyObject WhileStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("WhileStmt::evaluate");
+    log("WhileStmt::evaluate()", DEBUG); add_indent(2);
+    while (children.at(0)->evaluate(stack)) {
+        children.at(1)->evaluate(stack);
+        if (stack.is_returning()) {
+            sub_indent(2);
+            return PyObject();
+        }
+        if (stack.is_breaking()) {
+            // else_block is skipped after a break
+            stack.clear_loop_flags();
+            sub_indent(2);
+            return PyObject();
+        }
+        stack.clear_loop_flags();  // continue
+    }
+    if (children.size() == 3) {
+        children.at(2)->evaluate(stack);
+    }
+    sub_indent(2);
     return PyObject();
 }
 ostream& WhileStmt::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
+    os << "while " << *children.at(0) << ":";
+    for (int i=1; i < children.size(); i++) {
+        os << *children.at(i);
     }
     return os;
 }
@@ -741,22 +1072,97 @@ ForStmt::~ForStmt() {
     log(__FUNCTION__, DEBUG); add_indent(2);
     for (AST* child : children) delete child;
     children.clear();
+    for (Name* target : targets) delete target;
+    targets.clear();
     sub_indent(2);
 }
 void ForStmt::parse() {
-    // TODO:
+    // NOTE: star_targets is limited to names, 'for a, b in ...' unpacks
+    eat_value("for", "ForStmt");
+    targets.push_back(new Name(tokenizer, indent));
+    while (peek("ForStmt").value == ",") {
+        eat_value(",", "ForStmt");
+        targets.push_back(new Name(tokenizer, indent));
+    }
+    eat_value("in", "ForStmt");
+    children.push_back(new StarExpressions(tokenizer, indent));
+    eat_value(":", "ForStmt");
+    loop_depth++;
+    children.push_back(new Block(tokenizer, indent));
+    loop_depth--;
+    if (peek("ForStmt").value == "else") {
+        children.push_back(new ElseBlock(tokenizer, indent));
+    }
 }
-PyObject ForStmt::evaluate(Stack stack) {
-    // TODO:
-    log("ForStmt::evaluate()", DEBUG); add_indent(2); sub_indent(2);
+PyObject ForStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("ForStmt::evaluate");
+    log("ForStmt::evaluate()", DEBUG); add_indent(2);
+    PyObject iterable = children.at(0)->evaluate(stack);
+    AST* body = children.at(1);
+
+    // each item is written straight into the target's local, ranges
+    // are counted natively and sequences are walked by index
+    int64_t idx = 0;
+    PyObject item;
+    PyObject* out = &item;
+    vector<PyObject*> slots;
+    while (iterable.iter_next(idx, *out)) {
+        if (slots.size() == 0) {
+            // first item, the loop variables only exist once something is assigned
+            for (Name* target : targets) {
+                slots.push_back(&stack.get_slot(target->symbol));
+            }
+            if (targets.size() == 1) {
+                *slots.at(0) = item;
+                out = slots.at(0);  // the rest go straight into the local
+            }
+        }
+        if (targets.size() > 1) {
+            if (item.size() != targets.size()) {
+                throw PyException("ValueError", "expected " + to_string(targets.size()) 
+                    + " values to unpack, got " + to_string(item.size()));
+            }
+            for (int i=0; i < targets.size(); i++) {
+                *slots.at(i) = item.at(i);
+            }
+        }
+
+        body->evaluate(stack);
+        if (stack.is_returning()) {
+            sub_indent(2);
+            return PyObject();
+        }
+        if (stack.is_breaking()) {
+            // else_block is skipped after a break
+            stack.clear_loop_flags();
+            sub_indent(2);
+            return PyObject();
+        }
+        stack.clear_loop_flags();  // continue
+    }
+    if (children.size() == 3) {
+        children.at(2)->evaluate(stack);
+    }
+    sub_indent(2);
     return PyObject(); // returns None
 }
 ostream& ForStmt::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
+    os << "for ";
+    for (int i=0; i < targets.size(); i++) {
+        if (i > 0) os << ", ";
+        os << *targets.at(i);
+    }
+    os << " in " << *children.at(0) << ":";
+    for (int i=1; i < children.size(); i++) {
+        os << *children.at(i);
     }
     return os;
 }
+vector<AST*> ForStmt::all_children() const {
+    vector<AST*> all(this->targets.begin(), this->targets.end());
+    all.insert(all.end(), this->children.begin(), this->children.end());
+    return all;
+}
 
 //===============================================================
 // WithStmt
@@ -783,7 +1189,8 @@ WithStmt::~WithStmt() {
 void WithStmt::parse() {
     // TODO:
 }
-PyObject WithStmt::evaluate(Stack stack) {
+PyObject WithStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("WithStmt::evaluate");
     // TODO:
     log("WithStmt::evaluate()", DEBUG); add_indent(2); sub_indent(2);
     return PyObject();
@@ -818,7 +1225,8 @@ WithItem::~WithItem() {
 void WithItem::parse() {
     // TODO:
 }
-PyObject WithItem::evaluate(Stack stack) {
+PyObject WithItem::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("WithItem::evaluate");
     // TODO:
     log("WithItem::evaluate()", DEBUG); add_indent(2); sub_indent(2);
     return PyObject();
@@ -833,6 +1241,9 @@ ostream& WithItem::print(ostream& os) const {
 //===============================================================
 // TryStmt
 
+// try_stmt:
+//     | 'try' ':' block finally_block 
+//     | 'try' ':' block except_block+ [else_block] [finally_block] 
 TryStmt::TryStmt(Tokenizer *tokenizer, string indent) {
     log(__FUNCTION__, DEBUG); add_indent(2);
     this->tokenizer = tokenizer;
@@ -848,14 +1259,94 @@ TryStmt::~TryStmt() {
     sub_indent(2);
 }
 void TryStmt::parse() {
-    // TODO:
+    this->else_block = nullptr;
+    this->finally_block = nullptr;
+    eat_value("try", "TryStmt");
+    eat_value(":", "TryStmt");
+    try_depth++;
+    this->body = new Block(tokenizer, indent);
+    children.push_back(this->body);
+    while (peek("TryStmt").value == "except") {
+        if (handlers.size() > 0 && handlers.back()->children.size() == 1) {
+            throw PyException("SyntaxError", "default 'except:' must be last");
+        }
+        handlers.push_back(new ExceptBlock(tokenizer, indent));
+        children.push_back(handlers.back());
+    }
+    if (handlers.size() > 0 && peek("TryStmt").value == "else") {
+        this->else_block = new ElseBlock(tokenizer, indent);
+        children.push_back(this->else_block);
+    }
+    if (peek("TryStmt").value == "finally") {
+        this->finally_block = new FinallyBlock(tokenizer, indent);
+        children.push_back(this->finally_block);
+    }
+    try_depth--;
+    if (handlers.size() == 0 && this->finally_block == nullptr) {
+        throw PyException("SyntaxError", "expected 'except' or 'finally' block");
+    }
 }
-PyObject TryStmt::evaluate(Stack stack) {
-    // TODO:
-    log("TryStmt::evaluate()", DEBUG); add_indent(2); sub_indent(2);
+PyObject TryStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("TryStmt::evaluate");
+    log("TryStmt::evaluate()", DEBUG); add_indent(2);
+    if (this->finally_block == nullptr) {
+        run_handlers(stack);
+        sub_indent(2);
+        return PyObject();
+    }
+    int log_indent = Logger::get_instance()->get_indent();
+    try {
+        run_handlers(stack);
+    } catch (...) {
+        Logger::get_instance()->set_indent(log_indent);
+        if (run_finally(stack)) {
+            // a return, break or continue in the finally block discards the exception
+            sub_indent(2);
+            return PyObject();
+        }
+        throw;
+    }
+    run_finally(stack);
+    sub_indent(2);
     return PyObject();
 }
+void TryStmt::run_handlers(Stack& stack) {
+    // entering the try costs nothing, the C++ unwinder only looks this
+    // handler up in its tables once something is actually raised
+    int log_indent = Logger::get_instance()->get_indent();
+    try {
+        this->body->evaluate(stack);
+    } catch (PyException& e) {
+        // anything else is an interpreter error, no handler sees those
+        if (handlers.size() == 0) {
+            throw;
+        }
+        Logger::get_instance()->set_indent(log_indent);
+        for (ExceptBlock* handler : handlers) {
+            if (handler->matches(stack, e.cls)) {
+                handler->handle(stack, e.value);
+                return;
+            }
+        }
+        throw;
+    }
+    if (this->else_block != nullptr && !stack.is_unwinding()) {
+        this->else_block->evaluate(stack);
+    }
+}
+bool TryStmt::run_finally(Stack& stack) {
+    // a pending return/break/continue waits for the finally block, one
+    // from the finally block itself replaces it, returns true if so
+    PendingJump jump = stack.take_pending_jump();
+    this->finally_block->evaluate(stack);
+    if (stack.is_unwinding()) {
+        return true;
+    }
+    stack.restore_pending_jump(jump);
+    return false;
+}
 ostream& TryStmt::print(ostream& os) const {
+    os << "try:";
     for (AST *child : children) {
         os << *child;
     }
@@ -883,17 +1374,72 @@ ExceptBlock::~ExceptBlock() {
     sub_indent(2);
 }
 void ExceptBlock::parse() {
-    // TODO:
+    this->exception_type = nullptr;
+    this->name = "";
+    this->symbol = nullptr;
+    eat_value("except", "ExceptBlock");
+    if (peek("ExceptBlock").value != ":") {
+        this->exception_type = new Expression(tokenizer, indent);
+        children.push_back(this->exception_type);
+        if (peek("ExceptBlock").value == "as") {
+            eat_value("as", "ExceptBlock");
+            this->name = next_token().value;
+            this->symbol = intern(this->name);
+        }
+    }
+    eat_value(":", "ExceptBlock");
+    children.push_back(new Block(tokenizer, indent));
 }
-PyObject ExceptBlock::evaluate(Stack stack) {
-    // TODO:
-    log("ExceptBlock::evaluate()", DEBUG); add_indent(2); sub_indent(2);
-    return PyObject();
+bool ExceptBlock::matches(Stack& stack, const string& cls_name) {
+    if (this->exception_type == nullptr) {
+        return true;
+    }
+    // only evaluated once something was raised, 'except (A, B):' tries each
+    PyObject handler = this->exception_type->evaluate(stack);
+    vector<PyObject> classes = {handler};
+    if (handler.type == "tuple") {
+        classes = handler.as_list().items();
+    }
+    for (const PyObject& cls : classes) {
+        if (cls.type != "type") {
+            throw PyException("TypeError", "catching classes that do not inherit from BaseException is not allowed");
+        }
+        if (exception_matches(cls_name, cls.get_class_name())) {
+            return true;
+        }
+    }
+    return false;
+}
+void ExceptBlock::handle(Stack& stack, const PyObject& exception) {
+    log("ExceptBlock::handle()", DEBUG); add_indent(2);
+    if (this->symbol != nullptr) {
+        stack.get_slot(this->symbol) = exception;
+    }
+    // a bare 'raise' in here (or anything it calls) re-raises this one
+    stack.push_handled_exception(exception);
+    try {
+        children.back()->evaluate(stack);
+    } catch (...) {
+        stack.pop_handled_exception();
+        throw;
+    }
+    stack.pop_handled_exception();
+    sub_indent(2);
+}
+PyObject ExceptBlock::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("ExceptBlock::evaluate");
+    log("ExceptBlock::evaluate()", DEBUG); add_indent(2);
+    PyObject ret = children.back()->evaluate(stack);
+    sub_indent(2);
+    return ret;
 }
 ostream& ExceptBlock::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
+    os << indent << "except";
+    if (this->exception_type != nullptr) {
+        os << " " << *this->exception_type;
+        if (this->name != "") os << " as " << this->name;
     }
+    os << ":" << *children.back();
     return os;
 }
 
@@ -916,17 +1462,19 @@ FinallyBlock::~FinallyBlock() {
     sub_indent(2);
 }
 void FinallyBlock::parse() {
-    // TODO:
+    eat_value("finally", "FinallyBlock");
+    eat_value(":", "FinallyBlock");
+    children.push_back(new Block(tokenizer, indent));
 }
-PyObject FinallyBlock::evaluate(Stack stack) {
-    // TODO:
-    log("FinallyBlock::evaluate()", DEBUG); add_indent(2); sub_indent(2);
-    return PyObject();
+PyObject FinallyBlock::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("FinallyBlock::evaluate");
+    log("FinallyBlock::evaluate()", DEBUG); add_indent(2);
+    PyObject ret = children.at(0)->evaluate(stack);
+    sub_indent(2);
+    return ret;
 }
 ostream& FinallyBlock::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
-    }
+    os << indent << "finally:" << *children.at(0);
     return os;
 }
 
@@ -951,18 +1499,85 @@ ReturnStmt::~ReturnStmt() {
 }
 void ReturnStmt::parse() {
     eat_value("return", "ReturnStmt");
-    children.push_back(new StarExpressions(tokenizer, indent));
+    this->tail_call = nullptr;
+    if (peek("ReturnStmt").type != "NEWLINE") {
+        children.push_back(new StarExpressions(tokenizer, indent));
+        // NOTE: 'return f(x)' is a tail call, the current frame gets
+        // reused for f instead of growing the stack
+        if (try_depth == 0) this->tail_call = find_call(children.at(0));
+    }
 }
-PyObject ReturnStmt::evaluate(Stack stack) {
+PyObject ReturnStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("ReturnStmt::evaluate");
     log("ReturnStmt::evaluate()", DEBUG); add_indent(2);
-    PyObject temp = children.at(0)->evaluate(stack);
+    if (this->tail_call != nullptr) {
+        this->tail_call->evaluate_call(stack, true);
+        sub_indent(2);
+        return PyObject();
+    }
+    PyObject temp;  // bare 'return' is None
+    if (children.size() > 0) {
+        temp = children.at(0)->evaluate(stack);
+    }
     this->return_value = temp;
     stack.set_return_value(this->return_value);
     sub_indent(2);
     return PyObject();  // this value doesnt matter
 }
 ostream& ReturnStmt::print(ostream& os) const {
-    os << "return " << *children.at(0);
+    os << "return";
+    if (children.size() > 0) os << " " << *children.at(0);
+    return os;
+}
+
+//===============================================================
+// RaiseStmt
+
+// raise_stmt:
+//     | 'raise' expression ['from' expression ] 
+//     | 'raise' 
+RaiseStmt::RaiseStmt(Tokenizer *tokenizer, string indent) {
+    log(__FUNCTION__, DEBUG); add_indent(2);
+    this->tokenizer = tokenizer;
+    this->indent = indent;
+    parse();
+    sub_indent(2);
+    log(__FUNCTION__ + (string)" - children.size() == " + to_string(children.size()), DEBUG);
+}
+RaiseStmt::~RaiseStmt() {
+    log(__FUNCTION__, DEBUG); add_indent(2);
+    for (AST* child : children) delete child;
+    children.clear();
+    sub_indent(2);
+}
+void RaiseStmt::parse() {
+    eat_value("raise", "RaiseStmt");
+    if (peek("RaiseStmt").type != "NEWLINE") {
+        children.push_back(new Expression(tokenizer, indent));
+        if (peek("RaiseStmt").value == "from") {
+            throw runtime_error("RaiseStmt: 'from' not implemented");
+        }
+    }
+}
+PyObject RaiseStmt::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("RaiseStmt::evaluate");
+    log("RaiseStmt::evaluate()", DEBUG);
+    if (children.size() == 0) {
+        // re-raise the exception the enclosing except block is handling
+        throw PyException(stack.current_exception());
+    }
+    PyObject value = children.at(0)->evaluate(stack);
+    if (value.type == "type") {
+        value = new_exception(value.get_class_name(), PyObject(vector<PyObject>(), "tuple"));
+    }
+    else if (value.type != "exception") {
+        throw PyException("TypeError", "exceptions must derive from BaseException");
+    }
+    throw PyException(value);
+}
+ostream& RaiseStmt::print(ostream& os) const {
+    os << "raise";
+    if (children.size() > 0) os << " " << *children.at(0);
     return os;
 }
 
@@ -990,7 +1605,8 @@ FunctionDef::~FunctionDef() {
 void FunctionDef::parse() {
     this->raw = new FunctionDefRaw(tokenizer, indent);
 }
-PyObject FunctionDef::evaluate(Stack stack) {
+PyObject FunctionDef::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("FunctionDef::evaluate");
     log("FunctionDef::evaluate()", DEBUG); add_indent(2);
     // add function definition to stack/frame
     stack.add_function(this);
@@ -1002,6 +1618,9 @@ ostream& FunctionDef::print(ostream& os) const {
     os << *this->raw;
     return os;
 }
+vector<AST*> FunctionDef::all_children() const {
+    return {this->raw};
+}
 
 //===============================================================
 // FunctionDefRaw
@@ -1027,15 +1646,25 @@ FunctionDefRaw::~FunctionDefRaw() {
     sub_indent(2);
 }
 void FunctionDefRaw::parse() {
+    this->line = peek("FunctionDefRaw").line_start;
     eat_value("def", "FunctionDefRaw");
     this->name = next_token().value;
+    this->symbol = intern(this->name);
+    Coverage::get_instance()->add_function(this->line, this->name);
     eat_value("(", "FunctionDefRaw");
     this->params = new Params(tokenizer, indent);
     eat_value(")", "FunctionDefRaw");
     eat_value(":", "FunctionDefRaw");
+    int outer_loop_depth = loop_depth;
+    int outer_try_depth = try_depth;
+    loop_depth = 0;
+    try_depth = 0;
     this->body = new Block(tokenizer, indent);
+    loop_depth = outer_loop_depth;
+    try_depth = outer_try_depth;
 }
-PyObject FunctionDefRaw::evaluate(Stack stack) {
+PyObject FunctionDefRaw::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("FunctionDefRaw::evaluate");
     log("FunctionDefRaw::evaluate()", DEBUG); add_indent(2); sub_indent(2);
     // function definition shouldnt return anything
     return PyObject();
@@ -1044,6 +1673,9 @@ ostream& FunctionDefRaw::print(ostream& os) const {
     os << "def " << name << "(" << *params << "):" << *body;
     return os;
 }
+vector<AST*> FunctionDefRaw::all_children() const {
+    return {this->params, this->body};
+}
 
 //===============================================================
 // Params
@@ -1067,7 +1699,8 @@ Params::~Params() {
 void Params::parse() {
     children.push_back(new Parameters(tokenizer, indent));
 }
-PyObject Params::evaluate(Stack stack) {
+PyObject Params::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Params::evaluate");
     log("Params::evaluate()", DEBUG); add_indent(2);
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -1168,14 +1801,15 @@ void Parameters::parse() {
         children.push_back(new StarEtc(tokenizer, indent));
     }
 }
-PyObject Parameters::evaluate(Stack stack) {
+PyObject Parameters::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Parameters::evaluate");
     log("Parameters::evaluate()", DEBUG); add_indent(2);
     vector<PyObject> results;
     for (AST *child : children) {
         results.push_back(child->evaluate(stack));
     }
     sub_indent(2);
-    return PyObject(results, "tuple");
+    return PyObject(move(results), "tuple");
 }
 ostream& Parameters::print(ostream& os) const {
     for (AST* child : children) os << *child;
@@ -1219,10 +1853,11 @@ void SlashNoDefault::parse() {
         eat_value(",", "SlashNoDefault");
     }
     else if (peek("SlashNoDefault").value != ")") {
-        throw runtime_error("SyntaxError: invalid syntax");
+        throw PyException("SyntaxError", "invalid syntax");
     }
 }
-PyObject SlashNoDefault::evaluate(Stack stack) {
+PyObject SlashNoDefault::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("SlashNoDefault::evaluate");
     log("SlashNoDefault::evaluate()", DEBUG); add_indent(2);
     
     sub_indent(2);
@@ -1271,10 +1906,11 @@ void SlashWithDefault::parse() {
         eat_value(",", "SlashWithDefault");
     }
     else if (peek("SlashWithDefault").value != ")") {
-        throw runtime_error("SyntaxError: invalid syntax");
+        throw PyException("SyntaxError", "invalid syntax");
     }
 }
-PyObject SlashWithDefault::evaluate(Stack stack) {
+PyObject SlashWithDefault::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("SlashWithDefault::evaluate");
     log("SlashWithDefault::evaluate()", DEBUG); add_indent(2);
     
     sub_indent(2);
@@ -1330,14 +1966,15 @@ void StarEtc::parse() {
         throw runtime_error("Reached end of StarEtc with no children");
     }
 }
-PyObject StarEtc::evaluate(Stack stack) {
+PyObject StarEtc::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("StarEtc::evaluate");
     log("StarEtc::evaluate()", DEBUG); add_indent(2);
     vector<PyObject> results;
     for (AST *child : children) {
         results.push_back(child->evaluate(stack));
     }
     sub_indent(2);
-    return PyObject(results, "tuple");
+    return PyObject(move(results), "tuple");
 }
 ostream& StarEtc::print(ostream& os) const {
     os << *children.at(0);
@@ -1366,7 +2003,8 @@ void Kwds::parse() {
     eat_value("**", "Kwds");
     children.push_back(new ParamNoDefault(tokenizer, indent));
 }
-PyObject Kwds::evaluate(Stack stack) {
+PyObject Kwds::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Kwds::evaluate");
     log("Kwds::evaluate()", DEBUG); add_indent(2);
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -1411,10 +2049,12 @@ void ParamNoDefault::parse() {
         }
     }
 }
-PyObject ParamNoDefault::evaluate(Stack stack) {
+PyObject ParamNoDefault::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("ParamNoDefault::evaluate");
     log("ParamNoDefault::evaluate()", DEBUG); add_indent(2);
-    PyObject param_name = children.at(0)->evaluate(stack);
+    Param* param = dynamic_cast<Param*>(children.at(0));
     PyObject arg = stack.next_param();
+    stack.assign(param->get_symbol(), arg);
 
     // if (get<0>(arg) != PyObject() && get<0>(arg) != param_name) {
     //     string func_name = stack.get_function_name();
@@ -1459,7 +2099,8 @@ void ParamWithDefault::parse() {
         }
     }
 }
-PyObject ParamWithDefault::evaluate(Stack stack) {
+PyObject ParamWithDefault::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("ParamWithDefault::evaluate");
     log("ParamWithDefault::evaluate()", DEBUG); add_indent(2);
     
     sub_indent(2);
@@ -1505,7 +2146,8 @@ void ParamMaybeDefault::parse() {
         }
     }
 }
-PyObject ParamMaybeDefault::evaluate(Stack stack) {
+PyObject ParamMaybeDefault::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("ParamMaybeDefault::evaluate");
     log("ParamMaybeDefault::evaluate()", DEBUG); add_indent(2);
     
     sub_indent(2);
@@ -1537,16 +2179,23 @@ Param::~Param() {
 void Param::parse() {
     this->name = new Name(tokenizer, indent);
 }
-PyObject Param::evaluate(Stack stack) {
+PyObject Param::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Param::evaluate");
     log("Param::evaluate()", DEBUG);
     // NOTE: calling evaluate on the Name* will call get_value()
     // on the stack, I just want the actual name of the Param
     return PyObject(this->name->token.value, "str");
 }
+Symbol Param::get_symbol() const {
+    return this->name->symbol;
+}
 ostream& Param::print(ostream& os) const {
     os << this->name->token.value;
     return os;
 }
+vector<AST*> Param::all_children() const {
+    return {this->name};
+}
 
 //===============================================================
 // Default
@@ -1573,7 +2222,8 @@ void Default::parse() {
     }
     // NOTE: if 0 children case is for maybe_default productions
 }
-PyObject Default::evaluate(Stack stack) {
+PyObject Default::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Default::evaluate");
     log("Default::evaluate()", DEBUG); add_indent(2);
     return children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -1627,11 +2277,13 @@ void Block::parse() {
         children.push_back(new Statement(tokenizer, indent));
     }
 }
-PyObject Block::evaluate(Stack stack) {
+PyObject Block::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Block::evaluate");
     log("Block::evaluate()", DEBUG); add_indent(2);
     for (AST* child : children) {
         child->evaluate(stack);
-        if (stack.is_returning()) {
+        if (stack.is_unwinding()) {
+            // return, break or continue
             sub_indent(2);
             return PyObject();
         }
@@ -1675,14 +2327,19 @@ StarExpressions::~StarExpressions() {
     sub_indent(2);
 }
 void StarExpressions::parse() {
+    this->is_tuple = false;
     children.push_back(new StarExpression(tokenizer, indent));
     while(peek("StarExpressions").value == ",") {
+        eat_value(",", "StarExpressions");
+        this->is_tuple = true;
+        if (ends_expressions(peek("StarExpressions"))) break;  // trailing ','
         children.push_back(new StarExpression(tokenizer, indent));
     }
 }
-PyObject StarExpressions::evaluate(Stack stack) {
+PyObject StarExpressions::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("StarExpressions::evaluate");
     log("StarExpressions::evaluate()", DEBUG); add_indent(2);
-    if (children.size() == 1) {
+    if (!is_tuple) {
         PyObject ret = children.at(0)->evaluate(stack);
         sub_indent(2);
         return ret;
@@ -1692,12 +2349,14 @@ PyObject StarExpressions::evaluate(Stack stack) {
         results.push_back(child->evaluate(stack));
     }
     sub_indent(2);
-    return PyObject(results, "tuple");
+    return PyObject(move(results), "tuple");
 }
 ostream& StarExpressions::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
+    for (int i=0; i < children.size(); i++) {
+        if (i > 0) os << ", ";
+        os << *children.at(i);
     }
+    if (is_tuple && children.size() == 1) os << ",";
     return os;
 }
 
@@ -1730,7 +2389,8 @@ void StarExpression::parse() {
         children.push_back(new Expression(tokenizer, indent));
     }
 }
-PyObject StarExpression::evaluate(Stack stack) {
+PyObject StarExpression::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("StarExpression::evaluate");
     log("StarExpression::evaluate()", DEBUG); add_indent(2);
     // TODO: figure out how the * grammar works in practice
     PyObject ret = children.at(0)->evaluate(stack);
@@ -1766,18 +2426,26 @@ void StarNamedExpressions::parse() {
     children.push_back(new StarNamedExpression(tokenizer, indent));
     while (peek("StarNamedExpressions").value == ",") {
         eat_value(",", "StarNamedExpressions");
+        if (ends_expressions(peek("StarNamedExpressions"))) break;  // trailing ','
         children.push_back(new StarNamedExpression(tokenizer, indent));
     }
 }
-PyObject StarNamedExpressions::evaluate(Stack stack) {
-    log("StarNamedExpressions::evaluate()", DEBUG); add_indent(2);
-    // NOTE: this always needs to return an iterable
+// the bare items, for displays that pick their own container
+vector<PyObject> StarNamedExpressions::evaluate_items(Stack& stack) {
     vector<PyObject> results;
+    results.reserve(children.size());
     for (AST *child : children) {
         results.push_back(child->evaluate(stack));
     }
+    return results;
+}
+PyObject StarNamedExpressions::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("StarNamedExpressions::evaluate");
+    log("StarNamedExpressions::evaluate()", DEBUG); add_indent(2);
+    // NOTE: this always needs to return an iterable
+    PyObject ret = PyObject(evaluate_items(stack), "tuple");
     sub_indent(2);
-    return PyObject(results, "tuple");
+    return ret;
 }
 ostream& StarNamedExpressions::print(ostream& os) const {
     for (AST *child : children) {
@@ -1807,7 +2475,6 @@ StarNamedExpression::~StarNamedExpression() {
     sub_indent(2);
 }
 void StarNamedExpression::parse() {
-    log("StarNamedExpression::evaluate()", DEBUG); add_indent(2);
     if (peek("StarNamedExpression").value == "*") {
         children.push_back(new Op(tokenizer, indent));
         children.push_back(new BitwiseOr(tokenizer, indent));
@@ -1816,7 +2483,9 @@ void StarNamedExpression::parse() {
         children.push_back(new NamedExpression(tokenizer, indent));
     }
 }
-PyObject StarNamedExpression::evaluate(Stack stack) {
+PyObject StarNamedExpression::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("StarNamedExpression::evaluate");
+    log("StarNamedExpression::evaluate()", DEBUG); add_indent(2);
     // TODO: figure out how the star is gonna work
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -1853,7 +2522,8 @@ void NamedExpression::parse() {
     // TODO: handle ':=' case
     children.push_back(new Expression(tokenizer, indent));
 }
-PyObject NamedExpression::evaluate(Stack stack) {
+PyObject NamedExpression::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("NamedExpression::evaluate");
     log("NamedExpression::evaluate()", DEBUG); add_indent(2);
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -1894,14 +2564,19 @@ Expressions::~Expressions() {
     sub_indent(2);
 }
 void Expressions::parse() {
+    this->is_tuple = false;
     children.push_back(new Expression(tokenizer, indent));
     while(peek("Expressions").value == ",") {
+        eat_value(",", "Expressions");
+        this->is_tuple = true;
+        if (ends_expressions(peek("Expressions"))) break;  // trailing ','
         children.push_back(new Expression(tokenizer, indent));
     }
 }
-PyObject Expressions::evaluate(Stack stack) {
+PyObject Expressions::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Expressions::evaluate");
     log("Expressions::evaluate()", DEBUG); add_indent(2);
-    if (children.size() == 1) {
+    if (!is_tuple) {
         PyObject ret = children.at(0)->evaluate(stack);
         sub_indent(2);
         return ret;
@@ -1911,12 +2586,14 @@ PyObject Expressions::evaluate(Stack stack) {
         results.push_back(child->evaluate(stack));
     }
     sub_indent(2);
-    return PyObject(results, "tuple");
+    return PyObject(move(results), "tuple");
 }
 ostream& Expressions::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
+    for (int i=0; i < children.size(); i++) {
+        if (i > 0) os << ", ";
+        os << *children.at(i);
     }
+    if (is_tuple && children.size() == 1) os << ",";
     return os;
 }
 
@@ -1948,7 +2625,8 @@ void Expression::parse() {
     }
     children.push_back(new Disjunction(tokenizer, indent));
 }
-PyObject Expression::evaluate(Stack stack) {
+PyObject Expression::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Expression::evaluate");
     log("Expression::evaluate()", DEBUG); add_indent(2);
     // TODO: implement case (1)
     if (children.size() == 1) {
@@ -1992,7 +2670,8 @@ void Disjunction::parse() {
         children.push_back(new Conjunction(tokenizer, indent));
     }
 }
-PyObject Disjunction::evaluate(Stack stack) {
+PyObject Disjunction::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Disjunction::evaluate");
     log("Disjunction::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
@@ -2042,7 +2721,8 @@ void Conjunction::parse() {
         children.push_back(new Inversion(tokenizer, indent));
     }
 }
-PyObject Conjunction::evaluate(Stack stack) {
+PyObject Conjunction::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Conjunction::evaluate");
     log("Conjunction::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
@@ -2091,7 +2771,8 @@ void Inversion::parse() {
     }
     children.push_back(new Comparison(tokenizer, indent));
 }
-PyObject Inversion::evaluate(Stack stack) {
+PyObject Inversion::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Inversion::evaluate");
     log("Inversion::evaluate()", DEBUG); add_indent(2);
     PyObject s = children.at(0)->evaluate(stack);
     if (s.type == "str" && s.as_string() == "not") {
@@ -2147,25 +2828,28 @@ void Comparison::parse() {
         children.push_back(new BitwiseOr(tokenizer, indent));
     }
 }
-PyObject Comparison::evaluate(Stack stack) {
+PyObject Comparison::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Comparison::evaluate");
     log("Comparison::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
         sub_indent(2);
         return ret;
     }
-    vector<PyObject> results;
-    for (AST *child : children) {
-        results.push_back(child->evaluate(stack));
-    }
-    while (results.size() > 1) {
-        string op = results.at(1);
-        PyObject right = results.at(2);
-        results.at(0) = apply_comparison_op(results.at(0), op, right);
-        results.erase(results.begin()+1, results.begin()+3);
+    // a < b < c is a < b and b < c, b is evaluated once and c only if
+    // needed. 'x in s' never builds anything besides the result
+    PyObject left = children.at(0)->evaluate(stack);
+    PyObject result;
+    for (int i=1; i < children.size(); i += 2) {
+        PyObject right = children.at(i+1)->evaluate(stack);
+        result = apply_comparison_op(left, dynamic_cast<Op*>(children.at(i))->token.value, right);
+        if (i+2 < children.size() && !result.as_bool()) {
+            break;
+        }
+        left = right;
     }
     sub_indent(2);
-    return results.front();
+    return result;
 }
 ostream& Comparison::print(ostream& os) const {
     for (AST *child : children) {
@@ -2201,25 +2885,26 @@ void BitwiseOr::parse() {
         children.push_back(new BitwiseXor(tokenizer, indent));
     }
 }
-PyObject BitwiseOr::evaluate(Stack stack) {
+PyObject BitwiseOr::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("BitwiseOr::evaluate");
     log("BitwiseOr::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
         sub_indent(2);
         return ret;
     }
-    vector<int> results;
-    for (AST *child : children) {
-        results.push_back(child->evaluate(stack));
+    // ints, or sets for union
+    PyObject result = children.at(0)->evaluate(stack);
+    for (int i=1; i < children.size(); i++) {
+        result = apply_binary_op(result, "|", children.at(i)->evaluate(stack));
     }
-    int result = accumulate(
-        results.begin(), results.end(), results.at(0), _bitwise_or);
     sub_indent(2);
-    return PyObject(result, "int");
+    return result;
 }
 ostream& BitwiseOr::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
+    for (int i=0; i < children.size(); i++) {
+        if (i > 0) os << "|";
+        os << *children.at(i);
     }
     return os;
 }
@@ -2251,25 +2936,26 @@ void BitwiseXor::parse() {
         children.push_back(new BitwiseAnd(tokenizer, indent));
     }
 }
-PyObject BitwiseXor::evaluate(Stack stack) {
+PyObject BitwiseXor::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("BitwiseXor::evaluate");
     log("BitwiseXor::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
         sub_indent(2);
         return ret;
     }
-    vector<int> results;
-    for (AST *child : children) {
-        results.push_back(child->evaluate(stack));
+    // ints, or sets for symmetric difference
+    PyObject result = children.at(0)->evaluate(stack);
+    for (int i=1; i < children.size(); i++) {
+        result = apply_binary_op(result, "^", children.at(i)->evaluate(stack));
     }
-    int result = accumulate(
-        results.begin(), results.end(), results.at(0), _bitwise_xor);
     sub_indent(2);
-    return PyObject(result, "int");
+    return result;
 }
 ostream& BitwiseXor::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
+    for (int i=0; i < children.size(); i++) {
+        if (i > 0) os << "^";
+        os << *children.at(i);
     }
     return os;
 }
@@ -2301,25 +2987,26 @@ void BitwiseAnd::parse() {
         children.push_back(new ShiftExpr(tokenizer, indent));
     }
 }
-PyObject BitwiseAnd::evaluate(Stack stack) {
+PyObject BitwiseAnd::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("BitwiseAnd::evaluate");
     log("BitwiseAnd::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
         sub_indent(2);
         return ret;
     }
-    vector<int> results;
-    for (AST *child : children) {
-        results.push_back(child->evaluate(stack));
+    // ints, or sets for intersection
+    PyObject result = children.at(0)->evaluate(stack);
+    for (int i=1; i < children.size(); i++) {
+        result = apply_binary_op(result, "&", children.at(i)->evaluate(stack));
     }
-    int result = accumulate(
-        results.begin(), results.end(), results.at(0), _bitwise_and);
     sub_indent(2);
-    return PyObject(result, "int");
+    return result;
 }
 ostream& BitwiseAnd::print(ostream& os) const {
-    for (AST *child : children) {
-        os << *child;
+    for (int i=0; i < children.size(); i++) {
+        if (i > 0) os << "&";
+        os << *children.at(i);
     }
     return os;
 }
@@ -2352,7 +3039,8 @@ void ShiftExpr::parse() {
         children.push_back(new Sum(tokenizer, indent));
     }
 }
-PyObject ShiftExpr::evaluate(Stack stack) {
+PyObject ShiftExpr::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("ShiftExpr::evaluate");
     log("ShiftExpr::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
@@ -2407,7 +3095,8 @@ void Sum::parse() {
         children.push_back(new Term(tokenizer, indent));
     }
 }
-PyObject Sum::evaluate(Stack stack) {
+PyObject Sum::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Sum::evaluate");
     log("Sum::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
@@ -2465,7 +3154,8 @@ void Term::parse() {
         children.push_back(new Factor(tokenizer, indent));
     }
 }
-PyObject Term::evaluate(Stack stack) {
+PyObject Term::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Term::evaluate");
     log("Term::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
@@ -2516,14 +3206,12 @@ Factor::~Factor() {
 }
 void Factor::parse() {
     if (is_factor_op(peek("Factor").value)) {
-        if (peek("Factor").value == "+") {
-            eat_value("+", "Factor");  // the '+' doesn't really do anything
-        }
         children.push_back(new Op(tokenizer, indent));
     }
     children.push_back(new Power(tokenizer, indent));
 }
-PyObject Factor::evaluate(Stack stack) {
+PyObject Factor::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Factor::evaluate");
     log("Factor::evaluate()", DEBUG); add_indent(2);
     if (children.size() == 1) {
         PyObject ret = children.at(0)->evaluate(stack);
@@ -2534,22 +3222,17 @@ PyObject Factor::evaluate(Stack stack) {
     PyObject val = children.at(1)->evaluate(stack);
     sub_indent(2);
     if (op == "-") {
-        if (val.type == "int") {
-            return PyObject(-(int)val, "int");
-        }
-        else if (val.type == "float") {
-            return PyObject(-(float)val, "float");
-        }
-        else if (val.type == "bool") {
-            return PyObject(-(bool)val, "bool");
-        }
-        else {
-            throw runtime_error("Unsupported PyObject of type \'" 
-                            + val.type + "\' in Factor::evaluate()\n");
-        }
+        return -val;
     }
     if (op == "~") {
-        return PyObject((int)(~val), "int");
+        return ~val;
+    }
+    if (op == "+") {
+        if (!val.is_number()) {
+            throw PyException("TypeError", "bad operand type for unary +: '" + val.type + "'");
+        }
+        // +True is 1
+        return val.type == "bool" ? val + PyObject(0, "int") : val;
     }
     throw runtime_error("reached end of Factor::evaluate() without returning");
 }
@@ -2587,7 +3270,8 @@ void Power::parse() {
         children.push_back(new Factor(tokenizer, indent));
     }
 }
-PyObject Power::evaluate(Stack stack) {
+PyObject Power::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Power::evaluate");
     log("Power::evaluate()", DEBUG); add_indent(2);
     PyObject ret;
     if (children.size() == 1){
@@ -2630,7 +3314,8 @@ void AwaitPrimary::parse() {
     // TODO: implement this completely
     children.push_back(new Primary(tokenizer, indent));
 }
-PyObject AwaitPrimary::evaluate(Stack stack) {
+PyObject AwaitPrimary::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("AwaitPrimary::evaluate");
     log("AwaitPrimary::evaluate()", DEBUG); add_indent(2);
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -2668,38 +3353,131 @@ Primary::~Primary() {
     sub_indent(2);
 }
 void Primary::parse() {
-    // NOTE: this is supposed to be a left recusive production
-    // im keeping it simple atm but its likely that a while loop will
-    // be needed like Term, Sum, etc
+    // NOTE: primary is left recursive, the trailers are kept flat in
+    // children as (op, inner, op) triples after the atom
     children.push_back(new Atom(tokenizer, indent));
-    if (peek("Primary").value == ".") {
-        // TODO: implement
-        throw runtime_error("Primary: '.' not implemented");
-    } else if(peek("Primary").value == "(") {
-        children.push_back(new Op(tokenizer, indent));  // (
-        children.push_back(new Arguments(tokenizer, indent));
-        children.push_back(new Op(tokenizer, indent));  // )
+    while (true) {
+        if (peek("Primary").value == ".") {
+            // TODO: implement
+            throw runtime_error("Primary: '.' not implemented");
+        } else if(peek("Primary").value == "(") {
+            children.push_back(new Op(tokenizer, indent));  // (
+            children.push_back(new Arguments(tokenizer, indent));
+            children.push_back(new Op(tokenizer, indent));  // )
+        } else if(peek("Primary").value == "[") {
+            children.push_back(new Op(tokenizer, indent));  // [
+            children.push_back(new Slices(tokenizer, indent));
+            children.push_back(new Op(tokenizer, indent));  // ]
+        } else {
+            break;
+        }
     }
 }
-PyObject Primary::evaluate(Stack stack) {
-    log("Primary::evaluate()", DEBUG); add_indent(2);
-    PyObject ret;
+bool Primary::is_call() const {
+    return children.size() > 1 && dynamic_cast<Op*>(children.back())->token.value == ")";
+}
+bool Primary::is_name() const {
+    return children.size() == 1 && dynamic_cast<Name*>(children.at(0)->children.at(0)) != nullptr;
+}
+// True, False and None are literals, never a target
+bool Primary::is_constant() const {
+    if (children.size() != 1) return false;
+    AST* atom = children.at(0)->children.at(0);
+    return dynamic_cast<Bool*>(atom) != nullptr || dynamic_cast<_None*>(atom) != nullptr;
+}
+bool Primary::is_subscript() const {
+    return children.size() > 1 && dynamic_cast<Op*>(children.back())->token.value == "]";
+}
+Symbol Primary::get_symbol() const {
+    return dynamic_cast<Name*>(children.at(0)->children.at(0))->symbol;
+}
+PyObject Primary::evaluate_trailer(Stack& stack, PyObject value, int i) {
+    if (dynamic_cast<Op*>(children.at(i))->token.value == "(") {
+        return stack.call_function(value, children.at(i+1)->evaluate(stack));
+    }
+    return value.get_item(children.at(i+1)->evaluate(stack));
+}
+// the stored object the trailers before end lead to, the atom has
+// to be a name. keys are evaluated up front since that could run code
+// that moves the storage
+PyObject& Primary::reference(Stack& stack, int end) {
+    Name* name = dynamic_cast<Name*>(children.at(0)->children.at(0));
+    if (name == nullptr) {
+        throw runtime_error("Primary: assigning through an expression not implemented");
+    }
+    vector<PyObject> keys;
+    for (int i=1; i < end; i += 3) {
+        if (dynamic_cast<Op*>(children.at(i))->token.value == "(") {
+            throw runtime_error("Primary: assigning through a call not implemented");
+        }
+        keys.push_back(children.at(i+1)->evaluate(stack));
+    }
+    if (end == 1) {
+        return stack.get_local_ref(name->symbol);
+    }
+    PyObject* ref = &stack.get_ref(name->symbol);
+    for (PyObject& key : keys) {
+        ref = &ref->item_ref(key);
+    }
+    return *ref;
+}
+// x[i] = value
+void Primary::assign_item(Stack& stack, PyObject value) {
+    PyObject key = children.at(children.size()-2)->evaluate(stack);
+    reference(stack, children.size()-3).set_item(key, value);
+}
+// x op= value and x[i] op= value
+void Primary::augassign(Stack& stack, string op, PyObject value) {
     if (children.size() == 1) {
-        ret = children.at(0)->evaluate(stack);
-        sub_indent(2);
-        return ret;
+        apply_augassign(reference(stack, 1), op, value);
+        return;
     }
-    else {
-        PyObject c1 = children.at(1)->evaluate(stack);
-        if ((string)c1 == "(") {
-            PyObject func_name = children.at(0)->evaluate(stack);
-            PyObject arguments = children.at(2)->evaluate(stack);
-            PyObject ret = stack.call_function(func_name, arguments);
-            sub_indent(2);
-            return ret;
+    PyObject key = children.at(children.size()-2)->evaluate(stack);
+    PyObject& container = reference(stack, children.size()-3);
+    if (container.type != "list") {
+        apply_augassign(container.item_ref(key), op, value);
+        return;
+    }
+    // a packed list has no PyObject to update, the item goes back in
+    // through set_item which keeps the storage unboxed
+    PyObject item = container.get_item(key);
+    apply_augassign(item, op, value);
+    container.set_item(key, item);
+}
+// tail is set for 'return f(...)', the call is handed to the stack
+// to run in the current frame once it unwinds
+PyObject Primary::evaluate_call(Stack& stack, bool tail) {
+    PyObject function = children.at(0)->evaluate(stack);
+    int last = children.size()-3;
+    for (int i=1; i < last; i += 3) {
+        function = evaluate_trailer(stack, function, i);
+    }
+    if (function.type == "builtin_function_or_method") {
+        // builtins take the arguments as a span, nothing to pack
+        Arguments* arguments = dynamic_cast<Arguments*>(children.at(last+1));
+        PyObject ret = arguments->call_builtin(stack, function.get_builtin());
+        if (tail) {
+            stack.set_return_value(ret);
+            return PyObject();
         }
+        return ret;
+    }
+    PyObject arguments = children.at(last+1)->evaluate(stack);
+    if (tail) {
+        stack.tail_call(function, arguments);
+        return PyObject();
     }
-    throw runtime_error("reached end of Primary::evaluate() without returning");
+    return stack.call_function(function, arguments);
+}
+PyObject Primary::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Primary::evaluate");
+    log("Primary::evaluate()", DEBUG); add_indent(2);
+    PyObject ret = children.at(0)->evaluate(stack);
+    for (int i=1; i < children.size(); i += 3) {
+        ret = evaluate_trailer(stack, ret, i);
+    }
+    sub_indent(2);
+    return ret;
 }
 ostream& Primary::print(ostream& os) const {
     for (AST *child : children) {
@@ -2729,13 +3507,36 @@ Slices::~Slices() {
     sub_indent(2);
 }
 void Slices::parse() {
-
-}
-PyObject Slices::evaluate(Stack stack) {
-    throw runtime_error("Slices::evaluate() not implemented");
+    this->is_tuple = false;
+    children.push_back(new Slice(tokenizer, indent));
+    while (peek("Slices").value == ",") {
+        eat_value(",", "Slices");
+        this->is_tuple = true;
+        if (peek("Slices").value == "]") break;
+        children.push_back(new Slice(tokenizer, indent));
+    }
+}
+PyObject Slices::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Slices::evaluate");
+    log("Slices::evaluate()", DEBUG); add_indent(2);
+    if (!is_tuple) {
+        PyObject ret = children.at(0)->evaluate(stack);
+        sub_indent(2);
+        return ret;
+    }
+    vector<PyObject> keys;
+    for (AST* child : children) {
+        keys.push_back(child->evaluate(stack));
+    }
+    sub_indent(2);
+    return PyObject(move(keys), "tuple");
 }
 ostream& Slices::print(ostream& os) const {
-
+    for (int i=0; i < children.size(); i++) {
+        if (i > 0) os << ",";
+        os << *children.at(i);
+    }
+    if (is_tuple && children.size() == 1) os << ",";
     return os;
 }
 
@@ -2760,13 +3561,24 @@ Slice::~Slice() {
     sub_indent(2);
 }
 void Slice::parse() {
-
+    // TODO: start:stop:step slices
+    if (peek("Slice").value == ":") {
+        throw runtime_error("Slice: ':' not implemented");
+    }
+    children.push_back(new Expression(tokenizer, indent));
+    if (peek("Slice").value == ":") {
+        throw runtime_error("Slice: ':' not implemented");
+    }
 }
-PyObject Slice::evaluate(Stack stack) {
-    throw runtime_error("Slice::evaluate() not implemented");
+PyObject Slice::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Slice::evaluate");
+    log("Slice::evaluate()", DEBUG); add_indent(2);
+    PyObject ret = children.at(0)->evaluate(stack);
+    sub_indent(2);
+    return ret;
 }
 ostream& Slice::print(ostream& os) const {
-
+    os << *children.at(0);
     return os;
 }
 
@@ -2800,13 +3612,15 @@ Atom::~Atom() {
     sub_indent(2);
 }
 void Atom::parse() {
-    cout << peek("Atom").value.size() << endl;
     if (is_number(peek("Atom").value)) {
         children.push_back(new Number(tokenizer, indent));
     } 
     else if (peek("Atom").value == "True" || peek("Atom").value == "False") {
         children.push_back(new Bool(tokenizer, indent));
     }
+    else if (peek("Atom").value == "None") {
+        children.push_back(new _None(tokenizer, indent));
+    }
     else if (peek("Atom").value == "(") {
         // TODO: figure out a cleaner way to determine if this should be
         // a tuple, group, or genexp
@@ -2817,15 +3631,18 @@ void Atom::parse() {
         // a list or listcomp
         children.push_back(new List(tokenizer, indent));
     }
+    else if (peek("Atom").value == "{") {
+        children.push_back(new Dict(tokenizer, indent));
+    }
     else if (peek("Atom").value.at(0) == '"' || peek("Atom").value.at(0) == '\'') {
         children.push_back(new _String(tokenizer, indent));
     }
     else {
         children.push_back(new Name(tokenizer, indent));
     }
-    cout << peek("Atom").value.size() << endl;
 }
-PyObject Atom::evaluate(Stack stack) {
+PyObject Atom::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Atom::evaluate");
     log("Atom::evaluate()", DEBUG); add_indent(2);
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -2859,12 +3676,22 @@ List::~List() {
 }
 void List::parse() {
     eat_value("[", "List");
-    children.push_back(new StarNamedExpressions(tokenizer, indent));
+    if (peek("List").value != "]") {
+        children.push_back(new StarNamedExpressions(tokenizer, indent));
+    }
     eat_value("]", "List");
 }
-PyObject List::evaluate(Stack stack) {
+PyObject List::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("List::evaluate");
+    MemScope mem_scope(MEM_LIST);
     log("List::evaluate()", DEBUG); add_indent(2);
-    PyObject ret = PyObject(children.at(0)->evaluate(stack).as_list(), "list");
+    if (children.size() == 0) {
+        sub_indent(2);
+        return PyObject(vector<PyObject>(), "list");
+    }
+    // built from the bare items so numbers can be packed
+    StarNamedExpressions* items = dynamic_cast<StarNamedExpressions*>(children.at(0));
+    PyObject ret = PyObject(items->evaluate_items(stack), "list");
     sub_indent(2);
     return ret;
 }
@@ -2880,6 +3707,89 @@ ostream& List::print(ostream& os) const {
     return os;
 }
 
+//===============================================================
+// Dict
+
+// dict:
+//     | '{' [double_starred_kvpairs] '}' 
+// double_starred_kvpairs: ','.double_starred_kvpair+ [','] 
+// double_starred_kvpair:
+//     | '**' bitwise_or 
+//     | kvpair
+// kvpair: expression ':' expression 
+// set: '{' star_named_expressions '}' 
+Dict::Dict(Tokenizer *tokenizer, string indent) {
+    log(__FUNCTION__, DEBUG); add_indent(2);
+    this->tokenizer = tokenizer;
+    this->indent = indent;
+    parse();
+    sub_indent(2);
+    log(__FUNCTION__ + (string)" - children.size() == " + to_string(children.size()), DEBUG);
+}
+Dict::~Dict() {
+    log(__FUNCTION__, DEBUG); add_indent(2);
+    for (AST* child : children) delete child;
+    children.clear();
+    sub_indent(2);
+}
+void Dict::parse() {
+    // NOTE: for dicts children alternate key, value. '{}' is a dict, the
+    // first item decides between the two
+    this->is_set = false;
+    eat_value("{", "Dict");
+    while (peek("Dict").value != "}") {
+        if (peek("Dict").value == "**" || peek("Dict").value == "*") {
+            throw runtime_error("Dict: unpacking not implemented");
+        }
+        children.push_back(new Expression(tokenizer, indent));
+        if (children.size() == 1 && peek("Dict").value != ":") {
+            this->is_set = true;
+        }
+        if (!this->is_set) {
+            eat_value(":", "Dict");
+            children.push_back(new Expression(tokenizer, indent));
+        }
+        if (peek("Dict").value != "}") {
+            eat_value(",", "Dict");
+        }
+    }
+    eat_value("}", "Dict");
+}
+PyObject Dict::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Dict::evaluate");
+    MemScope mem_scope(this->is_set ? MEM_SET : MEM_DICT);
+    log("Dict::evaluate()", DEBUG); add_indent(2);
+    if (this->is_set) {
+        PySet set;
+        set.reserve(children.size());
+        for (AST* child : children) {
+            set.insert(child->evaluate(stack));
+        }
+        sub_indent(2);
+        return PyObject(move(set), "set");
+    }
+    PyDict dict;
+    for (int i=0; i < children.size(); i += 2) {
+        PyObject key = children.at(i)->evaluate(stack);
+        dict.set(key, children.at(i+1)->evaluate(stack));
+    }
+    sub_indent(2);
+    return PyObject(move(dict), "dict");
+}
+ostream& Dict::print(ostream& os) const {
+    os << "{";
+    for (int i=0; this->is_set && i < children.size(); i++) {
+        if (i > 0) os << ",";
+        os << *children.at(i);
+    }
+    for (int i=0; !this->is_set && i < children.size(); i += 2) {
+        if (i > 0) os << ",";
+        os << *children.at(i) << ":" << *children.at(i+1);
+    }
+    os << "}";
+    return os;
+}
+
 //===============================================================
 // Tuple
 
@@ -2906,37 +3816,52 @@ Tuple::~Tuple() {
     sub_indent(2);
 }
 void Tuple::parse() {
+    this->is_group = false;
     eat_value("(", "Tuple");
     if (peek("Tuple").value != ")") {
         children.push_back(new StarNamedExpression(tokenizer, indent));
-        eat_value(",", "Tuple");
+        if (peek("Tuple").value == ")") {
+            // group: '(' expression ')'
+            this->is_group = true;
+        } else {
+            eat_value(",", "Tuple");
+        }
     }
     if (peek("Tuple").value != ")") {
         children.push_back(new StarNamedExpressions(tokenizer, indent));
     }
     eat_value(")", "Tuple");
 }
-PyObject Tuple::evaluate(Stack stack) {
+PyObject Tuple::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Tuple::evaluate");
+    MemScope mem_scope(MEM_LIST);
     log("Tuple::evaluate()", DEBUG); add_indent(2);
-    if (children.size() == 0) {
+    if (is_group) {
         PyObject ret = children.at(0)->evaluate(stack);
         sub_indent(2);
         return ret;
     }
     vector<PyObject> results;
-    for (AST *child : children) {
-        results.push_back(child->evaluate(stack));
+    if (children.size() > 0) {
+        results.push_back(children.at(0)->evaluate(stack));
+    }
+    if (children.size() > 1) {
+        StarNamedExpressions* rest = dynamic_cast<StarNamedExpressions*>(children.at(1));
+        for (PyObject& item : rest->evaluate_items(stack)) {
+            results.push_back(move(item));
+        }
     }
     sub_indent(2);
-    return PyObject(results, "tuple");
+    return PyObject(move(results), "tuple");
 }
 ostream& Tuple::print(ostream& os) const {
     os << "(";
     if (children.size() > 0) {
-        for (int i=0; i < children.size()-1; i++) {
-            os << *(children.at(i)) << ",";
-        }
-        os << *children.back();
+        os << *children.at(0);
+        if (!is_group) os << ",";
+    }
+    if (children.size() > 1) {
+        os << *children.at(1);
     }
     os << ")";
     return os;
@@ -2967,14 +3892,18 @@ void Arguments::parse() {
         eat_value(",", "Arguments");
     }
     if (peek("Arguments").value != ")") {
-        throw runtime_error("SyntaxError: invalid syntax");
+        throw PyException("SyntaxError", "invalid syntax");
     }
 }
-PyObject Arguments::evaluate(Stack stack) {
+PyObject Arguments::call_builtin(Stack& stack, const Builtin* builtin) {
+    return dynamic_cast<Args*>(children.at(0))->call_builtin(stack, builtin);
+}
+PyObject Arguments::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Arguments::evaluate");
     log("Arguments::evaluate()", DEBUG); add_indent(2);
-    children.at(0)->evaluate(stack);
+    PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
-    return PyObject();
+    return ret;
 }
 ostream& Arguments::print(ostream& os) const {
     os << *children.at(0);
@@ -3038,14 +3967,54 @@ void Args::parse() {
         children.push_back(new Kwargs(tokenizer, indent));
     }
 }
-PyObject Args::evaluate(Stack stack) {
+PyObject Args::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Args::evaluate");
     log("Args::evaluate()", DEBUG); add_indent(2);
     vector<PyObject> arguments;
-    for (AST* child : children) {
-        arguments.push_back(child->evaluate(stack));
+    Kwargs* kwargs = children.size() > 0 ? dynamic_cast<Kwargs*>(children.back()) : nullptr;
+    for (int i=0; i < children.size() - (kwargs != nullptr); i++) {
+        arguments.push_back(children.at(i)->evaluate(stack));
+    }
+    PyObject ret = PyObject(move(arguments), "tuple");
+    if (kwargs != nullptr) {
+        ret.set_keywords(kwargs->evaluate_keywords(stack));
     }
     sub_indent(2);
-    return PyObject(arguments, "list");
+    return ret;
+}
+// arguments built in raw storage, only the ones actually passed are
+// constructed and they are destroyed again however the call ends
+struct InlineArgs {
+    PyObject* items;
+    int size = 0;
+
+    ~InlineArgs() {
+        for (int i=0; i < size; i++) items[i].~PyObject();
+    }
+};
+
+PyObject Args::call_builtin(Stack& stack, const Builtin* builtin) {
+    Kwargs* kwargs = children.size() > 0 ? dynamic_cast<Kwargs*>(children.back()) : nullptr;
+    int nargs = children.size() - (kwargs != nullptr);
+    vector<PyObject> many_args;
+    alignas(PyObject) unsigned char storage[INLINE_ARGS * sizeof(PyObject)];
+    InlineArgs inline_args{(PyObject*)storage};
+    PyObject* args = inline_args.items;
+    if (nargs > INLINE_ARGS) {
+        many_args.reserve(nargs);
+        for (int i=0; i < nargs; i++) many_args.push_back(children.at(i)->evaluate(stack));
+        args = many_args.data();
+    } else {
+        for (int i=0; i < nargs; i++) {
+            new (&args[i]) PyObject(children.at(i)->evaluate(stack));
+            inline_args.size++;
+        }
+    }
+    if (kwargs != nullptr) {
+        PyDict keywords = kwargs->evaluate_keywords(stack);
+        return ::call_builtin(builtin, args, nargs, &keywords);
+    }
+    return ::call_builtin(builtin, args, nargs, nullptr);
 }
 ostream& Args::print(ostream& os) const {
     if (children.size() > 0) {
@@ -3078,21 +4047,43 @@ Kwargs::~Kwargs() {
     children.clear();
     sub_indent(2);
 }
+// only NAME '=' expression so far, no ** unpacking
 void Kwargs::parse() {
-
+    while (peek("Kwargs").value != ")") {
+        Token name = peek("Kwargs");
+        if (name.type != "NAME" || lookahead(1).value != "=") {
+            throw PyException("SyntaxError", "positional argument follows keyword argument");
+        }
+        if (find(names.begin(), names.end(), name.value) != names.end()) {
+            throw PyException("SyntaxError", "keyword argument repeated: " + name.value);
+        }
+        eat_type("NAME", "Kwargs");
+        eat_value("=", "Kwargs");
+        names.push_back(name.value);
+        children.push_back(new Expression(tokenizer, indent));
+        if (peek("Kwargs").value == ",") {
+            eat_value(",", "Kwargs");
+        }
+    }
+}
+PyDict Kwargs::evaluate_keywords(Stack& stack) {
+    PyDict keywords;
+    for (int i=0; i < children.size(); i++) {
+        keywords.set(PyObject(names.at(i), "str"), children.at(i)->evaluate(stack));
+    }
+    return keywords;
 }
-PyObject Kwargs::evaluate(Stack stack) {
+PyObject Kwargs::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Kwargs::evaluate");
     log("Kwargs::evaluate()", DEBUG); add_indent(2);
-
+    PyObject ret = PyObject(this->evaluate_keywords(stack), "dict");
     sub_indent(2);
-    return PyObject();
+    return ret;
 }
 ostream& Kwargs::print(ostream& os) const {
-    if (children.size() > 0) {
-        for (int i=0; i < children.size()-1; i++) {
-            os << *children.at(i) << ",";
-        }
-        os << *children.back();
+    for (int i=0; i < children.size(); i++) {
+        if (i > 0) os << ",";
+        os << names.at(i) << "=" << *children.at(i);
     }
     return os;
 }
@@ -3120,7 +4111,8 @@ void StarredExpression::parse() {
     eat_value("*", "StarredExpression");
     children.push_back(new Expression(tokenizer, indent));
 }
-PyObject StarredExpression::evaluate(Stack stack) {
+PyObject StarredExpression::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("StarredExpression::evaluate");
     log("StarredExpression::evaluate()", DEBUG); add_indent(2);
     PyObject ret = children.at(0)->evaluate(stack);
     sub_indent(2);
@@ -3148,7 +4140,8 @@ Op::~Op() {
 void Op::parse() {
     this->token = tokenizer->next_token();
 }
-PyObject Op::evaluate(Stack stack) {
+PyObject Op::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Op::evaluate");
     log("Op::evaluate() - '" + this->token.value + "'", DEBUG);
     return PyObject(this->token.value, "str");
 }
@@ -3171,15 +4164,43 @@ _String::~_String() {
     log(__FUNCTION__, DEBUG);
     tokenizer->rewind(1);
 }
+// backslash escapes, an unknown one is kept as it is like in Python
+string unescape(const string& s) {
+    string out;
+    out.reserve(s.size());
+    for (int i=0; i < s.size(); i++) {
+        if (s[i] != '\\' || i+1 == s.size()) {
+            out += s[i];
+            continue;
+        }
+        char c = s[++i];
+        if (c == 'n') out += '\n';
+        else if (c == 't') out += '\t';
+        else if (c == 'r') out += '\r';
+        else if (c == '0') out += '\0';
+        else if (c == '\\' || c == '\'' || c == '"') out += c;
+        else if (c == 'x' && i+2 < s.size() && isxdigit(s[i+1]) && isxdigit(s[i+2])) {
+            out += (char)stoi(s.substr(i+1, 2), nullptr, 16);
+            i += 2;
+        }
+        else {
+            out += '\\';
+            out += c;
+        }
+    }
+    return out;
+}
+
 void _String::parse() {
     this->token = tokenizer->next_token();
-    if (token.value.size() > 0 && token.value.at(0) == '"') {
-        this->value = token.value.substr(1, token.value.size()-2);
+    if (token.value.size() > 0 && (token.value.at(0) == '"' || token.value.at(0) == '\'')) {
+        this->value = unescape(token.value.substr(1, token.value.size()-2));
     } else {
         this->value = token.value;
     }
 }
-PyObject _String::evaluate(Stack stack) {
+PyObject _String::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("_String::evaluate");
     log("_String::evaluate() - '" + this->value + "'", DEBUG);
     return PyObject(this->value, "str");
 }
@@ -3205,10 +4226,16 @@ Name::~Name() {
 void Name::parse() {
     this->token = tokenizer->next_token();
     this->value = this->token.value;
+    // atoms take the literals first, a Name holding one is being bound
+    if (value == "None" || value == "True" || value == "False") {
+        throw PyException("SyntaxError", "cannot assign to " + value);
+    }
+    this->symbol = intern(this->value);
 }
-PyObject Name::evaluate(Stack stack) {
+PyObject Name::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Name::evaluate");
     log("Name::evaluate() - '" + this->value + "'", DEBUG);
-    return stack.get_value(this->value);
+    return stack.get_value(this->symbol);
 }
 ostream& Name::print(ostream& os) const {
     os << value;
@@ -3231,14 +4258,20 @@ Number::~Number() {
 }
 void Number::parse() {
     this->token = tokenizer->next_token();
-    this->is_int = this->token.value.find(".") == string::npos;
+    this->is_int = this->token.value.find_first_of(".eE") == string::npos;
 }
-PyObject Number::evaluate(Stack stack) {
+PyObject Number::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Number::evaluate");
     log("Number::evaluate() - " + token.value , DEBUG);
     if (this->is_int) {
-        return PyObject(stoi(token.value), "int");
+        // anything under 19 digits fits in an int64_t
+        if (token.value.size() <= 18) {
+            return PyObject((int64_t)stoll(token.value), "int");
+        }
+        return PyObject(BigInt::from_string(token.value), "int");
     }
-    return PyObject(stof(token.value), "float");
+    // strtod rounds out of range literals to inf or a denormal like Python
+    return PyObject(strtod(token.value.c_str(), nullptr), "float");
 }
 ostream& Number::print(ostream& os) const {
     os << token.value;
@@ -3263,7 +4296,8 @@ void Bool::parse() {
     this->token = tokenizer->next_token();
     this->bool_value = this->token.value == "True";
 }
-PyObject Bool::evaluate(Stack stack) {
+PyObject Bool::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("Bool::evaluate");
     log("Bool::evaluate() - " + this->bool_value, DEBUG);
     PyObject res = PyObject(this->bool_value, "bool");
     return res;
@@ -3274,3 +4308,27 @@ ostream& Bool::print(ostream& os) const {
 }
 
 //===============================================================
+// _None
+
+_None::_None(Tokenizer *tokenizer, string indent) {
+    log(__FUNCTION__, DEBUG);
+    this->tokenizer = tokenizer;
+    this->indent = indent;
+    parse();
+}
+_None::~_None() {
+    log(__FUNCTION__, DEBUG);
+}
+void _None::parse() {
+    eat_value("None", "_None");
+}
+PyObject _None::evaluate(Stack& stack) {
+    INSTRUMENT_SCOPE("_None::evaluate");
+    return PyObject();
+}
+ostream& _None::print(ostream& os) const {
+    os << "None";
+    return os;
+}
+
+//===============================================================
@@ -15,6 +15,7 @@
 #include "tokenizer.h"
 #include "token.h"
 #include "pyobject.h"
+#include "symbol.h"
 #include "stack.h"
 using namespace std;
 
@@ -30,6 +31,8 @@ class SimpleStmt;
 class SmallStmt;
 class CompoundStmt;
 class Assignment;
+class StarTargets;
+class StarTarget;
 class IfStmt;
 class ElifStmt;
 class ElseBlock;
@@ -41,6 +44,7 @@ class TryStmt;
 class ExceptBlock;
 class FinallyBlock;
 class ReturnStmt;
+class RaiseStmt;
 class FunctionDef;
 class FunctionDefRaw;
 class Params;
@@ -80,6 +84,7 @@ class Slices;
 class Slice;
 class Atom;
 class List;
+class Dict;
 class Tuple;
 class Arguments;
 class Args;
@@ -90,6 +95,7 @@ class _String;
 class Name;
 class Number;
 class Bool;
+class _None;
 
 class AST {
     public:
@@ -97,6 +103,9 @@ class AST {
         Tokenizer *tokenizer;
         vector<AST *> children;
         int rewind_amt = 0;
+        // every node ever built, including the ones a failed alternative
+        // throws away, for bench/frontend-bench.cpp
+        static size_t created;
         
         AST();
         AST(Tokenizer *tokenizer, string indent);
@@ -107,9 +116,12 @@ class AST {
         Token next_token();
         void eat_value(string exp_value, string func_name);
         void eat_type(string exp_type, string func_name);
-        virtual PyObject evaluate(Stack stack);
+        virtual PyObject evaluate(Stack& stack);
         friend ostream& operator<<(ostream& os, const AST& ast);
         virtual ostream& print(ostream& os) const;
+        // children plus the nodes a few classes keep in their own
+        // fields, every node this one owns. for the AST dumps
+        virtual vector<AST*> all_children() const;
 };
 class File: public AST {
     private:
@@ -118,7 +130,7 @@ class File: public AST {
         File(Tokenizer *tokenizer, string indent);
         virtual ~File();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Interactive: public AST {
@@ -128,7 +140,7 @@ class Interactive: public AST {
         Interactive(Tokenizer *tokenizer, string indent);
         virtual ~Interactive();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Statements: public AST {
@@ -138,17 +150,18 @@ class Statements: public AST {
         Statements(Tokenizer *tokenizer, string indent);
         virtual ~Statements();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Statement: public AST {
     private:
+        int line;  // source line it starts on, for the profiler
         void parse();
     public:
         Statement(Tokenizer *tokenizer, string indent);
         virtual ~Statement();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class StatementNewline: public AST {
@@ -158,7 +171,7 @@ class StatementNewline: public AST {
         StatementNewline(Tokenizer *tokenizer, string indent);
         virtual ~StatementNewline();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class SimpleStmt: public AST {
@@ -168,17 +181,18 @@ class SimpleStmt: public AST {
         SimpleStmt(Tokenizer *tokenizer, string indent);
         virtual ~SimpleStmt();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class SmallStmt: public AST {
     private:
+        string keyword;  // 'pass', 'break' or 'continue'
         void parse();
     public:
         SmallStmt(Tokenizer *tokenizer, string indent);
         virtual ~SmallStmt();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class CompoundStmt: public AST {
@@ -188,19 +202,55 @@ class CompoundStmt: public AST {
         CompoundStmt(Tokenizer *tokenizer, string indent);
         virtual ~CompoundStmt();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Assignment: public AST {
     private:
+        vector<StarTargets*> targets;
+        Op* augassign;  // nullptr for '='
+
         void parse();
     public:
         Assignment(Tokenizer *tokenizer, string indent);
         virtual ~Assignment();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
+        virtual ostream& print(ostream& os) const override;
+        virtual vector<AST*> all_children() const override;
+};
+class StarTargets: public AST {
+    private:
+        bool unpack;  // more than one target or a trailing ','
+
+        void parse();
+    public:
+        StarTargets(Tokenizer *tokenizer, string indent, bool unpack=false);
+        virtual ~StarTargets();
+
+        bool is_single() const;
+        void assign(Stack& stack, PyObject value);
+        void augassign(Stack& stack, string op, PyObject value);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
+class StarTarget: public AST {
+    private:
+        StarTargets* targets;  // '(' star_targets ')' and '[' star_targets ']'
+        Primary* primary;      // NAME or t_primary '[' slices ']'
+
+        void parse();
+    public:
+        StarTarget(Tokenizer *tokenizer, string indent);
+        virtual ~StarTarget();
+
+        bool is_single() const;
+        void assign(Stack& stack, PyObject value);
+        void augassign(Stack& stack, string op, PyObject value);
+        PyObject evaluate(Stack& stack);
+        virtual ostream& print(ostream& os) const override;
+        virtual vector<AST*> all_children() const override;
+};
 class IfStmt: public AST {
     private:
         void parse();
@@ -208,7 +258,7 @@ class IfStmt: public AST {
         IfStmt(Tokenizer *tokenizer, string indent);
         virtual ~IfStmt();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class ElifStmt: public AST {
@@ -221,7 +271,7 @@ class ElifStmt: public AST {
         ElifStmt(Tokenizer *tokenizer, string indent);
         virtual ~ElifStmt();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class ElseBlock: public AST {
@@ -231,7 +281,7 @@ class ElseBlock: public AST {
         ElseBlock(Tokenizer *tokenizer, string indent);
         virtual ~ElseBlock();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class WhileStmt: public AST {
@@ -241,18 +291,20 @@ class WhileStmt: public AST {
         WhileStmt(Tokenizer *tokenizer, string indent);
         virtual ~WhileStmt();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class ForStmt: public AST {
     private:
+        vector<Name*> targets;
         void parse();
     public:
         ForStmt(Tokenizer *tokenizer, string indent);
         virtual ~ForStmt();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
+        virtual vector<AST*> all_children() const override;
 };
 class WithStmt: public AST {
     private:
@@ -261,7 +313,7 @@ class WithStmt: public AST {
         WithStmt(Tokenizer *tokenizer, string indent);
         virtual ~WithStmt();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class WithItem: public AST {
@@ -271,27 +323,41 @@ class WithItem: public AST {
         WithItem(Tokenizer *tokenizer, string indent);
         virtual ~WithItem();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class TryStmt: public AST {
     private:
+        // all owned by children, in source order
+        AST* body;
+        vector<ExceptBlock*> handlers;
+        ElseBlock* else_block;
+        FinallyBlock* finally_block;
+
         void parse();
+        void run_handlers(Stack& stack);
+        bool run_finally(Stack& stack);
     public:
         TryStmt(Tokenizer *tokenizer, string indent);
         virtual ~TryStmt();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class ExceptBlock: public AST {
     private:
+        AST* exception_type;  // nullptr for a bare 'except:'
+        string name;          // 'as' target, empty when there is none
+        Symbol symbol;        // the interned name, nullptr when there is none
+
         void parse();
     public:
         ExceptBlock(Tokenizer *tokenizer, string indent);
         virtual ~ExceptBlock();
 
-        PyObject evaluate(Stack stack);
+        bool matches(Stack& stack, const string& cls_name);
+        void handle(Stack& stack, const PyObject& exception);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class FinallyBlock: public AST {
@@ -301,19 +367,30 @@ class FinallyBlock: public AST {
         FinallyBlock(Tokenizer *tokenizer, string indent);
         virtual ~FinallyBlock();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class ReturnStmt: public AST {
     private:
         PyObject return_value;
+        Primary* tail_call;  // set when the value is just a call
 
         void parse();
     public:
         ReturnStmt(Tokenizer *tokenizer, string indent);
         virtual ~ReturnStmt();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
+        virtual ostream& print(ostream& os) const override;
+};
+class RaiseStmt: public AST {
+    private:
+        void parse();
+    public:
+        RaiseStmt(Tokenizer *tokenizer, string indent);
+        virtual ~RaiseStmt();
+
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class FunctionDef: public AST {
@@ -325,22 +402,26 @@ class FunctionDef: public AST {
         FunctionDef(Tokenizer *tokenizer, string indent);
         virtual ~FunctionDef();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
+        virtual vector<AST*> all_children() const override;
 };
 class FunctionDefRaw: public AST {
     private:
         void parse();
     public:
         string name;
+        Symbol symbol;
+        int line;  // of the 'def', for call events
         Params* params;
         Block* body;
 
         FunctionDefRaw(Tokenizer *tokenizer, string indent);
         virtual ~FunctionDefRaw();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
+        virtual vector<AST*> all_children() const override;
 };
 class Params: public AST {
     private:
@@ -349,7 +430,7 @@ class Params: public AST {
         Params(Tokenizer *tokenizer, string indent);
         virtual ~Params();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Parameters: public AST {
@@ -359,7 +440,7 @@ class Parameters: public AST {
         Parameters(Tokenizer *tokenizer, string indent);
         virtual ~Parameters();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class SlashNoDefault: public AST {
@@ -369,7 +450,7 @@ class SlashNoDefault: public AST {
         SlashNoDefault(Tokenizer *tokenizer, string indent);
         virtual ~SlashNoDefault();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class SlashWithDefault: public AST {
@@ -379,7 +460,7 @@ class SlashWithDefault: public AST {
         SlashWithDefault(Tokenizer *tokenizer, string indent);
         virtual ~SlashWithDefault();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class StarEtc: public AST {
@@ -389,7 +470,7 @@ class StarEtc: public AST {
         StarEtc(Tokenizer *tokenizer, string indent);
         virtual ~StarEtc();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Kwds: public AST {
@@ -399,7 +480,7 @@ class Kwds: public AST {
         Kwds(Tokenizer *tokenizer, string indent);
         virtual ~Kwds();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class ParamNoDefault: public AST {
@@ -409,7 +490,7 @@ class ParamNoDefault: public AST {
         ParamNoDefault(Tokenizer *tokenizer, string indent);
         virtual ~ParamNoDefault();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class ParamWithDefault: public AST {
@@ -419,7 +500,7 @@ class ParamWithDefault: public AST {
         ParamWithDefault(Tokenizer *tokenizer, string indent);
         virtual ~ParamWithDefault();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class ParamMaybeDefault: public AST {
@@ -429,7 +510,7 @@ class ParamMaybeDefault: public AST {
         ParamMaybeDefault(Tokenizer *tokenizer, string indent);
         virtual ~ParamMaybeDefault();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Param: public AST {
@@ -440,8 +521,10 @@ class Param: public AST {
         Param(Tokenizer *tokenizer, string indent);
         virtual ~Param();
 
-        PyObject evaluate(Stack stack);
+        Symbol get_symbol() const;
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
+        virtual vector<AST*> all_children() const override;
 };
 class Default: public AST {
     private:
@@ -450,7 +533,7 @@ class Default: public AST {
         Default(Tokenizer *tokenizer, string indent);
         virtual ~Default();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Block: public AST {
@@ -461,17 +544,18 @@ class Block: public AST {
         Block(Tokenizer *tokenizer, string indent);
         virtual ~Block();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class StarExpressions: public AST {
     private:
+        bool is_tuple;  // had a ','
         void parse();
     public:
         StarExpressions(Tokenizer *tokenizer, string indent);
         virtual ~StarExpressions();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class StarExpression: public AST {
@@ -481,7 +565,7 @@ class StarExpression: public AST {
         StarExpression(Tokenizer *tokenizer, string indent);
         virtual ~StarExpression();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class StarNamedExpressions: public AST {
@@ -491,7 +575,8 @@ class StarNamedExpressions: public AST {
         StarNamedExpressions(Tokenizer *tokenizer, string indent);
         virtual ~StarNamedExpressions();
 
-        PyObject evaluate(Stack stack);
+        vector<PyObject> evaluate_items(Stack& stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class StarNamedExpression: public AST {
@@ -501,7 +586,7 @@ class StarNamedExpression: public AST {
         StarNamedExpression(Tokenizer *tokenizer, string indent);
         virtual ~StarNamedExpression();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class NamedExpression: public AST {
@@ -511,17 +596,18 @@ class NamedExpression: public AST {
         NamedExpression(Tokenizer *tokenizer, string indent);
         virtual ~NamedExpression();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Expressions: public AST {
     private:
+        bool is_tuple;  // had a ','
         void parse();
     public:
         Expressions(Tokenizer *tokenizer, string indent);
         virtual ~Expressions();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Expression: public AST {
@@ -531,7 +617,7 @@ class Expression: public AST {
         Expression(Tokenizer *tokenizer, string indent);
         virtual ~Expression();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Disjunction: public AST {
@@ -541,7 +627,7 @@ class Disjunction: public AST {
         Disjunction(Tokenizer *tokenizer, string indent);
         virtual ~Disjunction();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Conjunction: public AST {
@@ -551,7 +637,7 @@ class Conjunction: public AST {
         Conjunction(Tokenizer *tokenizer, string indent);
         virtual ~Conjunction();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Inversion: public AST {
@@ -561,7 +647,7 @@ class Inversion: public AST {
         Inversion(Tokenizer *tokenizer, string indent);
         virtual ~Inversion();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Comparison: public AST {
@@ -571,7 +657,7 @@ class Comparison: public AST {
         Comparison(Tokenizer *tokenizer, string indent);
         virtual ~Comparison();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class BitwiseOr: public AST {
@@ -581,7 +667,7 @@ class BitwiseOr: public AST {
         BitwiseOr(Tokenizer *tokenizer, string indent);
         virtual ~BitwiseOr();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class BitwiseXor: public AST {
@@ -591,7 +677,7 @@ class BitwiseXor: public AST {
         BitwiseXor(Tokenizer *tokenizer, string indent);
         virtual ~BitwiseXor();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class BitwiseAnd: public AST {
@@ -601,7 +687,7 @@ class BitwiseAnd: public AST {
         BitwiseAnd(Tokenizer *tokenizer, string indent);
         virtual ~BitwiseAnd();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class ShiftExpr: public AST {
@@ -611,7 +697,7 @@ class ShiftExpr: public AST {
         ShiftExpr(Tokenizer *tokenizer, string indent);
         virtual ~ShiftExpr();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Sum: public AST {
@@ -621,7 +707,7 @@ class Sum: public AST {
         Sum(Tokenizer *tokenizer, string indent);
         virtual ~Sum();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Term: public AST {
@@ -631,7 +717,7 @@ class Term: public AST {
         Term(Tokenizer *tokenizer, string indent);
         virtual ~Term();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Factor: public AST {
@@ -641,7 +727,7 @@ class Factor: public AST {
         Factor(Tokenizer *tokenizer, string indent);
         virtual ~Factor();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Power: public AST {
@@ -651,7 +737,7 @@ class Power: public AST {
         Power(Tokenizer *tokenizer, string indent);
         virtual ~Power();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class AwaitPrimary: public AST {
@@ -661,27 +747,38 @@ class AwaitPrimary: public AST {
         AwaitPrimary(Tokenizer *tokenizer, string indent);
         virtual ~AwaitPrimary();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Primary: public AST {
     private:
         void parse();
+        PyObject evaluate_trailer(Stack& stack, PyObject value, int i);
+        PyObject& reference(Stack& stack, int end);
     public:
         Primary(Tokenizer *tokenizer, string indent);
         virtual ~Primary();
         
-        PyObject evaluate(Stack stack);
+        bool is_call() const;
+        bool is_name() const;
+        bool is_constant() const;
+        bool is_subscript() const;
+        Symbol get_symbol() const;
+        PyObject evaluate_call(Stack& stack, bool tail);
+        void assign_item(Stack& stack, PyObject value);
+        void augassign(Stack& stack, string op, PyObject value);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Slices: public AST {
     private:
+        bool is_tuple;  // had a ','
         void parse();
     public:
         Slices(Tokenizer *tokenizer, string indent);
         virtual ~Slices();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Slice: public AST {
@@ -691,7 +788,7 @@ class Slice: public AST {
         Slice(Tokenizer *tokenizer, string indent);
         virtual ~Slice();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Atom: public AST {
@@ -701,7 +798,7 @@ class Atom: public AST {
         Atom(Tokenizer *tokenizer, string indent);
         virtual ~Atom();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class List: public AST {
@@ -711,17 +808,29 @@ class List: public AST {
         List(Tokenizer *tokenizer, string indent);
         virtual ~List();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
+        virtual ostream& print(ostream& os) const override;
+};
+class Dict: public AST {
+    private:
+        bool is_set;  // '{' a, b '}', children are the items
+        void parse();
+    public:
+        Dict(Tokenizer *tokenizer, string indent);
+        virtual ~Dict();
+        
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Tuple: public AST {
     private:
+        bool is_group;  // '(' expression ')', no comma
         void parse();
     public:
         Tuple(Tokenizer *tokenizer, string indent);
         virtual ~Tuple();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Arguments: public AST {
@@ -731,27 +840,36 @@ class Arguments: public AST {
         Arguments(Tokenizer *tokenizer, string indent);
         virtual ~Arguments();
         
-        PyObject evaluate(Stack stack);
+        PyObject call_builtin(Stack& stack, const Builtin* builtin);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Args: public AST {
     private:
+        // positional arguments that fit here are evaluated on the C++
+        // stack when calling a builtin, no tuple is built
+        static constexpr int INLINE_ARGS = 4;
+
         void parse();
     public:
         Args(Tokenizer *tokenizer, string indent);
         virtual ~Args();
         
-        PyObject evaluate(Stack stack);
+        PyObject call_builtin(Stack& stack, const Builtin* builtin);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Kwargs: public AST {
     private:
+        vector<string> names;  // one per child expression
+
         void parse();
     public:
         Kwargs(Tokenizer *tokenizer, string indent);
         virtual ~Kwargs();
         
-        PyObject evaluate(Stack stack);
+        PyDict evaluate_keywords(Stack& stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class StarredExpression: public AST {
@@ -761,7 +879,7 @@ class StarredExpression: public AST {
         StarredExpression(Tokenizer *tokenizer, string indent);
         virtual ~StarredExpression();
         
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Op: public AST {
@@ -775,7 +893,7 @@ class Op: public AST {
         Op(Tokenizer *tokenizer, string indent);
         virtual ~Op();
           
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class _String: public AST {
@@ -789,7 +907,7 @@ class _String: public AST {
         _String(Tokenizer *tokenizer, string indent);
         virtual ~_String();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Name: public AST {
@@ -799,11 +917,12 @@ class Name: public AST {
         void parse();
     public:
         Token token;
+        Symbol symbol;  // interned once here, lookups compare the pointer
         
         Name(Tokenizer *tokenizer, string indent);
         virtual ~Name();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Number: public AST {
@@ -817,7 +936,7 @@ class Number: public AST {
         Number(Tokenizer *tokenizer, string indent);
         virtual ~Number();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 class Bool: public AST {
@@ -831,7 +950,18 @@ class Bool: public AST {
         Bool(Tokenizer *tokenizer, string indent);
         virtual ~Bool();
 
-        PyObject evaluate(Stack stack);
+        PyObject evaluate(Stack& stack);
+        virtual ostream& print(ostream& os) const override;
+};
+// a literal like True and False, not a name that can be rebound
+class _None: public AST {
+    private:
+        void parse();
+    public:
+        _None(Tokenizer *tokenizer, string indent);
+        virtual ~_None();
+
+        PyObject evaluate(Stack& stack);
         virtual ostream& print(ostream& os) const override;
 };
 
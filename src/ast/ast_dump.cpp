@@ -0,0 +1,69 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <typeinfo>
+#include <cxxabi.h>
+#include <cstdlib>
+#include "ast_dump.h"
+using namespace std;
+
+
+void dump_tokens(Tokenizer& tokenizer, ostream& os) {
+    tokenizer.print(os);
+    os.flush();
+}
+
+void dump_ast_text(const AST& tree, ostream& os) {
+    os << tree << endl;
+}
+
+static string node_type(const AST& node) {
+    int status;
+    char* name = abi::__cxa_demangle(typeid(node).name(), nullptr, nullptr, &status);
+    string type = status == 0 ? name : typeid(node).name();
+    free(name);
+    return type;
+}
+
+static void write_json_string(ostream& os, const string& s) {
+    os << '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') os << '\\' << c;
+        else if (c == '\n') os << "\\n";
+        else if (c == '\r') os << "\\r";
+        else if (c == '\t') os << "\\t";
+        else if (c < 0x20) {
+            const char* hex = "0123456789abcdef";
+            os << "\\u00" << hex[c >> 4] << hex[c & 15];
+        }
+        else os << c;
+    }
+    os << '"';
+}
+
+static void write_json_node(const AST& node, ostream& os, int depth) {
+    string pad(2 * depth, ' ');
+    os << pad << "{\"type\": ";
+    write_json_string(os, node_type(node));
+    vector<AST*> children = node.all_children();
+    if (children.size() == 0) {
+        stringstream source;
+        source << node;
+        os << ", \"source\": ";
+        write_json_string(os, source.str());
+        os << "}";
+        return;
+    }
+    os << ", \"children\": [" << '\n';
+    for (size_t i=0; i < children.size(); i++) {
+        write_json_node(*children.at(i), os, depth + 1);
+        os << (i + 1 < children.size() ? ",\n" : "\n");
+    }
+    os << pad << "]}";
+}
+
+void dump_ast_json(const AST& tree, ostream& os) {
+    write_json_node(tree, os, 0);
+    os << endl;
+}
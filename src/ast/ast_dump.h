@@ -0,0 +1,20 @@
+#ifndef AST_DUMP_H
+#define AST_DUMP_H
+
+#include <iostream>
+#include "ast.h"
+#include "tokenizer.h"
+using namespace std;
+
+// the --dump-tokens and --dump-ast outputs. Each one writes as it walks,
+// the dump is never built up in memory first
+
+// one token per line, before strip() so comments and NL are there too
+void dump_tokens(Tokenizer& tokenizer, ostream& os);
+// the tree printed back as source, what operator<< gives
+void dump_ast_text(const AST& tree, ostream& os);
+// a node per object: {"type": "Assignment", "children": [...]}, leaves
+// have their source instead of children: {"type": "Name", "source": "x"}
+void dump_ast_json(const AST& tree, ostream& os);
+
+#endif
@@ -34,15 +34,21 @@ PyObject apply_comparison_op(PyObject left, string op, PyObject right) {
     if (op == ">") {
         return left > right;
     }
+    if (op == "in") {
+        return PyObject(right.contains(left), "bool");
+    }
+    if (op == "not in") {
+        return PyObject(!right.contains(left), "bool");
+    }
     throw runtime_error("apply_comparison_op: \'" + op + "\' not implemented");
 }
 
 PyObject apply_shift_op(PyObject left, string op, PyObject right) {
     if (op == "<<") {
-        return PyObject((int)left << (int)right, "int");
+        return left << right;
     }
     if (op == ">>") {
-        return PyObject((int)left >> (int)right, "int");
+        return left >> right;
     }
     throw runtime_error("apply_shift_op: \'" + op + "\' not implemented");
 }
@@ -69,10 +75,9 @@ PyObject apply_term_op(PyObject left, string op, PyObject right) {
     if (op == "/") {
         return left / right;
     }
-    // TODO: figure out structure and implement
-    // if (op == "//") {
-    //     return left.int_div(right);
-    // }
+    if (op == "//") {
+        return left.floordiv(right);
+    }
     if (op == "%") {
         return left % right;
     }
@@ -84,6 +89,39 @@ PyObject apply_term_op(PyObject left, string op, PyObject right) {
     throw runtime_error("apply_term_op: \'" + op + "\' not implemented");
 }
 
+// for augmented assignment, op is the binary op without the '='
+PyObject apply_binary_op(PyObject left, string op, PyObject right) {
+    if (is_sum_op(op)) {
+        return apply_sum_op(left, op, right);
+    }
+    if (is_term_op(op)) {
+        return apply_term_op(left, op, right);
+    }
+    if (op == "<<" || op == ">>") {
+        return apply_shift_op(left, op, right);
+    }
+    if (op == "**") {
+        return left._pow(right);
+    }
+    if (op == "&") {
+        return left & right;
+    }
+    if (op == "|") {
+        return left | right;
+    }
+    if (op == "^") {
+        return left ^ right;
+    }
+    throw runtime_error("apply_binary_op: \'" + op + "\' not implemented");
+}
+
+// x += 1 updates the stored object when the type allows it
+void apply_augassign(PyObject& target, const string& op, const PyObject& value) {
+    if (!target.inplace_op(op, value)) {
+        target = apply_binary_op(target, op.substr(0, op.size()-1), value);
+    }
+}
+
 bool is_comparison_op(Tokenizer *tokenizer) {
     // NOTE: to abbrv a long grammar I'm looking for
     // '==', '!=', '<=', '<', '>=', '>', 'not in', 'in', 'is not', 'is'
@@ -114,3 +152,33 @@ bool is_term_op(string v1) {
 bool is_factor_op(string v1) {
     return v1 == "+" || v1 == "-" || v1 == "~";
 }
+
+bool is_augassign_op(string v1) {
+    string v1_opts[] = {"+=", "-=", "*=", "@=", "/=", "%=", "&=", "|=", 
+                        "^=", "<<=", ">>=", "**=", "//="};
+    return in(v1_opts, v1, 13);
+}
+
+// scans the rest of the statement for an '=' or augassign outside of
+// any brackets, returns it or "" if the statement is not an assignment
+string find_assignment_op(Tokenizer *tokenizer) {
+    int depth = 0;
+    for (int i=0; ; i++) {
+        Token t = tokenizer->lookahead(i);
+        if (t.type == "NEWLINE" || t.type == "ENDMARKER" || t.type == "unknown") {
+            return "";
+        }
+        if (t.value == "(" || t.value == "[" || t.value == "{") {
+            depth++;
+        }
+        else if (t.value == ")" || t.value == "]" || t.value == "}") {
+            depth--;
+        }
+        else if (depth == 0 && (t.value == "=" || is_augassign_op(t.value))) {
+            return t.value;
+        }
+        else if (depth == 0 && t.value == ";") {
+            return "";
+        }
+    }
+}
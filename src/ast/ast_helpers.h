@@ -10,20 +10,21 @@ using namespace std;
 bool in(string arr[], string val, size_t N);
 
 // functions for accumulate
-auto _boolean_or = [](bool b1, bool b2){ return b1 || b2; };
-auto _boolean_and = [](bool b1, bool b2){ return b1 && b2; };
-auto _bitwise_or = [](int b1, int b2){ return b1 | b2; };
-auto _bitwise_xor = [](int b1, int b2){ return b1 ^ b2; };
-auto _bitwise_and = [](int b1, int b2){ return b1 & b2; };
+static auto _boolean_or = [](bool b1, bool b2){ return b1 || b2; };
+static auto _boolean_and = [](bool b1, bool b2){ return b1 && b2; };
 
 PyObject apply_comparison_op(PyObject left, string op, PyObject right);
 PyObject apply_shift_op(PyObject left, string op, PyObject right);
 PyObject apply_sum_op(PyObject left, string op, PyObject right);
 PyObject apply_term_op(PyObject left, string op, PyObject right);
+PyObject apply_binary_op(PyObject left, string op, PyObject right);
+void apply_augassign(PyObject& target, const string& op, const PyObject& value);
 
 bool is_comparison_op(Tokenizer *tokenizer);
 bool is_sum_op(string v1);
 bool is_term_op(string v1);
 bool is_factor_op(string v1);
+bool is_augassign_op(string v1);
+string find_assignment_op(Tokenizer *tokenizer);
 
 #endif
\ No newline at end of file
@@ -1,9 +1,11 @@
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <streambuf>
 #include <vector>
 #include <string>
 #include <tuple>
+#include <functional>
 #include <curses.h>
 #include "logging.h"
 #include "ast.h"
@@ -11,6 +13,13 @@
 #include "tokenizer.h"
 #include "stack.h"
 #include "util.h"
+#include "output.h"
+#include "ast_dump.h"
+#include "profiler.h"
+#include "coverage.h"
+#include "memstats.h"
+#include "perfcounters.h"
+#include "instrument.h"
 using namespace std;
 
 
@@ -242,38 +251,144 @@ void interacive_terminal() {
 	cout.rdbuf(old_cout);  // restore old cout
 }
 
-void cleanup() {
+// instrumentation builds only, the table goes to stderr unless a json
+// file was asked for
+void write_counters(string json_path) {
+	if (json_path == "") {
+		Instrumentation::get_instance()->write_table(cerr);
+		return;
+	}
+	ofstream json(json_path);
+	Instrumentation::get_instance()->write_json(json);
+}
+
+void cleanup(string counters_json) {
+	Output::get_instance()->flush();
+#ifdef INSTRUMENT
+	write_counters(counters_json);
+#endif
 	Logger::get_instance()->close();
 }
 
-int main(int argc, char* argv[]) {
-	if (argc > 1) {
+// the report goes to stderr after the program's own output, the folded
+// stacks to a file for flamegraph.pl or speedscope
+void write_profile(string folded_path) {
+	Profiler* profiler = Profiler::get_instance();
+	profiler->write_report(cerr);
+	ofstream folded(folded_path);
+	profiler->write_folded(folded);
+	cerr << endl << "folded stacks written to " << folded_path << endl;
+}
+
+// the command line, see main()
+struct RunOptions {
+	string fname = "";
+	bool verbose = false;
+	string profile_path = "";
+	bool mem_stats = false;
+	bool perf_counters = false;
+	string coverage_path = "";
+	bool coverage_counts = false;
+	string counters_json = "";
+	// "" for none, "-" for stderr, otherwise a file
+	string dump_tokens = "";
+	string dump_ast = "";
+	// text or json
+	string dump_ast_format = "text";
+};
+
+// a dump goes to stderr for "-", otherwise to the file it names
+void write_dump(const string& path, function<void(ostream&)> write) {
+	if (path == "-") {
+		write(cerr);
+		return;
+	}
+	ofstream file(path);
+	if (!file) {
+		cerr << "could not open '" << path << "' for writing" << endl;
+		return;
+	}
+	write(file);
+}
+
+void run(const RunOptions& options) {
+	string fname = options.fname;
+	if (fname != "") {
+		if (options.coverage_path != "") {
+			Coverage::get_instance()->start(fname, options.coverage_counts);
+		}
+		if (options.mem_stats) {
+			MemStats::start();
+		}
+		// opened on this thread, the counters only count the one that
+		// opened them
+		if (options.perf_counters && !PerfCounters::get_instance()->open()) {
+			cerr << "--perf-counters: perf_event_open is not available" << endl;
+		}
+		PerfRegion whole_run("run");
 		// interpreting input file
-		vector<string> contents = read_lines(argv[1]);
+		vector<string> contents = read_lines(fname);
 
+		PerfRegion tokenize("tokenize");
 		Tokenizer tokenizer(contents);
-		if (argc > 2 && argv[2] == (string)"-v") {
+		if (options.verbose) {
 			Logger::get_instance()->set_mode(DEBUG);
+			tokenizer.log();
+		}
+		if (options.dump_tokens != "") {
+			write_dump(options.dump_tokens, [&](ostream& os) { dump_tokens(tokenizer, os); });
 		}
-		tokenizer.log();
 		tokenizer.strip();
+		tokenize.stop();
 
 		try {
+			PerfRegion parse("parse");
 			Parser parser(&tokenizer);
 			File* parse_tree = dynamic_cast<File*>(parser.parse("file"));
-			
-			cout << endl << "AST:" << endl << *parse_tree << endl;
+			parse.stop();
+
+			if (options.dump_ast != "") {
+				write_dump(options.dump_ast, [&](ostream& os) {
+					if (options.dump_ast_format == "json") dump_ast_json(*parse_tree, os);
+					else dump_ast_text(*parse_tree, os);
+				});
+			}
 
 			Stack stack;
-			cout << endl << "stdout:" << endl;
+			if (options.profile_path != "") {
+				Profiler::get_instance()->start(fname);
+			}
+			PerfRegion evaluate("evaluate");
 			(*parse_tree).evaluate(stack);
+			evaluate.stop();
 
-			if (argc > 2 && argv[2] == (string)"-v") cout << endl << "deleting:" << endl;
+			if (options.verbose) cout << endl << "deleting:" << endl;
 			delete parse_tree;
 		}
 		catch (exception& e) {
 			cout << "exception: " << e.what() << endl;
 		}
+		if (Profiler::get_instance()->is_running()) {
+			Profiler::get_instance()->stop();
+			Output::get_instance()->flush();
+			write_profile(options.profile_path);
+		}
+		whole_run.stop();
+		if (Coverage::get_instance()->is_running()) {
+			Coverage::get_instance()->stop();
+			ofstream lcov(options.coverage_path);
+			Coverage::get_instance()->write_lcov(lcov);
+		}
+		if (PerfCounters::get_instance()->is_open()) {
+			Output::get_instance()->flush();
+			PerfCounters::get_instance()->write_report(cerr, "run");
+			PerfCounters::get_instance()->close();
+		}
+		if (MemStats::is_tracing()) {
+			Output::get_instance()->flush();
+			MemStats::write_report(cerr);
+			MemStats::stop();
+		}
 	} else {
 		// interactive terminal
 		init_ncurses();
@@ -288,6 +403,77 @@ int main(int argc, char* argv[]) {
 		}
 		endwin();
 	}
-	cleanup();
+}
+
+int main(int argc, char* argv[]) {
+	// ./mypy [filename] [-v] [--recursion-limit=N] [--profile[=FOLDED_FILE]]
+	//        [--counters-json=FILE] [--mem-stats] [--perf-counters]
+	//        [--coverage[=LCOV_FILE]] [--coverage-counts]
+	//        [--dump-tokens[=FILE]] [--dump-ast=text|json[:FILE]]
+	// dumps go to stderr unless a file is given
+	RunOptions options;
+	for (int i=1; i < argc; i++) {
+		string arg = argv[i];
+		string value = arg.substr(arg.find('=')+1);
+		if (arg == "-v") {
+			options.verbose = true;
+		}
+		else if (arg == "--profile") {
+			options.profile_path = "profile.folded";
+		}
+		else if (arg.find("--profile=") == 0) {
+			options.profile_path = value;
+		}
+		else if (arg == "--mem-stats") {
+			options.mem_stats = true;
+		}
+		else if (arg == "--perf-counters") {
+			options.perf_counters = true;
+		}
+		else if (arg == "--coverage") {
+			options.coverage_path = "coverage.info";
+		}
+		else if (arg.find("--coverage=") == 0) {
+			options.coverage_path = value;
+		}
+		else if (arg == "--coverage-counts") {
+			// counts imply coverage
+			options.coverage_counts = true;
+			if (options.coverage_path == "") options.coverage_path = "coverage.info";
+		}
+		else if (arg == "--dump-tokens") {
+			options.dump_tokens = "-";
+		}
+		else if (arg.find("--dump-tokens=") == 0) {
+			options.dump_tokens = value;
+		}
+		else if (arg == "--dump-ast") {
+			options.dump_ast = "-";
+		}
+		else if (arg.find("--dump-ast=") == 0) {
+			size_t colon = value.find(':');
+			options.dump_ast_format = value.substr(0, colon);
+			options.dump_ast = colon == string::npos ? "-" : value.substr(colon+1);
+			if (options.dump_ast_format != "text" && options.dump_ast_format != "json") {
+				cerr << "--dump-ast: unknown format '" << options.dump_ast_format
+				     << "', expected text or json" << endl;
+				return 2;
+			}
+		}
+		else if (arg.find("--counters-json=") == 0) {
+			options.counters_json = value;
+		}
+		else if (arg.find("--recursion-limit=") == 0) {
+			Stack::set_recursion_limit(stoi(value));
+		}
+		else {
+			options.fname = arg;
+		}
+	}
+
+	// python calls recurse on the native stack, run on heap segments
+	// that are added as the recursion goes deeper
+	run_with_call_stack([&]() { run(options); });
+	cleanup(options.counters_json);
 	return 0;
 }
@@ -0,0 +1,459 @@
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "bigint.h"
+using namespace std;
+
+
+BigInt::BigInt() {
+    this->negative = false;
+}
+
+BigInt::BigInt(int64_t value) {
+    this->negative = value < 0;
+    uint64_t m = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    while (m != 0) {
+        this->mag.push_back((uint32_t)m);
+        m >>= 32;
+    }
+}
+
+BigInt::BigInt(bool negative, Limbs mag) {
+    this->mag = move(mag);
+    trim(this->mag);
+    this->negative = negative && !this->mag.empty();
+}
+
+BigInt BigInt::from_string(const string& s) {
+    static const uint32_t pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000,
+                                     10000000, 100000000, 1000000000};
+    size_t i = 0;
+    bool negative = false;
+    if (s[i] == '+' || s[i] == '-') {
+        negative = s[i] == '-';
+        i++;
+    }
+    // 9 digits at a time, each chunk is one multiply-add over the limbs
+    Limbs mag;
+    size_t len = (s.size() - i) % 9 == 0 ? 9 : (s.size() - i) % 9;
+    while (i < s.size()) {
+        uint32_t chunk = 0;
+        for (size_t j=i; j < i + len; j++) {
+            chunk = chunk * 10 + (s[j] - '0');
+        }
+        mul_small_add(mag, pow10[len], chunk);
+        i += len;
+        len = 9;
+    }
+    return BigInt(negative, move(mag));
+}
+
+BigInt BigInt::from_double(double d) {
+    d = trunc(d);
+    if (fabs(d) < 9.2e18) {
+        return BigInt((int64_t)d);
+    }
+    // |d| = m * 2^exp with m in [0.5, 1), all 53 bits of m fit an int64
+    int exp;
+    double m = frexp(fabs(d), &exp);
+    BigInt r = BigInt((int64_t)ldexp(m, 53)) << (exp - 53);
+    return d < 0 ? -r : r;
+}
+
+bool BigInt::is_zero() const {
+    return this->mag.empty();
+}
+
+bool BigInt::is_negative() const {
+    return this->negative;
+}
+
+bool BigInt::fits_int64() const {
+    if (this->mag.size() < 2) return true;
+    if (this->mag.size() > 2) return false;
+    uint64_t m = ((uint64_t)this->mag[1] << 32) | this->mag[0];
+    return this->negative ? m <= (1ULL << 63) : m < (1ULL << 63);
+}
+
+int64_t BigInt::to_int64() const {
+    uint64_t m = 0;
+    for (size_t i=0; i < this->mag.size() && i < 2; i++) {
+        m |= (uint64_t)this->mag[i] << (32 * i);
+    }
+    return this->negative ? (int64_t)(0 - m) : (int64_t)m;
+}
+
+double BigInt::to_double() const {
+    double d = 0;
+    for (size_t i=this->mag.size(); i-- > 0;) {
+        d = d * 4294967296.0 + this->mag[i];
+    }
+    return this->negative ? -d : d;
+}
+
+// peels off 9 decimal digits per pass over the limbs instead of one
+string BigInt::to_string() const {
+    if (this->is_zero()) {
+        return "0";
+    }
+    Limbs a = this->mag;
+    vector<uint32_t> chunks;
+    while (!a.empty()) {
+        chunks.push_back(divmod_small(a, 1000000000));
+    }
+    string s = this->negative ? "-" : "";
+    s += std::to_string(chunks.back());
+    for (size_t i=chunks.size()-1; i-- > 0;) {
+        string chunk = std::to_string(chunks[i]);
+        s.append(9 - chunk.size(), '0');
+        s += chunk;
+    }
+    return s;
+}
+
+size_t BigInt::hash() const {
+    size_t h = 0;
+    for (uint32_t limb : this->mag) {
+        h = (h * 1000003) ^ limb;
+    }
+    return this->negative ? ~h : h;
+}
+
+int BigInt::compare(const BigInt& b) const {
+    if (this->negative != b.negative) {
+        return this->negative ? -1 : 1;
+    }
+    int c = cmp_mag(this->mag, b.mag);
+    return this->negative ? -c : c;
+}
+
+BigInt BigInt::operator-() const {
+    return BigInt(!this->negative, this->mag);
+}
+
+BigInt BigInt::operator+(const BigInt& b) const {
+    if (this->negative == b.negative) {
+        return BigInt(this->negative, add_mag(this->mag, b.mag));
+    }
+    if (cmp_mag(this->mag, b.mag) >= 0) {
+        return BigInt(this->negative, sub_mag(this->mag, b.mag));
+    }
+    return BigInt(b.negative, sub_mag(b.mag, this->mag));
+}
+
+BigInt BigInt::operator-(const BigInt& b) const {
+    return *this + (-b);
+}
+
+BigInt BigInt::operator*(const BigInt& b) const {
+    return BigInt(this->negative != b.negative, mul_mag(this->mag, b.mag));
+}
+
+BigInt BigInt::operator<<(uint64_t n) const {
+    if (this->is_zero()) {
+        return BigInt();
+    }
+    size_t limbs = n / 32;
+    int bits = n % 32;
+    Limbs r(limbs + this->mag.size() + 1, 0);
+    for (size_t i=0; i < this->mag.size(); i++) {
+        uint64_t shifted = (uint64_t)this->mag[i] << bits;
+        r[i + limbs] |= (uint32_t)shifted;
+        r[i + limbs + 1] |= (uint32_t)(shifted >> 32);
+    }
+    return BigInt(this->negative, move(r));
+}
+
+BigInt BigInt::operator>>(uint64_t n) const {
+    if (this->negative) {
+        // floor for negatives, -x >> n == -((x - 1) >> n) - 1
+        return -((-*this - BigInt(1)) >> n) - BigInt(1);
+    }
+    size_t limbs = n / 32;
+    int bits = n % 32;
+    if (limbs >= this->mag.size()) {
+        return BigInt();
+    }
+    Limbs r(this->mag.size() - limbs);
+    for (size_t i=0; i < r.size(); i++) {
+        uint64_t pair = this->mag[i + limbs];
+        if (i + limbs + 1 < this->mag.size()) {
+            pair |= (uint64_t)this->mag[i + limbs + 1] << 32;
+        }
+        r[i] = (uint32_t)(pair >> bits);
+    }
+    return BigInt(false, move(r));
+}
+
+void BigInt::divmod(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r) {
+    Limbs qm, rm;
+    divmod_mag(a.mag, b.mag, qm, rm);
+    q = BigInt(a.negative != b.negative, move(qm));
+    r = BigInt(a.negative, move(rm));
+    // truncated to floored, the remainder takes the divisor's sign
+    if (!r.is_zero() && a.negative != b.negative) {
+        q = q - BigInt(1);
+        r = r + b;
+    }
+}
+
+BigInt BigInt::pow(uint64_t exp) const {
+    BigInt result = BigInt(1);
+    BigInt base = *this;
+    while (exp != 0) {
+        if (exp & 1) result = result * base;
+        exp >>= 1;
+        if (exp != 0) base = base * base;
+    }
+    return result;
+}
+
+BigInt BigInt::bitwise(const BigInt& b, char op) const {
+    // one extra limb so the sign bit of both operands is in range
+    size_t n = max(this->mag.size(), b.mag.size()) + 1;
+    Limbs x = this->twos_complement(n);
+    Limbs y = b.twos_complement(n);
+    Limbs r(n);
+    for (size_t i=0; i < n; i++) {
+        if (op == '&') r[i] = x[i] & y[i];
+        else if (op == '|') r[i] = x[i] | y[i];
+        else r[i] = x[i] ^ y[i];
+    }
+    bool negative = r.back() >> 31;
+    if (negative) {
+        uint64_t carry = 1;
+        for (size_t i=0; i < n; i++) {
+            uint64_t t = (uint64_t)(uint32_t)~r[i] + carry;
+            r[i] = (uint32_t)t;
+            carry = t >> 32;
+        }
+    }
+    return BigInt(negative, move(r));
+}
+
+//===============================================================
+// magnitudes
+
+void BigInt::trim(Limbs& a) {
+    while (!a.empty() && a.back() == 0) {
+        a.pop_back();
+    }
+}
+
+int BigInt::cmp_mag(const Limbs& a, const Limbs& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i=a.size(); i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+BigInt::Limbs BigInt::add_mag(const Limbs& a, const Limbs& b) {
+    const Limbs& longer = a.size() >= b.size() ? a : b;
+    const Limbs& shorter = a.size() >= b.size() ? b : a;
+    Limbs r(longer.size() + 1);
+    uint64_t carry = 0;
+    for (size_t i=0; i < longer.size(); i++) {
+        uint64_t t = (uint64_t)longer[i] + (i < shorter.size() ? shorter[i] : 0) + carry;
+        r[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    r[longer.size()] = (uint32_t)carry;
+    trim(r);
+    return r;
+}
+
+BigInt::Limbs BigInt::sub_mag(const Limbs& a, const Limbs& b) {
+    Limbs r(a.size());
+    int64_t borrow = 0;
+    for (size_t i=0; i < a.size(); i++) {
+        int64_t t = (int64_t)a[i] - (i < b.size() ? b[i] : 0) - borrow;
+        borrow = t < 0;
+        r[i] = (uint32_t)(t + (borrow << 32));
+    }
+    trim(r);
+    return r;
+}
+
+BigInt::Limbs BigInt::mul_mag(const Limbs& a, const Limbs& b) {
+    if (a.empty() || b.empty()) {
+        return Limbs();
+    }
+    if (min(a.size(), b.size()) < KARATSUBA_CUTOFF) {
+        return mul_schoolbook(a, b);
+    }
+    return mul_karatsuba(a, b);
+}
+
+BigInt::Limbs BigInt::mul_schoolbook(const Limbs& a, const Limbs& b) {
+    Limbs r(a.size() + b.size(), 0);
+    for (size_t i=0; i < a.size(); i++) {
+        uint64_t ai = a[i];
+        if (ai == 0) continue;
+        uint64_t carry = 0;
+        for (size_t j=0; j < b.size(); j++) {
+            uint64_t t = ai * b[j] + r[i + j] + carry;
+            r[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        r[i + b.size()] = (uint32_t)carry;
+    }
+    trim(r);
+    return r;
+}
+
+// a*b = z2*B^2m + z1*B^m + z0, with z1 from one product of the sums
+// instead of two, three half size multiplies instead of four
+BigInt::Limbs BigInt::mul_karatsuba(const Limbs& a, const Limbs& b) {
+    size_t m = max(a.size(), b.size()) / 2;
+    auto low = [m](const Limbs& x) {
+        Limbs l(x.begin(), x.begin() + min(m, x.size()));
+        trim(l);
+        return l;
+    };
+    auto high = [m](const Limbs& x) {
+        return x.size() > m ? Limbs(x.begin() + m, x.end()) : Limbs();
+    };
+    Limbs a0 = low(a), a1 = high(a), b0 = low(b), b1 = high(b);
+    Limbs z0 = mul_mag(a0, b0);
+    Limbs z2 = mul_mag(a1, b1);
+    Limbs z1 = mul_mag(add_mag(a0, a1), add_mag(b0, b1));
+    z1 = sub_mag(sub_mag(z1, z0), z2);
+
+    Limbs r(a.size() + b.size() + 1, 0);
+    add_shifted(r, z0, 0);
+    add_shifted(r, z1, m);
+    add_shifted(r, z2, 2 * m);
+    trim(r);
+    return r;
+}
+
+// r += x * B^limbs, r is already long enough for the sum
+void BigInt::add_shifted(Limbs& r, const Limbs& x, size_t limbs) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < x.size(); i++) {
+        uint64_t t = (uint64_t)r[i + limbs] + x[i] + carry;
+        r[i + limbs] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    for (; carry != 0; i++) {
+        uint64_t t = (uint64_t)r[i + limbs] + carry;
+        r[i + limbs] = (uint32_t)t;
+        carry = t >> 32;
+    }
+}
+
+uint32_t BigInt::divmod_small(Limbs& a, uint32_t d) {
+    uint64_t rem = 0;
+    for (size_t i=a.size(); i-- > 0;) {
+        uint64_t cur = (rem << 32) | a[i];
+        a[i] = (uint32_t)(cur / d);
+        rem = cur % d;
+    }
+    trim(a);
+    return (uint32_t)rem;
+}
+
+void BigInt::mul_small_add(Limbs& a, uint32_t m, uint32_t add) {
+    uint64_t carry = add;
+    for (size_t i=0; i < a.size(); i++) {
+        uint64_t t = (uint64_t)a[i] * m + carry;
+        a[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    if (carry != 0) {
+        a.push_back((uint32_t)carry);
+    }
+}
+
+// Knuth's algorithm D, as laid out in Hacker's Delight (divmnu). Both
+// operands are shifted so the divisor's top bit is set, then each
+// quotient limb is estimated from the top two limbs of the remainder
+// and is off by at most one after the correction loop
+void BigInt::divmod_mag(const Limbs& a, const Limbs& b, Limbs& q, Limbs& r) {
+    if (cmp_mag(a, b) < 0) {
+        q.clear();
+        r = a;
+        return;
+    }
+    if (b.size() == 1) {
+        q = a;
+        uint32_t rem = divmod_small(q, b[0]);
+        r = rem == 0 ? Limbs() : Limbs(1, rem);
+        return;
+    }
+    const uint64_t BASE = 1ULL << 32;
+    size_t n = b.size();
+    size_t m = a.size() - n;
+    int s = __builtin_clz(b.back());
+
+    Limbs v(n), u(a.size() + 1);
+    for (size_t i=n-1; i > 0; i--) {
+        v[i] = (b[i] << s) | (uint32_t)((uint64_t)b[i-1] >> (32 - s));
+    }
+    v[0] = b[0] << s;
+    u[a.size()] = (uint32_t)((uint64_t)a.back() >> (32 - s));
+    for (size_t i=a.size()-1; i > 0; i--) {
+        u[i] = (a[i] << s) | (uint32_t)((uint64_t)a[i-1] >> (32 - s));
+    }
+    u[0] = a[0] << s;
+
+    q.assign(m + 1, 0);
+    for (size_t j=m+1; j-- > 0;) {
+        uint64_t num = ((uint64_t)u[j+n] << 32) | u[j+n-1];
+        uint64_t qhat = num / v[n-1];
+        uint64_t rhat = num % v[n-1];
+        while (qhat >= BASE || qhat * v[n-2] > ((rhat << 32) | u[j+n-2])) {
+            qhat--;
+            rhat += v[n-1];
+            if (rhat >= BASE) break;
+        }
+        // multiply and subtract
+        int64_t k = 0, t;
+        for (size_t i=0; i < n; i++) {
+            uint64_t p = qhat * v[i];
+            t = (int64_t)u[i+j] - k - (int64_t)(p & 0xffffffff);
+            u[i+j] = (uint32_t)t;
+            k = (int64_t)(p >> 32) - (t >> 32);
+        }
+        t = (int64_t)u[j+n] - k;
+        u[j+n] = (uint32_t)t;
+        q[j] = (uint32_t)qhat;
+        if (t < 0) {
+            // qhat was one too big, add the divisor back
+            q[j]--;
+            uint64_t carry = 0;
+            for (size_t i=0; i < n; i++) {
+                uint64_t sum = (uint64_t)u[i+j] + v[i] + carry;
+                u[i+j] = (uint32_t)sum;
+                carry = sum >> 32;
+            }
+            u[j+n] += (uint32_t)carry;
+        }
+    }
+    r.assign(n, 0);
+    for (size_t i=0; i < n; i++) {
+        r[i] = (u[i] >> s) | (uint32_t)((uint64_t)u[i+1] << (32 - s));
+    }
+    trim(q);
+    trim(r);
+}
+
+BigInt::Limbs BigInt::twos_complement(size_t n) const {
+    Limbs r(n, 0);
+    copy(this->mag.begin(), this->mag.end(), r.begin());
+    if (this->negative) {
+        uint64_t carry = 1;
+        for (size_t i=0; i < n; i++) {
+            uint64_t t = (uint64_t)(uint32_t)~r[i] + carry;
+            r[i] = (uint32_t)t;
+            carry = t >> 32;
+        }
+    }
+    return r;
+}
@@ -0,0 +1,65 @@
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+// arbitrary precision integer for the ints that do not fit in 64 bits,
+// PyObject keeps everything else inline. Sign and magnitude, the
+// magnitude is little endian base 2^32 limbs with no leading zeros
+class BigInt {
+    public:
+        BigInt();
+        BigInt(int64_t value);
+        // optional sign then decimal digits, the caller validates them
+        static BigInt from_string(const string& s);
+        static BigInt from_double(double d);  // truncates, d must be finite
+
+        bool is_zero() const;
+        bool is_negative() const;
+        bool fits_int64() const;
+        int64_t to_int64() const;
+        double to_double() const;
+        string to_string() const;
+        size_t hash() const;
+        int compare(const BigInt& b) const;  // <0, 0 or >0
+
+        BigInt operator-() const;
+        BigInt operator+(const BigInt& b) const;
+        BigInt operator-(const BigInt& b) const;
+        BigInt operator*(const BigInt& b) const;
+        BigInt operator<<(uint64_t n) const;
+        BigInt operator>>(uint64_t n) const;  // floors, like Python
+        // floored quotient and remainder like Python's // and %, b != 0
+        static void divmod(const BigInt& a, const BigInt& b, BigInt& q, BigInt& r);
+        BigInt pow(uint64_t exp) const;
+        // '&', '|' or '^' on the infinite two's complement representation
+        BigInt bitwise(const BigInt& b, char op) const;
+
+    private:
+        typedef vector<uint32_t> Limbs;
+        // below this many limbs schoolbook multiplication beats Karatsuba
+        static constexpr size_t KARATSUBA_CUTOFF = 40;
+
+        bool negative;
+        Limbs mag;
+
+        BigInt(bool negative, Limbs mag);
+
+        static void trim(Limbs& a);
+        static int cmp_mag(const Limbs& a, const Limbs& b);
+        static Limbs add_mag(const Limbs& a, const Limbs& b);
+        static Limbs sub_mag(const Limbs& a, const Limbs& b);  // needs a >= b
+        static Limbs mul_mag(const Limbs& a, const Limbs& b);
+        static Limbs mul_schoolbook(const Limbs& a, const Limbs& b);
+        static Limbs mul_karatsuba(const Limbs& a, const Limbs& b);
+        static void add_shifted(Limbs& r, const Limbs& x, size_t limbs);
+        static uint32_t divmod_small(Limbs& a, uint32_t d);  // in place, returns the remainder
+        static void mul_small_add(Limbs& a, uint32_t m, uint32_t add);
+        static void divmod_mag(const Limbs& a, const Limbs& b, Limbs& q, Limbs& r);
+        Limbs twos_complement(size_t n) const;
+};
+
+#endif
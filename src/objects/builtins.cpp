@@ -3,26 +3,451 @@
 #include <vector>
 #include <deque>
 #include <tuple>
+#include <algorithm>
+#include <cmath>
 #include "builtins.h"
 #include "pyobject.h"
+#include "pyexception.h"
+#include "pyset.h"
+#include "pylist.h"
+#include "bigint.h"
+#include "writer.h"
+#include "output.h"
+#include "pydict.h"
+#include "stack.h"
+#include "tracer.h"
+#include "instrument.h"
+#include "memstats.h"
 using namespace std;
 
 
-map<string, FnPtr> build_builtins() {
-    map<string, FnPtr> builtins;
-    builtins["print"] = print;
+// every builtin with the arguments it takes, name, function, min and max
+// positional arguments (-1 for any number) and keyword names
+static const vector<Builtin> builtin_table = {
+    {"print", print, 0, -1, {"sep", "end", "file", "flush"}},
+    {"input", input, 0, 1, {}},
+    {"getrecursionlimit", getrecursionlimit, 0, 0, {}},
+    {"setrecursionlimit", setrecursionlimit, 1, 1, {}},
+    {"settrace", settrace, 1, 1, {}},
+    {"setprofile", setprofile, 1, 1, {}},
+    {"gettrace", gettrace, 0, 0, {}},
+    {"getprofile", getprofile, 0, 0, {}},
+    {"tracemalloc_start", tracemalloc_start, 0, 0, {}},
+    {"tracemalloc_stop", tracemalloc_stop, 0, 0, {}},
+    {"tracemalloc_is_tracing", tracemalloc_is_tracing, 0, 0, {}},
+    {"tracemalloc_get_traced_memory", tracemalloc_get_traced_memory, 0, 0, {}},
+    {"tracemalloc_reset_peak", tracemalloc_reset_peak, 0, 0, {}},
+    {"range", range, 1, 3, {}},
+    {"int", int_, 1, 1, {}},
+    {"len", len, 1, 1, {}},
+    {"set", set, 0, 1, {}},
+    {"frozenset", frozenset, 0, 1, {}},
+    {"list", list_, 0, 1, {}},
+    {"sum", sum, 1, 2, {"start"}},
+    {"min", min_, 1, -1, {}},
+    {"max", max_, 1, -1, {}},
+    {"sorted", sorted, 1, 1, {}},
+    {"repr", repr, 1, 1, {}},
+    {"str", str_, 0, 1, {}},
+};
+
+// builtins are stored as function objects so a Name lookup hands
+// back something that can be called directly
+unordered_map<Symbol, PyObject> build_builtins() {
+    unordered_map<Symbol, PyObject> builtins;
+    for (const Builtin& builtin : builtin_table) {
+        builtins[intern(builtin.name)] = PyObject(&builtin, "builtin_function_or_method");
+    }
+    for (const string& name : exception_class_names()) {
+        builtins[intern(name)] = PyObject(name, "type");
+    }
     return builtins;
 }
-PyObject print(PyObject arguments) {
-    string sep = " ";
 
-    if (arguments.size() > 0) {
-        for (int i=0; i < arguments.size()-1; i++) {
-            cout << arguments.at(i).as_string() << sep;
+string plural(int n, string word) {
+    return to_string(n) + " " + word + (n == 1 ? "" : "s");
+}
+
+// the one place a builtin's arguments are checked, so the function
+// itself can index args without looking at nargs again
+PyObject call_builtin(const Builtin* builtin, const PyObject* args, int nargs, 
+                      const PyDict* keywords) {
+    const string& name = builtin->name;
+    INSTRUMENT_DYNAMIC(name + "()");
+    if (builtin->min_args == builtin->max_args && nargs != builtin->min_args) {
+        string expected = builtin->min_args == 0 ? "no arguments"
+                        : builtin->min_args == 1 ? "exactly one argument"
+                        : "exactly " + plural(builtin->min_args, "argument");
+        throw PyException("TypeError", name + "() takes " + expected
+                                       + " (" + to_string(nargs) + " given)");
+    }
+    if (nargs < builtin->min_args) {
+        throw PyException("TypeError", name + " expected at least " 
+                                       + plural(builtin->min_args, "argument") + ", got " + to_string(nargs));
+    }
+    if (builtin->max_args != -1 && nargs > builtin->max_args) {
+        throw PyException("TypeError", name + " expected at most " 
+                                       + plural(builtin->max_args, "argument") + ", got " + to_string(nargs));
+    }
+    if (keywords != nullptr) {
+        if (builtin->keywords.size() == 0) {
+            throw PyException("TypeError", name + "() takes no keyword arguments");
+        }
+        for (const PyDict::Entry& e : keywords->entries()) {
+            const vector<string>& allowed = builtin->keywords;
+            if (find(allowed.begin(), allowed.end(), e.key.as_string()) == allowed.end()) {
+                throw PyException("TypeError", "'" + e.key.as_string() 
+                                               + "' is an invalid keyword argument for " + name + "()");
+            }
+        }
+    }
+    return builtin->function(args, nargs, keywords);
+}
+
+// print(*objects, sep=' ', end='\n', file=None, flush=False), written
+// into the buffered stdout a piece at a time so a large container is
+// never held as one string
+PyObject print(const PyObject* args, int nargs, const PyDict* keywords) {
+    string sep = " ";
+    string end = "\n";
+    bool flush = false;
+    if (keywords != nullptr) {
+        for (const PyDict::Entry& e : keywords->entries()) {
+            string name = e.key.as_string();
+            if (name == "sep" || name == "end") {
+                if (e.value.type != "str" && e.value.type != "None") {
+                    throw PyException("TypeError", name + " must be None or a string, not " 
+                                                   + e.value.type);
+                }
+                if (e.value.type == "str") (name == "sep" ? sep : end) = e.value.as_string();
+            }
+            else if (name == "flush") {
+                flush = e.value.as_bool();
+            }
+            else if (e.value.type != "None") {
+                // file, there are no file objects yet so None is stdout
+                throw runtime_error("print: file='" + e.value.type + "' not implemented");
+            }
         }
-        cout << arguments.at(-1).as_string();
     }
-    cout << endl;
+
+    Output* out = Output::get_instance();
+    Writer& w = out->writer();
+    for (int i=0; i < nargs; i++) {
+        if (i > 0) w.write(sep);
+        args[i].write(w, false);
+    }
+    w.write(end);
+    if (flush) out->flush();
+    else out->end_print(end.find('\n') != string::npos);
 
     return PyObject();  // always returns None
 }
+
+// input([prompt]), stdout is flushed first so the prompt and anything
+// printed before it are showing while this waits
+PyObject input(const PyObject* args, int nargs, const PyDict* keywords) {
+    Output* out = Output::get_instance();
+    if (nargs == 1) {
+        args[0].write(out->writer(), false);
+    }
+    out->flush();
+    string line;
+    if (!getline(cin, line)) {
+        throw PyException("EOFError", "EOF when reading a line");
+    }
+    if (line.size() > 0 && line.back() == '\r') line.pop_back();
+    return PyObject(line, "str");
+}
+
+PyObject getrecursionlimit(const PyObject* args, int nargs, const PyDict* keywords) {
+    return PyObject(Stack::get_recursion_limit(), "int");
+}
+
+PyObject setrecursionlimit(const PyObject* args, int nargs, const PyDict* keywords) {
+    if (args[0].type != "int") {
+        throw PyException("TypeError", "setrecursionlimit() expects a single int");
+    }
+    // calls take native stack segments as they go, any limit can be set
+    Stack::set_recursion_limit((int)PyObject(args[0]));
+    return PyObject();
+}
+
+// sys.settrace() and friends. the hook is called as hook(frame, event,
+// arg) with frame a (function name, line) tuple, see Tracer
+PyObject settrace(const PyObject* args, int nargs, const PyDict* keywords) {
+    Tracer::settrace(args[0]);
+    return PyObject();
+}
+
+PyObject setprofile(const PyObject* args, int nargs, const PyDict* keywords) {
+    Tracer::setprofile(args[0]);
+    return PyObject();
+}
+
+PyObject gettrace(const PyObject* args, int nargs, const PyDict* keywords) {
+    return Tracer::gettrace();
+}
+
+PyObject getprofile(const PyObject* args, int nargs, const PyDict* keywords) {
+    return Tracer::getprofile();
+}
+
+// tracemalloc.start() and friends, flat like getrecursionlimit since
+// there are no modules. only counts with memhook.o linked in
+PyObject tracemalloc_start(const PyObject* args, int nargs, const PyDict* keywords) {
+    MemStats::start();
+    return PyObject();
+}
+
+PyObject tracemalloc_stop(const PyObject* args, int nargs, const PyDict* keywords) {
+    MemStats::stop();
+    return PyObject();
+}
+
+PyObject tracemalloc_is_tracing(const PyObject* args, int nargs, const PyDict* keywords) {
+    return PyObject(MemStats::is_tracing(), "bool");
+}
+
+// (current, peak) bytes of the blocks traced since tracemalloc_start()
+PyObject tracemalloc_get_traced_memory(const PyObject* args, int nargs, const PyDict* keywords) {
+    vector<PyObject> sizes = {
+        PyObject((int64_t)MemStats::traced_current(), "int"),
+        PyObject((int64_t)MemStats::traced_peak(), "int"),
+    };
+    return PyObject(sizes, "tuple");
+}
+
+PyObject tracemalloc_reset_peak(const PyObject* args, int nargs, const PyDict* keywords) {
+    MemStats::reset_peak();
+    return PyObject();
+}
+
+// range(stop), range(start, stop[, step])
+PyObject range(const PyObject* args, int nargs, const PyDict* keywords) {
+    int64_t values[3] = {0, 0, 1};
+    for (int i=0; i < nargs; i++) {
+        const PyObject& arg = args[i];
+        if (arg.type != "int" && arg.type != "bool") {
+            throw PyException("TypeError", "'" + arg.type 
+                                           + "' object cannot be interpreted as an integer");
+        }
+        if (!arg.as_int64(values[i])) {
+            throw PyException("OverflowError", "Python int too large to convert to C long");
+        }
+    }
+    if (nargs == 1) {
+        values[1] = values[0];
+        values[0] = 0;
+    }
+    if (values[2] == 0) {
+        throw PyException("ValueError", "range() arg 3 must not be zero");
+    }
+    return PyObject(PyRange{values[0], values[1], values[2]}, "range");
+}
+
+PyObject len(const PyObject* args, int nargs, const PyDict* keywords) {
+    const PyObject& arg = args[0];
+    if (arg.type != "str" && arg.type != "list" && arg.type != "tuple" 
+        && arg.type != "dict" && arg.type != "range" && !arg.is_set()) {
+        throw PyException("TypeError", "object of type '" + arg.type + "' has no len()");
+    }
+    if (arg.type == "range") {
+        // a range can be longer than size() can count
+        uint64_t n = arg.as_range().length();
+        if (n > INT64_MAX) {
+            throw PyException("OverflowError", "Python int too large to convert to C ssize_t");
+        }
+        return PyObject((int64_t)n, "int");
+    }
+    return PyObject(arg.size(), "int");
+}
+
+// set() and frozenset() share this, the table is sized for the
+// iterable before anything is inserted
+PyObject build_set(const PyObject* args, int nargs, string type) {
+    PySet items;
+    if (nargs == 1) {
+        const PyObject& iterable = args[0];
+        if (iterable.type != "int" && iterable.type != "float" && iterable.type != "bool") {
+            items.reserve(iterable.size());
+        }
+        int64_t idx = 0;
+        PyObject item;
+        while (iterable.iter_next(idx, item)) {
+            items.insert(item);
+        }
+    }
+    return PyObject(move(items), type);
+}
+
+PyObject set(const PyObject* args, int nargs, const PyDict* keywords) {
+    return build_set(args, nargs, "set");
+}
+
+PyObject frozenset(const PyObject* args, int nargs, const PyDict* keywords) {
+    return build_set(args, nargs, "frozenset");
+}
+
+// the items of any iterable as new list storage, appending packs
+// numbers the same way a list display does
+PyList list_items(const PyObject& iterable) {
+    if (iterable.type == "list") {
+        return iterable.as_list();
+    }
+    PyList items;
+    int64_t idx = 0;
+    PyObject item;
+    while (iterable.iter_next(idx, item)) {
+        items.append(item);
+    }
+    return items;
+}
+
+PyObject list_(const PyObject* args, int nargs, const PyDict* keywords) {
+    if (nargs == 0) {
+        return PyObject(vector<PyObject>(), "list");
+    }
+    return PyObject(list_items(args[0]), "list");
+}
+
+// sum(iterable, start=0), packed lists add the raw numbers
+PyObject sum(const PyObject* args, int nargs, const PyDict* keywords) {
+    const PyObject& iterable = args[0];
+    PyObject total = nargs == 2 ? args[1] : PyObject(0, "int");
+    if (keywords != nullptr) {
+        if (nargs == 2) {
+            throw PyException("TypeError", "argument for sum() given by name ('start') and position (2)");
+        }
+        total = *keywords->find(PyObject(string("start"), "str"));
+    }
+    if (total.type == "str") {
+        throw PyException("TypeError", "sum() can't sum strings [use ''.join(seq) instead]");
+    }
+    if (iterable.type == "list") {
+        const PyList& items = iterable.as_list();
+        int64_t n;
+        if (items.kind() == PyList::INTS && total.type == "int" && total.as_int64(n)) {
+            // an overflow falls through to the generic loop, which goes to BigInt
+            bool overflow = false;
+            for (int64_t x : items.ints()) {
+                if (__builtin_add_overflow(n, x, &n)) {
+                    overflow = true;
+                    break;
+                }
+            }
+            if (!overflow) return PyObject(n, "int");
+        }
+        if (items.kind() == PyList::FLOATS && (total.type == "int" || total.type == "float")) {
+            double n = total.as_double();
+            for (double x : items.floats()) n += x;
+            return PyObject(n, "float");
+        }
+    }
+    int64_t idx = 0;
+    PyObject item;
+    while (iterable.iter_next(idx, item)) {
+        total = total + item;
+    }
+    return total;
+}
+
+// min and max over one iterable or over the arguments, the first of
+// equal items wins like in Python
+PyObject extreme(const PyObject* args, int nargs, string name, bool largest) {
+    PyObject items = nargs == 1 ? args[0] : PyObject(vector<PyObject>(args, args + nargs), "tuple");
+    if (items.type == "list" && items.size() > 0) {
+        const PyList& list = items.as_list();
+        if (list.kind() == PyList::INTS) {
+            const vector<int64_t>& v = list.ints();
+            return PyObject(largest ? *max_element(v.begin(), v.end()) 
+                                    : *min_element(v.begin(), v.end()), "int");
+        }
+        if (list.kind() == PyList::FLOATS) {
+            const vector<double>& v = list.floats();
+            return PyObject(largest ? *max_element(v.begin(), v.end()) 
+                                    : *min_element(v.begin(), v.end()), "float");
+        }
+    }
+    int64_t idx = 0;
+    PyObject item, best;
+    bool found = false;
+    while (items.iter_next(idx, item)) {
+        if (!found || (largest ? item > best : item < best).as_bool()) {
+            best = item;
+            found = true;
+        }
+    }
+    if (!found) {
+        throw PyException("ValueError", name + "() arg is an empty sequence");
+    }
+    return best;
+}
+
+PyObject min_(const PyObject* args, int nargs, const PyDict* keywords) {
+    return extreme(args, nargs, "min", false);
+}
+
+PyObject max_(const PyObject* args, int nargs, const PyDict* keywords) {
+    return extreme(args, nargs, "max", true);
+}
+
+PyObject sorted(const PyObject* args, int nargs, const PyDict* keywords) {
+    PyList items = list_items(args[0]);
+    items.sort();
+    return PyObject(move(items), "list");
+}
+
+PyObject repr(const PyObject* args, int nargs, const PyDict* keywords) {
+    return PyObject(args[0].as_repr(), "str");
+}
+
+PyObject str_(const PyObject* args, int nargs, const PyDict* keywords) {
+    if (nargs == 0) {
+        return PyObject("", "str");
+    }
+    return PyObject(args[0].as_string(), "str");
+}
+
+PyObject int_(const PyObject* args, int nargs, const PyDict* keywords) {
+    const PyObject& arg = args[0];
+    if (arg.type == "int") {
+        return arg;
+    }
+    if (arg.type == "bool") {
+        return arg + PyObject(0, "int");
+    }
+    if (arg.type == "float") {
+        if (isnan(arg.as_double())) {
+            throw PyException("ValueError", "cannot convert float NaN to integer");
+        }
+        if (isinf(arg.as_double())) {
+            throw PyException("OverflowError", "cannot convert float infinity to integer");
+        }
+        return PyObject(BigInt::from_double(arg.as_double()), "int");
+    }
+    if (arg.type != "str") {
+        throw PyException("TypeError", "int() argument must be a string or a number, not '" 
+                                       + arg.type + "'");
+    }
+    // optional sign and surrounding whitespace, base 10 only
+    string s = arg.as_string();
+    size_t start = s.find_first_not_of(" \t\n");
+    size_t end = s.find_last_not_of(" \t\n");
+    size_t i = start;
+    if (i != string::npos && (s[i] == '+' || s[i] == '-')) i++;
+    bool valid = i != string::npos && i <= end;
+    for (size_t j=i; valid && j <= end; j++) {
+        valid = isdigit(s[j]);
+    }
+    if (!valid) {
+        // thrown as an instance, a fallback handler gets it without any parsing
+        vector<PyObject> message = {PyObject("invalid literal for int() with base 10: '" + s + "'", "str")};
+        throw PyException(new_exception("ValueError", PyObject(move(message), "tuple")));
+    }
+    string digits = s.substr(start, end-start+1);
+    if (digits.size() <= 18) {
+        return PyObject((int64_t)stoll(digits), "int");
+    }
+    return PyObject(BigInt::from_string(digits), "int");
+}
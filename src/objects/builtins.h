@@ -3,16 +3,52 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <unordered_map>
 #include <tuple>
 #include "pyobject.h"
+#include "symbol.h"
 using namespace std;
 
-typedef PyObject (*FnPtr)(PyObject);
+// a builtin and the arguments it accepts. call_builtin checks a call
+// against these once, so the functions themselves only see argument
+// counts in [min_args, max_args] (max_args -1 is unlimited) and keyword
+// names from their own list
+struct Builtin {
+    string name;
+    FnPtr function;
+    int min_args;
+    int max_args;
+    vector<string> keywords;
+};
 
-map<string, FnPtr> build_builtins();
-tuple<bool, PyObject> call_builtin(map<string, FnPtr> builtins, string fname, vector<PyObject> args);
-PyObject print(PyObject arguments);
+unordered_map<Symbol, PyObject> build_builtins();
+PyObject call_builtin(const Builtin* builtin, const PyObject* args, int nargs, 
+                      const PyDict* keywords);
+PyObject print(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject input(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject getrecursionlimit(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject setrecursionlimit(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject settrace(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject setprofile(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject gettrace(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject getprofile(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject tracemalloc_start(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject tracemalloc_stop(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject tracemalloc_is_tracing(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject tracemalloc_get_traced_memory(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject tracemalloc_reset_peak(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject range(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject len(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject set(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject frozenset(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject list_(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject sum(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject min_(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject max_(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject sorted(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject repr(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject str_(const PyObject* args, int nargs, const PyDict* keywords);
+PyObject int_(const PyObject* args, int nargs, const PyDict* keywords);
 
 
-#endif
\ No newline at end of file
+#endif
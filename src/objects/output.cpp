@@ -0,0 +1,45 @@
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "output.h"
+#include "writer.h"
+using namespace std;
+
+
+Output* Output::output = nullptr;
+
+// the writer hands its buffer to cout, and so to whatever cout's
+// streambuf is at that moment (the tests and the terminal swap it)
+Output::Output() : stdout_writer(&cout) {
+    this->line_buffered = isatty(STDOUT_FILENO);
+}
+
+Output* Output::get_instance() {
+    if (output == nullptr) {
+        output = new Output();
+    }
+    return output;
+}
+
+Writer& Output::writer() {
+    return this->stdout_writer;
+}
+
+void Output::end_print(bool newline) {
+    if (newline && this->line_buffered) {
+        this->flush();
+    }
+}
+
+void Output::flush() {
+    this->stdout_writer.flush();
+    cout.flush();
+}
+
+bool Output::is_line_buffered() {
+    return this->line_buffered;
+}
+
+void Output::set_line_buffered(bool line_buffered) {
+    this->line_buffered = line_buffered;
+}
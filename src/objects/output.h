@@ -0,0 +1,39 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <string>
+#include "writer.h"
+using namespace std;
+
+// the interpreter's stdout. print() writes into one large buffer instead
+// of flushing cout for every line, and the buffer goes out when it fills.
+// Like Python's own io it is line buffered when stdout is a terminal and
+// block buffered otherwise. The end of a program, an uncaught error and
+// input() flush it so nothing is lost or shown out of order
+class Output {
+    private:
+        Writer stdout_writer;
+        bool line_buffered;
+
+    protected:
+        Output();
+
+        static Output* output;
+
+    public:
+        // not cloneable
+        Output(Output &other) = delete;
+        // not assignable
+        void operator=(const Output&) = delete;
+
+        static Output* get_instance();
+
+        Writer& writer();
+        // called once a print is written, flushes a finished line on a terminal
+        void end_print(bool newline);
+        void flush();
+        bool is_line_buffered();
+        void set_line_buffered(bool line_buffered);
+};
+
+#endif
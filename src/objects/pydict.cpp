@@ -0,0 +1,86 @@
+#include <string>
+#include <vector>
+#include "pydict.h"
+#include "pyobject.h"
+using namespace std;
+
+
+PyDict::PyDict() {
+    this->indices.assign(MIN_SIZE, EMPTY);
+}
+
+int PyDict::size() const {
+    return this->items.size();
+}
+
+const vector<PyDict::Entry>& PyDict::entries() const {
+    return this->items;
+}
+
+size_t PyDict::lookup(const PyObject& key, size_t hash) const {
+    // CPython's probe sequence, the perturb term brings the high bits of
+    // the hash in so keys differing only there do not collide forever
+    size_t mask = this->indices.size() - 1;
+    size_t perturb = hash;
+    size_t i = hash & mask;
+    while (true) {
+        int32_t idx = this->indices[i];
+        if (idx == EMPTY) {
+            return i;
+        }
+        const Entry& e = this->items[idx];
+        if (e.hash == hash && e.key.equals(key)) {
+            return i;
+        }
+        perturb >>= 5;
+        i = (i * 5 + perturb + 1) & mask;
+    }
+}
+
+const PyObject* PyDict::find(const PyObject& key) const {
+    int32_t idx = this->indices[this->lookup(key, key.hash())];
+    return idx == EMPTY ? nullptr : &this->items[idx].value;
+}
+
+PyObject* PyDict::find(const PyObject& key) {
+    int32_t idx = this->indices[this->lookup(key, key.hash())];
+    return idx == EMPTY ? nullptr : &this->items[idx].value;
+}
+
+void PyDict::set(const PyObject& key, PyObject value) {
+    size_t hash = key.hash();
+    size_t slot = this->lookup(key, hash);
+    if (this->indices[slot] != EMPTY) {
+        this->items[this->indices[slot]].value = move(value);
+        return;
+    }
+    // keep the table at most 2/3 full so probe chains stay short
+    if ((this->items.size() + 1) * 3 > this->indices.size() * 2) {
+        this->resize(this->items.size() + 1);
+        slot = this->lookup(key, hash);
+    }
+    this->indices[slot] = this->items.size();
+    this->items.push_back(Entry{hash, key, move(value)});
+}
+
+void PyDict::resize(size_t min_used) {
+    size_t n = MIN_SIZE;
+    while (n * 2 < min_used * 3) n <<= 1;
+    this->indices.assign(n, EMPTY);
+    // hashes are cached and keys are unique, only free slots are needed
+    size_t mask = n - 1;
+    for (size_t idx=0; idx < this->items.size(); idx++) {
+        size_t hash = this->items[idx].hash;
+        size_t perturb = hash;
+        size_t i = hash & mask;
+        while (this->indices[i] != EMPTY) {
+            perturb >>= 5;
+            i = (i * 5 + perturb + 1) & mask;
+        }
+        this->indices[i] = idx;
+    }
+}
+
+size_t PyDict::memory_usage() const {
+    return this->indices.capacity() * sizeof(int32_t) + this->items.capacity() * sizeof(Entry);
+}
@@ -0,0 +1,48 @@
+#ifndef PYDICT_H
+#define PYDICT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "pyobject.h"
+using namespace std;
+
+// insertion ordered hash table laid out like CPython's dict: a sparse
+// array of indices into a dense array of entries. Entries keep their
+// hash so growing never rehashes a key, and iterating walks the dense
+// array in the order keys were added
+// NOTE: there is no deletion, nothing in the language can remove a key yet
+class PyDict {
+    public:
+        struct Entry {
+            size_t hash;
+            PyObject key;
+            PyObject value;
+        };
+
+        PyDict();
+
+        int size() const;
+        const vector<Entry>& entries() const;
+
+        // nullptr when the key is missing, throws for unhashable keys
+        const PyObject* find(const PyObject& key) const;
+        PyObject* find(const PyObject& key);
+        void set(const PyObject& key, PyObject value);
+
+        // bytes held by the two tables, for the benchmarks
+        size_t memory_usage() const;
+
+    private:
+        static constexpr int32_t EMPTY = -1;
+        static constexpr int MIN_SIZE = 8;
+
+        vector<int32_t> indices;  // power of two long
+        vector<Entry> items;
+
+        // slot in indices holding key, or the EMPTY slot where it would go
+        size_t lookup(const PyObject& key, size_t hash) const;
+        void resize(size_t min_used);
+};
+
+#endif
@@ -0,0 +1,80 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <stdexcept>
+#include "pyexception.h"
+#include "pyobject.h"
+#include "pylist.h"
+using namespace std;
+
+
+// class -> base class, a subset of Python's builtin hierarchy
+static const map<string, string> exception_bases = {
+    {"BaseException", ""},
+    {"Exception", "BaseException"},
+    {"ArithmeticError", "Exception"},
+    {"OverflowError", "ArithmeticError"},
+    {"ZeroDivisionError", "ArithmeticError"},
+    {"AssertionError", "Exception"},
+    {"AttributeError", "Exception"},
+    {"EOFError", "Exception"},
+    {"LookupError", "Exception"},
+    {"MemoryError", "Exception"},
+    {"IndexError", "LookupError"},
+    {"KeyError", "LookupError"},
+    {"NameError", "Exception"},
+    {"UnboundLocalError", "NameError"},
+    {"RuntimeError", "Exception"},
+    {"NotImplementedError", "RuntimeError"},
+    {"RecursionError", "RuntimeError"},
+    {"StopIteration", "Exception"},
+    {"SyntaxError", "Exception"},
+    {"TypeError", "Exception"},
+    {"ValueError", "Exception"},
+};
+
+static string exception_message(const PyObject& value) {
+    string message = value.as_string();
+    return message == "" ? value.get_class_name() : value.get_class_name() + ": " + message;
+}
+
+PyException::PyException(PyObject value) : runtime_error(exception_message(value)) {
+    this->cls = value.get_class_name();
+    this->value = value;
+}
+
+PyException::PyException(const string& cls, const string& message) 
+    : runtime_error(message == "" ? cls : cls + ": " + message) {
+    this->cls = cls;
+    vector<PyObject> args;
+    if (message != "") args.push_back(PyObject(message, "str"));
+    this->value = PyObject(cls, args, "exception");
+}
+
+const vector<string>& exception_class_names() {
+    static vector<string> names;
+    if (names.size() == 0) {
+        for (auto& it : exception_bases) names.push_back(it.first);
+    }
+    return names;
+}
+
+bool is_exception_class(const string& name) {
+    return exception_bases.find(name) != exception_bases.end();
+}
+
+bool exception_matches(const string& name, const string& handler) {
+    // walk up the bases, the hierarchy is only a few levels deep
+    string cls = name;
+    while (cls != "") {
+        if (cls == handler) return true;
+        auto it = exception_bases.find(cls);
+        if (it == exception_bases.end()) return false;
+        cls = it->second;
+    }
+    return false;
+}
+
+PyObject new_exception(const string& name, PyObject arguments) {
+    return PyObject(name, arguments.as_list().items(), "exception");
+}
@@ -0,0 +1,31 @@
+#ifndef PYEXCEPTION_H
+#define PYEXCEPTION_H
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "pyobject.h"
+using namespace std;
+
+// a Python level exception in flight, what() reads like the last line
+// of a traceback so uncaught ones print the same as runtime_errors
+class PyException: public runtime_error {
+    public:
+        string cls;      // the exception class, what handlers match
+        PyObject value;  // the exception instance
+
+        PyException(PyObject value);
+        // raised by the interpreter, PyException("TypeError", "...") is
+        // TypeError("..."), an empty message raises it without arguments
+        PyException(const string& cls, const string& message);
+};
+
+// exception classes, BaseException at the root
+const vector<string>& exception_class_names();
+bool is_exception_class(const string& name);
+bool exception_matches(const string& name, const string& handler);
+
+// ValueError("msg"), the instance keeps its args like Python's .args
+PyObject new_exception(const string& name, PyObject arguments);
+
+#endif
@@ -0,0 +1,241 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+#include <climits>
+#include <stdexcept>
+#include "pylist.h"
+#include "pyobject.h"
+#include "pyexception.h"
+using namespace std;
+
+
+PyList::PyList() {
+    this->storage = INTS;
+}
+
+PyList::PyList(vector<PyObject> items, bool pack) {
+    this->storage = OBJECTS;
+    if (pack && items.size() > 0) {
+        Kind kind = kind_of(items[0]);
+        for (const PyObject& item : items) {
+            if (kind_of(item) != kind) {
+                kind = OBJECTS;
+                break;
+            }
+        }
+        this->storage = kind;
+    }
+    if (this->storage == INTS) {
+        this->int_items.reserve(items.size());
+        for (const PyObject& item : items) this->int_items.push_back(item.i_value);
+    }
+    else if (this->storage == FLOATS) {
+        this->float_items.reserve(items.size());
+        for (const PyObject& item : items) this->float_items.push_back(item.f_value);
+    }
+    else {
+        this->object_items = move(items);
+    }
+}
+
+PyList::Kind PyList::kind_of(const PyObject& value) {
+    if (value.type == "int" && value.big_value == nullptr) return INTS;
+    if (value.type == "float") return FLOATS;
+    return OBJECTS;
+}
+
+PyList::Kind PyList::kind() const {
+    return this->storage;
+}
+
+int PyList::size() const {
+    if (this->storage == INTS) return this->int_items.size();
+    if (this->storage == FLOATS) return this->float_items.size();
+    return this->object_items.size();
+}
+
+// boxes every packed item, after this the list holds anything
+void PyList::to_objects() {
+    if (this->storage == OBJECTS) {
+        return;
+    }
+    this->object_items = this->items();
+    this->int_items = vector<int64_t>();
+    this->float_items = vector<double>();
+    this->storage = OBJECTS;
+}
+
+PyObject PyList::at(int i) const {
+    PyObject out;
+    this->get(i, out);
+    return out;
+}
+
+void PyList::get(int i, PyObject& out) const {
+    if (this->storage == INTS) {
+        if (out.type != "int") out.reset_as("int");
+        if (out.big_value != nullptr) out.big_value = nullptr;
+        out.i_value = this->int_items[i];
+    }
+    else if (this->storage == FLOATS) {
+        if (out.type != "float") out.reset_as("float");
+        out.f_value = this->float_items[i];
+    }
+    else {
+        out = this->object_items[i];
+    }
+}
+
+void PyList::set(int i, const PyObject& value) {
+    Kind kind = kind_of(value);
+    if (kind != this->storage) {
+        this->to_objects();
+    }
+    if (this->storage == INTS) this->int_items[i] = value.i_value;
+    else if (this->storage == FLOATS) this->float_items[i] = value.f_value;
+    else this->object_items[i] = value;
+}
+
+PyObject& PyList::ref(int i) {
+    this->to_objects();
+    return this->object_items[i];
+}
+
+void PyList::append(const PyObject& value) {
+    Kind kind = kind_of(value);
+    if (this->size() == 0) {
+        this->clear();
+        this->storage = kind;
+    }
+    else if (kind != this->storage) {
+        this->to_objects();
+    }
+    if (this->storage == INTS) this->int_items.push_back(value.i_value);
+    else if (this->storage == FLOATS) this->float_items.push_back(value.f_value);
+    else this->object_items.push_back(value);
+}
+
+void PyList::extend(const PyList& other) {
+    if (this->size() == 0 && this != &other) {
+        *this = other;
+        return;
+    }
+    // other can be this list, so the count is taken before anything grows
+    int n = other.size();
+    if (other.size() > 0 && other.storage != this->storage) {
+        this->to_objects();
+    }
+    if (this->storage == INTS) {
+        this->int_items.reserve(this->int_items.size() + n);
+        for (int i=0; i < n; i++) this->int_items.push_back(other.int_items[i]);
+    }
+    else if (this->storage == FLOATS) {
+        this->float_items.reserve(this->float_items.size() + n);
+        for (int i=0; i < n; i++) this->float_items.push_back(other.float_items[i]);
+    }
+    else {
+        this->object_items.reserve(this->object_items.size() + n);
+        for (int i=0; i < n; i++) this->object_items.push_back(other.at(i));
+    }
+}
+
+// list *= times
+void PyList::repeat(int64_t times) {
+    if (times <= 0) {
+        this->clear();
+        return;
+    }
+    int n = this->size();
+    // indexes are ints, a longer list could never be used
+    int64_t total;
+    if (__builtin_mul_overflow((int64_t)n, times, &total) || total > INT_MAX) {
+        throw PyException("MemoryError", "");
+    }
+    if (n == 0) return;
+    if (this->storage == INTS) {
+        this->int_items.reserve(total);
+        for (int64_t i=1; i < times; i++) {
+            this->int_items.insert(this->int_items.end(),
+                                   this->int_items.begin(), this->int_items.begin() + n);
+        }
+    }
+    else if (this->storage == FLOATS) {
+        this->float_items.reserve(total);
+        for (int64_t i=1; i < times; i++) {
+            this->float_items.insert(this->float_items.end(),
+                                     this->float_items.begin(), this->float_items.begin() + n);
+        }
+    }
+    else {
+        this->object_items.reserve(total);
+        for (int64_t i=1; i < times; i++) {
+            for (int j=0; j < n; j++) this->object_items.push_back(this->object_items[j]);
+        }
+    }
+}
+
+void PyList::clear() {
+    this->int_items.clear();
+    this->float_items.clear();
+    this->object_items.clear();
+    this->storage = INTS;
+}
+
+// '<' with a NaN is false both ways, which is no ordering at all and
+// lets the sort read past the ends. NaNs go last, in their old order
+static bool float_less(double a, double b) {
+    return a < b || (isnan(b) && !isnan(a));
+}
+
+static bool object_less(const PyObject& a, const PyObject& b) {
+    if (a.is_number() && b.is_number() && (a.type == "float" || b.type == "float")) {
+        double x = a.as_double();
+        double y = b.as_double();
+        if (isnan(x) || isnan(y)) return float_less(x, y);
+    }
+    return (a < b).as_bool();
+}
+
+// ascending and stable, packed lists sort the raw numbers. floats stay
+// stable as well, 0.0 and -0.0 are equal but still printed apart
+void PyList::sort() {
+    if (this->storage == INTS) {
+        std::sort(this->int_items.begin(), this->int_items.end());
+    }
+    else if (this->storage == FLOATS) {
+        stable_sort(this->float_items.begin(), this->float_items.end(), float_less);
+    }
+    else {
+        stable_sort(this->object_items.begin(), this->object_items.end(), object_less);
+    }
+}
+
+const vector<int64_t>& PyList::ints() const {
+    return this->int_items;
+}
+
+const vector<double>& PyList::floats() const {
+    return this->float_items;
+}
+
+const vector<PyObject>& PyList::objects() const {
+    return this->object_items;
+}
+
+vector<PyObject> PyList::items() const {
+    if (this->storage == OBJECTS) {
+        return this->object_items;
+    }
+    vector<PyObject> items(this->size());
+    for (int i=0; i < items.size(); i++) {
+        this->get(i, items[i]);
+    }
+    return items;
+}
+
+size_t PyList::memory_usage() const {
+    return this->int_items.capacity() * sizeof(int64_t)
+         + this->float_items.capacity() * sizeof(double)
+         + this->object_items.capacity() * sizeof(PyObject);
+}
@@ -0,0 +1,56 @@
+#ifndef PYLIST_H
+#define PYLIST_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "pyobject.h"
+using namespace std;
+
+// list and tuple storage. A list holding only ints or only floats keeps
+// them unboxed in a packed int64_t or double array, 8 bytes an item
+// instead of a whole PyObject, and moves to generic PyObject storage the
+// first time something of another type goes in. It never switches back
+// unless it is emptied
+class PyList {
+    public:
+        enum Kind { INTS, FLOATS, OBJECTS };
+
+        PyList();
+        // pack picks the unboxed storage when the items allow it, tuples
+        // stay generic since they are mostly argument packs unpacked again
+        PyList(vector<PyObject> items, bool pack);
+
+        Kind kind() const;
+        int size() const;
+
+        PyObject at(int i) const;
+        void get(int i, PyObject& out) const;  // overwrites out in place
+        void set(int i, const PyObject& value);
+        PyObject& ref(int i);  // moves to generic storage first
+        void append(const PyObject& value);
+        void extend(const PyList& other);  // other can be this list
+        void repeat(int64_t times);
+        void clear();
+        void sort();
+
+        // the packed arrays, only meaningful for the matching kind()
+        const vector<int64_t>& ints() const;
+        const vector<double>& floats() const;
+        const vector<PyObject>& objects() const;
+        vector<PyObject> items() const;  // boxed copy of any kind
+
+        // bytes held by the item arrays, for the benchmarks
+        size_t memory_usage() const;
+
+    private:
+        Kind storage;
+        vector<int64_t> int_items;
+        vector<double> float_items;
+        vector<PyObject> object_items;
+
+        static Kind kind_of(const PyObject& value);
+        void to_objects();
+};
+
+#endif
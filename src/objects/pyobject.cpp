@@ -3,12 +3,21 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <charconv>
+#include <climits>
 #include "pyobject.h"
+#include "pyexception.h"
+#include "pydict.h"
+#include "pyset.h"
+#include "pylist.h"
+#include "bigint.h"
+#include "writer.h"
+#include "builtins.h"
+#include "instrument.h"
+#include "memstats.h"
 #include "ast.h"
 using namespace std;
 
-// TODO: add sets
-
 // ==============================================================
 // helper functions
 
@@ -20,19 +29,126 @@ string string_mul(string s, int amt) {
     return new_s;
 }
 
-string trim_trailing_zeros(string s) {
-    s = s.substr(0, s.find_last_not_of('0')+1);
-    if(s.find('.') == s.size()-1) {
-        s += '0';
+// repr(float), the shortest digits that read back as the same double.
+// to_chars finds them (libstdc++ uses Ryu) and they are laid out the way
+// Python does, positional for exponents -4 to 15 and d.ddde+XX otherwise
+string float_repr(double d) {
+    if (isnan(d)) return "nan";
+    if (isinf(d)) return d > 0 ? "inf" : "-inf";
+    char sci[32];
+    char* end = to_chars(sci, sci + sizeof(sci), d, chars_format::scientific).ptr;
+
+    // split d.ddde[+-]xx into its sign, digits and exponent
+    char digits[24];
+    int n = 0;
+    const char* p = sci;
+    bool negative = *p == '-';
+    if (negative) p++;
+    for (; *p != 'e'; p++) {
+        if (*p != '.') digits[n++] = *p;
+    }
+    int exp = 0;
+    from_chars(p + (p[1] == '+' ? 2 : 1), end, exp);
+
+    char out[40];
+    int len = 0;
+    if (negative) out[len++] = '-';
+    if (exp >= -4 && exp < 16) {
+        if (exp < 0) {
+            out[len++] = '0';
+            out[len++] = '.';
+            for (int i=0; i < -exp-1; i++) out[len++] = '0';
+            for (int i=0; i < n; i++) out[len++] = digits[i];
+        }
+        else {
+            // exp+1 digits before the point, padded with zeros if short
+            for (int i=0; i <= exp; i++) out[len++] = i < n ? digits[i] : '0';
+            out[len++] = '.';
+            if (n <= exp+1) out[len++] = '0';
+            for (int i=exp+1; i < n; i++) out[len++] = digits[i];
+        }
+    }
+    else {
+        out[len++] = digits[0];
+        if (n > 1) {
+            out[len++] = '.';
+            for (int i=1; i < n; i++) out[len++] = digits[i];
+        }
+        out[len++] = 'e';
+        out[len++] = exp < 0 ? '-' : '+';
+        if (exp < 0) exp = -exp;
+        if (exp < 10) out[len++] = '0';
+        len = to_chars(out + len, out + sizeof(out), exp).ptr - out;
+    }
+    return string(out, len);
+}
+
+// Python's string repr, single quotes unless only double quotes avoid
+// escaping, and escapes for backslashes and control characters
+void write_quoted(Writer& w, const string& s) {
+    char quote = s.find('\'') != string::npos && s.find('"') == string::npos ? '"' : '\'';
+    w.write(quote);
+    for (char c : s) {
+        if (c == quote || c == '\\') {
+            w.write('\\');
+            w.write(c);
+        }
+        else if (c == '\n') w.write("\\n", 2);
+        else if (c == '\r') w.write("\\r", 2);
+        else if (c == '\t') w.write("\\t", 2);
+        else if ((unsigned char)c < 0x20 || c == 0x7f) {
+            const char* hex = "0123456789abcdef";
+            char escape[4] = {'\\', 'x', hex[(c >> 4) & 0xf], hex[c & 0xf]};
+            w.write(escape, 4);
+        }
+        else w.write(c);
+    }
+    w.write(quote);
+}
+
+// counted in unsigned 64 bits, stop - start can overflow int64_t
+uint64_t PyRange::length() const {
+    if (this->step > 0 && this->start < this->stop) {
+        return ((uint64_t)this->stop - (uint64_t)this->start - 1) / (uint64_t)this->step + 1;
+    }
+    if (this->step < 0 && this->start > this->stop) {
+        return ((uint64_t)this->start - (uint64_t)this->stop - 1) / (0 - (uint64_t)this->step) + 1;
     }
-    return s;
+    return 0;
+}
+
+// wraps in unsigned arithmetic, the result is between start and stop
+int64_t PyRange::item(uint64_t i) const {
+    return (int64_t)((uint64_t)this->start + i * (uint64_t)this->step);
+}
+
+// ranges are equal when they produce the same values
+bool same_range(const PyRange& r1, const PyRange& r2) {
+    uint64_t n1 = r1.length();
+    uint64_t n2 = r2.length();
+    if (n1 != n2) return false;
+    if (n1 == 0) return true;
+    if (r1.start != r2.start) return false;
+    return n1 == 1 || r1.step == r2.step;
+}
+
+// --mem-stats charges what an operation on this type allocates to the
+// payload it builds
+static MemCategory payload_category(const string& type) {
+    if (type == "str") return MEM_STR;
+    if (type == "list" || type == "tuple") return MEM_LIST;
+    if (type == "dict") return MEM_DICT;
+    if (type == "set" || type == "frozenset") return MEM_SET;
+    if (type == "int") return MEM_INT;
+    return MEM_OTHER;
 }
 
 // ==============================================================
 // constructors
 
 // valid types:
-// None, str, int, float, bool, list, dict, tuple, class, function
+// None, str, int, float, bool, list, dict, tuple, class, function,
+// builtin_function_or_method, range
 
 PyObject::PyObject() {
     this->type = "None";
@@ -50,6 +166,28 @@ PyObject::PyObject(int i, string type) {
     this->type = type;
     this->check_valid_type();
 }
+PyObject::PyObject(int64_t i, string type) {
+    if (type != "int") {
+        cout << "WARNING: recieved \'int\' of type \'" << type << "\'" << endl;
+    }
+    else {
+        this->i_value = i;
+    }
+    this->type = type;
+    this->check_valid_type();
+}
+// ints too large for i_value, anything that fits is stored inline
+PyObject::PyObject(BigInt big, string type) {
+    MemScope mem_scope(MEM_INT);
+    if (big.fits_int64()) {
+        this->i_value = big.to_int64();
+    }
+    else {
+        this->big_value = make_shared<BigInt>(move(big));
+    }
+    this->type = type;
+    this->check_valid_type();
+}
 PyObject::PyObject(float d, string type) {
     // if (type == "bool") {
     if (type != "float") {
@@ -75,6 +213,7 @@ PyObject::PyObject(double d, string type) {
     this->check_valid_type();
 }
 PyObject::PyObject(string s, string type) {
+    MemScope mem_scope(MEM_STR);
     this->s_value = s;
     this->type = type;
     this->check_valid_type();
@@ -84,25 +223,63 @@ PyObject::PyObject(bool b, string type) {
     this->type = type;
     this->check_valid_type();
 }
-// lists
+// lists and tuples, lists of numbers are stored unboxed
 PyObject::PyObject(vector<PyObject> li, string type) {
-    this->li_value = li;
+    MemScope mem_scope(MEM_LIST);
+    this->li_value = make_shared<PyList>(move(li), type == "list");
+    this->type = type;
+    this->check_valid_type();
+}
+PyObject::PyObject(PyList list, string type) {
+    MemScope mem_scope(MEM_LIST);
+    this->li_value = make_shared<PyList>(move(list));
     this->type = type;
     this->check_valid_type();
 }
 // dicts
-PyObject::PyObject(map<string, PyObject> m, string type) {
-    this->dict_value = m;
+PyObject::PyObject(PyDict dict, string type) {
+    MemScope mem_scope(MEM_DICT);
+    this->dict_value = make_shared<PyDict>(move(dict));
     this->type = type;
     this->check_valid_type();
 }
+// user defined functions, s_value holds the name for printing
 PyObject::PyObject(AST* function, string type) {
     this->func_value = function;
+    this->s_value = dynamic_cast<FunctionDef*>(function)->raw->name;
+    this->type = type;
+    this->check_valid_type();
+}
+// builtin functions, the Builtin lives as long as the program
+PyObject::PyObject(const Builtin* builtin, string type) {
+    this->builtin_value = builtin;
+    this->s_value = builtin->name;
+    this->type = type;
+    this->check_valid_type();
+}
+
+// exceptions, s_value holds the class name and li_value the args
+PyObject::PyObject(string name, vector<PyObject> args, string type) {
+    this->s_value = name;
+    this->li_value = make_shared<PyList>(move(args), false);
+    this->type = type;
+    this->check_valid_type();
+}
+
+// ranges
+PyObject::PyObject(PyRange range, string type) {
+    this->range_value = range;
     this->type = type;
     this->check_valid_type();
 }
 
-// sets - TODO:
+// sets and frozensets
+PyObject::PyObject(PySet set, string type) {
+    MemScope mem_scope(MEM_SET);
+    this->set_value = make_shared<PySet>(move(set));
+    this->type = type;
+    this->check_valid_type();
+}
 
 
 // ==============================================================
@@ -113,7 +290,10 @@ bool PyObject::is_valid_type(string type) {
            type == "int" || type == "float" ||
            type == "bool" || type == "list" ||
            type == "dict" || type == "tuple" ||
-           type == "class" || type == "function";
+           type == "class" || type == "function" ||
+           type == "builtin_function_or_method" || type == "range" ||
+           type == "type" || type == "exception" ||
+           type == "set" || type == "frozenset";
 }
 
 // NOTE: this method is mostly a spelling check atm
@@ -123,51 +303,131 @@ void PyObject::check_valid_type() {
     }
 }
 
-// returns value as string
+// returns value as string, str(x)
 string PyObject::as_string() const {
     if (this->type == "str") {
         return this->s_value;
+    }
+    Writer w;
+    this->write(w, false);
+    return move(w.buffer());
+}
+
+// repr(x), strings are quoted
+string PyObject::as_repr() const {
+    Writer w;
+    this->write(w, true);
+    return move(w.buffer());
+}
+
+// str(x) or repr(x) appended to w, items inside containers are always
+// written with repr like in Python
+void PyObject::write(Writer& w, bool repr) const {
+    if (this->type == "str") {
+        if (repr) write_quoted(w, this->s_value);
+        else w.write(this->s_value);
     } 
     else if (this->type == "float") {
-        return trim_trailing_zeros(to_string(this->f_value));
+        w.write(float_repr(this->f_value));
     }
     else if (this->type == "bool") {
-        return this->b_value ? "True" : "False";
+        if (this->b_value) w.write("True", 4);
+        else w.write("False", 5);
     }
     else if (this->type == "int") {
-        return to_string(this->i_value);
-    }
-    else if (this->type == "list") {
-        string s = "[";
-        if (this->li_value.size() == 1) {
-            s += this->li_value.front().as_string();
-        } else {
-            for (int i=0; i < this->li_value.size()-1; i++) {
-                s += this->li_value.at(i).as_string() + ", ";
-            }
-            s += this->li_value.back().as_string();
+        if (this->big_value != nullptr) {
+            w.write(this->big_value->to_string());
+            return;
+        }
+        char digits[24];
+        w.write(digits, to_chars(digits, digits + sizeof(digits), this->i_value).ptr - digits);
+    }
+    else if (this->type == "list" || this->type == "tuple") {
+        bool list = this->type == "list";
+        w.write(list ? '[' : '(');
+        PyObject item;
+        for (int i=0; i < this->li_value->size(); i++) {
+            if (i > 0) w.write(", ", 2);
+            this->li_value->get(i, item);
+            item.write(w, true);
         }
-        s += "]";
-        return s;
+        if (!list && this->li_value->size() == 1) w.write(',');
+        w.write(list ? ']' : ')');
     }
     else if (this->type == "None") {
-        return "None";
+        w.write("None", 4);
     }
-    else if (this->type == "tuple") {
-        string s = "(";
-        if (this->li_value.size() == 1) {
-            s += this->li_value.front().as_string() + ",";
-        } else {
-            for (int i=0; i < this->li_value.size()-1; i++) {
-                s += this->li_value.at(i).as_string() + ", ";
+    else if (this->type == "function") {
+        w.write("<function " + this->s_value + ">");
+    }
+    else if (this->type == "builtin_function_or_method") {
+        w.write("<built-in function " + this->s_value + ">");
+    }
+    else if (this->type == "range") {
+        w.write("range(" + to_string(this->range_value.start) + ", " 
+                + to_string(this->range_value.stop));
+        if (this->range_value.step != 1) {
+            w.write(", " + to_string(this->range_value.step));
+        }
+        w.write(')');
+    }
+    else if (this->type == "dict") {
+        w.write('{');
+        bool first = true;
+        for (const PyDict::Entry& e : this->dict_value->entries()) {
+            if (!first) w.write(", ", 2);
+            first = false;
+            e.key.write(w, true);
+            w.write(": ", 2);
+            e.value.write(w, true);
+        }
+        w.write('}');
+    }
+    else if (this->is_set()) {
+        if (this->set_value->size() == 0) {
+            w.write(this->type + "()");
+            return;
+        }
+        bool frozen = this->type == "frozenset";
+        if (frozen) w.write("frozenset(", 10);
+        w.write('{');
+        int idx = 0;
+        bool first = true;
+        PyObject item;
+        while (this->set_value->next(idx, item)) {
+            if (!first) w.write(", ", 2);
+            first = false;
+            item.write(w, true);
+        }
+        w.write('}');
+        if (frozen) w.write(')');
+    }
+    else if (this->type == "type") {
+        w.write("<class '" + this->s_value + "'>");
+    }
+    else if (this->type == "exception") {
+        // str(e) is the single argument, or the args tuple when there are more
+        if (repr) {
+            // ValueError('x')
+            w.write(this->s_value);
+            w.write('(');
+            for (int i=0; i < this->li_value->size(); i++) {
+                if (i > 0) w.write(", ", 2);
+                this->li_value->at(i).write(w, true);
             }
-            s += this->li_value.back().as_string();
+            w.write(')');
+        }
+        else if (this->li_value->size() == 1) {
+            // KeyError shows its key as repr, so KeyError('') is not blank
+            this->li_value->at(0).write(w, this->s_value == "KeyError");
         }
-        s += ")";
-        return s;
+        else if (this->li_value->size() > 1) {
+            PyObject(*this->li_value, "tuple").write(w, true);
+        }
+    }
+    else {
+        throw runtime_error("as_string() not defined for type " + this->type);
     }
-    // TODO: handle list and dict to strings
-    throw runtime_error("as_string() not defined for type " + this->type);
 }
 
 // returns value as bool
@@ -179,24 +439,43 @@ bool PyObject::as_bool() const {
         return this->s_value != "";
     }
     if (this->type == "int") {
-        return this->i_value != 0;
+        return this->big_value != nullptr || this->i_value != 0;
     }
     if (this->type == "float") {
         return this->f_value != 0;
     }
-    if (this->type == "list") {
-        return this->li_value.size() != 0;
+    if (this->type == "list" || this->type == "tuple") {
+        return this->li_value->size() != 0;
+    }
+    if (this->type == "range") {
+        return this->range_value.length() != 0;
+    }
+    if (this->type == "dict" || this->is_set()) {
+        return this->size() != 0;
+    }
+    if (this->type == "None") {
+        return false;
+    }
+    if (this->is_callable() || this->type == "exception") {
+        return true;
     }
     throw runtime_error("as_bool() not defined for type " + this->type);
 }
 
-vector<PyObject> PyObject::as_list() const {
-    if (this->type == "tuple" || this->type == "list" || this->type == "set") {
-        return this->li_value;
+const PyList& PyObject::as_list() const {
+    if (this->type == "tuple" || this->type == "list") {
+        return *this->li_value;
     }
     throw runtime_error("as_list() called on PyObject of type: \'" + this->type + "\'");
 }
 
+const PyRange& PyObject::as_range() const {
+    if (this->type == "range") {
+        return this->range_value;
+    }
+    throw runtime_error("as_range() called on PyObject of type: \'" + this->type + "\'");
+}
+
 AST* PyObject::get_function() const {
     if (this->type == "function") {
         return this->func_value;
@@ -204,44 +483,469 @@ AST* PyObject::get_function() const {
     throw runtime_error("get_function() called on PyObject of type: \'" + this->type + "\'");
 }
 
+const Builtin* PyObject::get_builtin() const {
+    if (this->type == "builtin_function_or_method") {
+        return this->builtin_value;
+    }
+    throw runtime_error("get_builtin() called on PyObject of type: \'" + this->type + "\'");
+}
+
+string PyObject::get_class_name() const {
+    if (this->type == "type" || this->type == "exception") {
+        return this->s_value;
+    }
+    return this->type;
+}
+
+string PyObject::get_name() const {
+    if (this->is_callable()) {
+        return this->s_value;
+    }
+    throw runtime_error("get_name() called on PyObject of type: \'" + this->type + "\'");
+}
+
+bool PyObject::is_callable() const {
+    return this->type == "function" || this->type == "builtin_function_or_method" 
+        || this->type == "type";
+}
+
 int PyObject::size() const {
     if (this->type == "bool") {
-        throw runtime_error("TypeError: object of type 'bool' has no len()");
+        throw PyException("TypeError", "object of type 'bool' has no len()");
     }
     if (this->type == "str") {
         return this->s_value.size();
     }
     if (this->type == "int") {
-        throw runtime_error("TypeError: object of type 'int' has no len()");
+        throw PyException("TypeError", "object of type 'int' has no len()");
     }
     if (this->type == "float") {
-        throw runtime_error("TypeError: object of type 'float' has no len()");
+        throw PyException("TypeError", "object of type 'float' has no len()");
     }
-    if (this->type == "list") {
-        return this->li_value.size();
+    if (this->type == "list" || this->type == "tuple") {
+        return this->li_value->size();
+    }
+    if (this->type == "dict") {
+        return this->dict_value->size();
+    }
+    if (this->is_set()) {
+        return this->set_value->size();
+    }
+    if (this->type == "range") {
+        uint64_t n = this->range_value.length();
+        if (n > INT_MAX) {
+            throw PyException("OverflowError", "Python int too large to convert to C ssize_t");
+        }
+        return n;
     }
     throw runtime_error("size() not defined for type " + this->type);
 }
 
 PyObject PyObject::at(int i) const {
     if (this->type == "bool") {
-        throw runtime_error("TypeError: 'bool' object is not subscriptable");
+        throw PyException("TypeError", "'bool' object is not subscriptable");
     }
     if (this->type == "str") {
-        return PyObject(this->s_value.at(i), "str");
+        return PyObject(string(1, this->s_value.at(i)), "str");
     }
     if (this->type == "int") {
-        throw runtime_error("TypeError: 'int' object is not subscriptable");
+        throw PyException("TypeError", "'int' object is not subscriptable");
     }
     if (this->type == "float") {
-        throw runtime_error("TypeError: 'float' object is not subscriptable");
+        throw PyException("TypeError", "'float' object is not subscriptable");
     }
-    if (this->type == "list") {
-        return PyObject(this->li_value.at(i));
+    if (this->type == "list" || this->type == "tuple") {
+        return this->li_value->at(i);
+    }
+    if (this->type == "range") {
+        if (i < 0 || i >= this->size()) {
+            throw PyException("IndexError", "range object index out of range");
+        }
+        return PyObject(this->range_value.item(i), "int");
     }
     throw runtime_error("at() not defined for type " + this->type);
 }
 
+// makes this an empty value of another type in place for iter_next()
+// and PyList::get(), the old payload goes so a loop variable that held
+// a list does not keep it alive or leak it into the new value
+void PyObject::reset_as(const char* type) {
+    this->type = type;
+    this->s_value = string();
+    this->big_value = nullptr;
+    this->li_value = nullptr;
+    this->dict_value = nullptr;
+    this->set_value = nullptr;
+    this->func_value = nullptr;
+    this->builtin_value = nullptr;
+}
+
+// iteration protocol for loops, the caller owns the position and out is
+// overwritten in place so a step never builds a temporary PyObject
+// returns false once idx is past the end
+bool PyObject::iter_next(int64_t& idx, PyObject& out) const {
+    if (this->type == "range") {
+        const PyRange& r = this->range_value;
+        // stepping past INT64_MAX or INT64_MIN is past stop as well
+        int64_t offset, value;
+        if (__builtin_mul_overflow(idx, r.step, &offset)
+            || __builtin_add_overflow(r.start, offset, &value)
+            || (r.step > 0 ? value >= r.stop : value <= r.stop)) {
+            return false;
+        }
+        if (out.type != "int") out.reset_as("int");
+        if (out.big_value != nullptr) out.big_value = nullptr;
+        out.i_value = value;
+        idx++;
+        return true;
+    }
+    if (this->type == "list" || this->type == "tuple") {
+        if (idx >= this->li_value->size()) {
+            return false;
+        }
+        this->li_value->get(idx, out);
+        idx++;
+        return true;
+    }
+    if (this->is_set()) {
+        // sets walk their table by slot, an int is enough
+        int slot = idx;
+        bool found = this->set_value->next(slot, out);
+        idx = slot;
+        return found;
+    }
+    if (this->type == "dict") {
+        // keys, in insertion order
+        if (idx >= this->dict_value->size()) {
+            return false;
+        }
+        out = this->dict_value->entries()[idx].key;
+        idx++;
+        return true;
+    }
+    if (this->type == "str") {
+        if (idx >= this->s_value.size()) {
+            return false;
+        }
+        if (out.type != "str") out.reset_as("str");
+        out.s_value.assign(1, this->s_value[idx]);
+        idx++;
+        return true;
+    }
+    throw PyException("TypeError", "'" + this->type + "' object is not iterable");
+}
+
+// subscripts, negative indexes count from the end
+int PyObject::normalize_index(const PyObject& key) const {
+    string name = this->type == "str" ? "string" : this->type;
+    if (key.type != "int" && key.type != "bool") {
+        throw PyException("TypeError", name + " indices must be integers or slices, not " 
+                                       + key.type);
+    }
+    int64_t i;
+    if (!key.as_int64(i)) {
+        throw PyException("IndexError", "cannot fit 'int' into an index-sized integer");
+    }
+    int n = this->size();
+    if (i < 0) i += n;
+    if (i < 0 || i >= n) {
+        throw PyException("IndexError", name + " index out of range");
+    }
+    return i;
+}
+
+PyObject PyObject::get_item(const PyObject& key) const {
+    if (this->type == "list" || this->type == "tuple") {
+        return this->li_value->at(this->normalize_index(key));
+    }
+    if (this->type == "str") {
+        return PyObject(string(1, this->s_value[this->normalize_index(key)]), "str");
+    }
+    if (this->type == "range") {
+        // indexed in 64 bits, normalize_index stops at an int's size
+        int64_t i;
+        if (key.type != "int" && key.type != "bool") {
+            throw PyException("TypeError", "range indices must be integers or slices, not " 
+                                           + key.type);
+        }
+        if (!key.as_int64(i)) {
+            throw PyException("IndexError", "cannot fit 'int' into an index-sized integer");
+        }
+        uint64_t n = this->range_value.length();
+        uint64_t u = i < 0 ? n - (0 - (uint64_t)i) : (uint64_t)i;
+        if (i < 0 ? (0 - (uint64_t)i) > n : u >= n) {
+            throw PyException("IndexError", "range object index out of range");
+        }
+        return PyObject(this->range_value.item(u), "int");
+    }
+    if (this->type == "dict") {
+        const PyObject* value = this->dict_value->find(key);
+        if (value == nullptr) {
+            throw PyException(new_exception("KeyError", PyObject(vector<PyObject>{key}, "tuple")));
+        }
+        return *value;
+    }
+    throw PyException("TypeError", "'" + this->type + "' object is not subscriptable");
+}
+
+void PyObject::set_item(const PyObject& key, PyObject value) {
+    MemScope mem_scope(payload_category(this->type));
+    if (this->type == "dict") {
+        this->dict_value->set(key, value);
+        return;
+    }
+    if (this->type == "list") {
+        this->li_value->set(this->normalize_index(key), value);
+        return;
+    }
+    this->item_ref(key) = value;
+}
+
+// the stored item itself, so 'x[i][j] = y' can reach the inner object
+// NOTE: a packed list has no PyObject to point at and gets boxed
+PyObject& PyObject::item_ref(const PyObject& key) {
+    if (this->type == "list") {
+        return this->li_value->ref(this->normalize_index(key));
+    }
+    if (this->type == "dict") {
+        PyObject* value = this->dict_value->find(key);
+        if (value == nullptr) {
+            throw PyException(new_exception("KeyError", PyObject(vector<PyObject>{key}, "tuple")));
+        }
+        return *value;
+    }
+    if (this->type == "str" || this->type == "tuple" || this->type == "range") {
+        throw PyException("TypeError", "'" + this->type 
+                                       + "' object does not support item assignment");
+    }
+    throw PyException("TypeError", "'" + this->type + "' object is not subscriptable");
+}
+
+// hash(x) for dict keys, keys that compare equal hash equal so 1, 1.0
+// and True all find the same entry
+size_t PyObject::hash() const {
+    if (this->type == "int") {
+        if (this->big_value != nullptr) return this->big_value->hash();
+        return std::hash<long>()(this->i_value);
+    }
+    if (this->type == "bool") {
+        return this->b_value;
+    }
+    if (this->type == "float") {
+        // an integral float hashes like the int it equals, inline or big
+        if (isfinite(this->f_value) && this->f_value == floor(this->f_value)) {
+            if (this->f_value >= -0x1p63 && this->f_value < 0x1p63) {
+                return std::hash<long>()((long)this->f_value);
+            }
+            return BigInt::from_double(this->f_value).hash();
+        }
+        return std::hash<double>()(this->f_value);
+    }
+    if (this->type == "str") {
+        return std::hash<string>()(this->s_value);
+    }
+    if (this->type == "None") {
+        return 0x9e3779b9;
+    }
+    if (this->type == "tuple") {
+        // the multiply and xor mix from CPython's old tuplehash
+        size_t h = 0x345678;
+        size_t mult = 1000003;
+        size_t n = this->li_value->size();
+        PyObject item;
+        for (int i=0; i < n; i++) {
+            this->li_value->get(i, item);
+            h = (h ^ item.hash()) * mult;
+            mult += 82520 + n + n;
+        }
+        return h + 97531;
+    }
+    if (this->type == "frozenset") {
+        // order independent, the same items in any table layout agree
+        size_t h = 1927868237UL * (this->set_value->size() + 1);
+        int idx = 0;
+        PyObject item;
+        while (this->set_value->next(idx, item)) {
+            size_t ih = item.hash();
+            h ^= (ih ^ (ih << 16) ^ 89869747UL) * 3644798167UL;
+        }
+        return h * 69069U + 907133923UL;
+    }
+    if (this->type == "function") {
+        return std::hash<AST*>()(this->func_value);
+    }
+    if (this->type == "builtin_function_or_method") {
+        return std::hash<string>()(this->s_value);
+    }
+    if (this->type == "type") {
+        return std::hash<string>()(this->s_value);
+    }
+    throw PyException("TypeError", "unhashable type: '" + this->type + "'");
+}
+
+// == for dict keys, numbers compare by value across int, float and bool
+bool PyObject::equals(const PyObject& p) const {
+    if (this->is_number() && p.is_number()) {
+        if (isnan(this->as_double()) || isnan(p.as_double())) return false;
+        return this->compare_numbers(p) == 0;
+    }
+    if (this->is_set() && p.is_set()) {
+        // set and frozenset compare by their items
+        if (this->size() != p.size()) return false;
+        int idx = 0;
+        PyObject item;
+        while (this->set_value->next(idx, item)) {
+            if (!p.set_value->contains(item)) return false;
+        }
+        return true;
+    }
+    if (this->type != p.type) {
+        return false;
+    }
+    if (this->type == "str" || this->type == "type" || this->type == "builtin_function_or_method") {
+        return this->s_value == p.s_value;
+    }
+    if (this->type == "None") {
+        return true;
+    }
+    if (this->type == "tuple" || this->type == "list") {
+        const PyList& a = *this->li_value;
+        const PyList& b = *p.li_value;
+        if (a.size() != b.size()) return false;
+        if (a.kind() == PyList::INTS && b.kind() == PyList::INTS) return a.ints() == b.ints();
+        if (a.kind() == PyList::FLOATS && b.kind() == PyList::FLOATS) return a.floats() == b.floats();
+        PyObject x, y;
+        for (int i=0; i < a.size(); i++) {
+            a.get(i, x);
+            b.get(i, y);
+            if (!x.equals(y)) return false;
+        }
+        return true;
+    }
+    if (this->type == "function") {
+        return this->func_value == p.func_value;
+    }
+    if (this->type == "range") {
+        return same_range(this->range_value, p.range_value);
+    }
+    return this->dict_value == p.dict_value;
+}
+
+void PyObject::set_keywords(PyDict keywords) {
+    this->dict_value = make_shared<PyDict>(move(keywords));
+}
+
+const PyDict* PyObject::keywords() const {
+    if (this->type != "tuple") {
+        return nullptr;
+    }
+    return this->dict_value.get();
+}
+
+bool PyObject::is_set() const {
+    return this->type == "set" || this->type == "frozenset";
+}
+
+// 'item in self'
+bool PyObject::contains(const PyObject& item) const {
+    if (this->is_set()) {
+        return this->set_value->contains(item);
+    }
+    if (this->type == "dict") {
+        return this->dict_value->find(item) != nullptr;
+    }
+    if (this->type == "list" || this->type == "tuple") {
+        const PyList& items = *this->li_value;
+        if (items.kind() == PyList::INTS && item.type == "int" && item.big_value == nullptr) {
+            return find(items.ints().begin(), items.ints().end(), item.i_value) != items.ints().end();
+        }
+        PyObject x;
+        for (int i=0; i < items.size(); i++) {
+            items.get(i, x);
+            if (x.equals(item)) return true;
+        }
+        return false;
+    }
+    if (this->type == "str") {
+        if (item.type != "str") {
+            throw PyException("TypeError", "'in <string>' requires string as left operand, not " 
+                                           + item.type);
+        }
+        return this->s_value.find(item.s_value) != string::npos;
+    }
+    if (this->type == "range") {
+        int64_t value;
+        if (!item.as_int64(value)) return false;
+        const PyRange& r = this->range_value;
+        if (r.step > 0 ? (value < r.start || value >= r.stop) : (value > r.start || value <= r.stop)) {
+            return false;
+        }
+        if (r.step > 0) return ((uint64_t)value - (uint64_t)r.start) % (uint64_t)r.step == 0;
+        return ((uint64_t)r.start - (uint64_t)value) % (0 - (uint64_t)r.step) == 0;
+    }
+    throw PyException("TypeError", "argument of type '" + this->type + "' is not iterable");
+}
+
+// augmented assignment that can reuse this object's storage, returns
+// false when the caller has to build a new value instead
+bool PyObject::inplace_op(const string& op, const PyObject& p) {
+    MemScope mem_scope(payload_category(this->type));
+    if (this->type == "list" && op == "+=") {
+        // list += any iterable extends, p can be this same list ('li += li')
+        if (p.type == "list" || p.type == "tuple") {
+            this->li_value->extend(*p.li_value);
+        } else {
+            int64_t idx = 0;
+            PyObject item;
+            while (p.iter_next(idx, item)) this->li_value->append(item);
+        }
+        return true;
+    }
+    if (this->type == "list" && op == "*=" && p.is_integer()) {
+        int64_t times;
+        if (!p.as_int64(times)) {
+            throw PyException("OverflowError", "cannot fit 'int' into an index-sized integer");
+        }
+        this->li_value->repeat(times);
+        return true;
+    }
+    if (this->type == "set" && p.is_set() && (op == "|=" || op == "-=")) {
+        // sets are mutable, 's |= t' updates every alias
+        int idx = 0;
+        PyObject item;
+        while (p.set_value->next(idx, item)) {
+            if (op == "|=") this->set_value->insert(item);
+            else this->set_value->erase(item);
+        }
+        return true;
+    }
+    if (this->type == "set" && p.is_set() && (op == "&=" || op == "^=")) {
+        PySet result = op == "&=" ? PySet::set_intersection(*this->set_value, *p.set_value)
+                                  : PySet::set_symmetric_difference(*this->set_value, *p.set_value);
+        *this->set_value = move(result);
+        return true;
+    }
+    if (this->type == "str" && op == "+=" && p.type == "str") {
+        // the local owns its string, append instead of concatenating
+        this->s_value.append(p.s_value);
+        return true;
+    }
+    if (this->type == "int" && p.type == "int" && this->big_value == nullptr && p.big_value == nullptr) {
+        // an overflow leaves this alone and the caller goes through BigInt
+        int64_t r;
+        if (op == "+=" && !__builtin_add_overflow(this->i_value, p.i_value, &r)) { this->i_value = r; return true; }
+        if (op == "-=" && !__builtin_sub_overflow(this->i_value, p.i_value, &r)) { this->i_value = r; return true; }
+        if (op == "*=" && !__builtin_mul_overflow(this->i_value, p.i_value, &r)) { this->i_value = r; return true; }
+    }
+    if (this->type == "float" && (p.type == "float" || p.type == "int")) {
+        double value = p.as_double();
+        if (op == "+=") { this->f_value += value; return true; }
+        if (op == "-=") { this->f_value -= value; return true; }
+        if (op == "*=") { this->f_value *= value; return true; }
+    }
+    return false;
+}
+
 // error function for undefined ops
 void PyObject::error_undefined(string op, string t1, string t2) const {
     throw runtime_error("undefined op \'" + op + "\' for \'" + t1 
@@ -250,19 +954,19 @@ void PyObject::error_undefined(string op, string t1, string t2) const {
 
 // error function for unsupported ops
 void PyObject::error_unsupported_op(string op, string t1, string t2) const {
-    throw runtime_error("\'" + op + "\' not supported between instances of \'" 
+    throw PyException("TypeError", "\'" + op + "\' not supported between instances of \'" 
             + t1 + "\' and \'" + t2 + "\'");
 }
 
 // error function for unsupported unary ops
 void PyObject::error_unsupported_unary_op(string op, string t1) const {
-    throw runtime_error("bad operand type for unary " + op + ": \'" + t1 + "\'");
+    throw PyException("TypeError", "bad operand type for unary " + op + ": \'" + t1 + "\'");
 }
 
 // error function for unsupported operands
 void PyObject::error_unsupported_operand(string op, string t1, string t2) const {
     // ex: unsupported operand type(s) for -: 'str' and 'str'
-    throw runtime_error("unsupported operand type(s) for " + op + 
+    throw PyException("TypeError", "unsupported operand type(s) for " + op + 
             ": \'" + t1 + "\' and \'" + t2 + "\'");
 }
 
@@ -284,100 +988,82 @@ void PyObject::error_unsupported_operand(string op, string t1, string t2) const
 // constructors then I'm prob fine to delete a ton of stuff
 
 PyObject PyObject::operator+(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " + " + p.type);
+    MemScope mem_scope(payload_category(this->type));
+    if (this->is_integer() && p.is_integer()) {
+        return this->int_arith('+', p);
+    }
+    if (this->is_number() && p.is_number()) {
+        return PyObject(this->as_double() + p.as_double(), "float");
+    }
     // if either are strings then concat as a new string
     if (this->type == "str" || p.type == "str") {
         string s = this->as_string() + p.as_string();
         return PyObject(s, "str");
     }
-    if (this->type == "float") {
-        if (p.type == "int") {
-            // float+int
-            return PyObject(this->f_value + p.i_value, "float");
-        }
-        if (p.type == "bool") {
-            // float+bool
-            return PyObject(this->f_value + p.b_value, "float");
-        }
-        // float+float
-        return PyObject(this->f_value + p.f_value, "float");
-    }
-    if (this->type == "int") {
-        if (p.type == "float") {
-            // int+float
-            return PyObject(this->i_value + p.f_value, "float");
-        }
-        if (p.type == "bool") {
-            // int+bool
-            return PyObject(this->i_value + p.b_value, "int");
-        }
-        // int+int
-        return PyObject(this->i_value + p.i_value, "int");
-    }
-    if (this->type == "bool") {
-        if (p.type == "int") {
-            // bool+int
-            return PyObject(this->b_value + p.i_value, "int");
-        }
-        if (p.type == "float") {
-            // bool+float
-            return PyObject(this->b_value + p.f_value, "float");
-        }
-        // bool+bool
-        return PyObject(this->b_value + p.b_value, "int");
+    // list+list and tuple+tuple
+    if ((this->type == "list" || this->type == "tuple") && p.type == this->type) {
+        PyList items = *this->li_value;
+        items.extend(*p.li_value);
+        return PyObject(move(items), this->type);
     }
     this->error_undefined("+", this->type, p.type);
     return PyObject();
 }
 
 PyObject PyObject::operator-(const PyObject& p) const {
-    // string-(any) or (any)-string
-    if (this->type == "str" || p.type == "str") {
-        this->error_unsupported_operand("-", this->type, p.type);
+    INSTRUMENT_DYNAMIC(this->type + " - " + p.type);
+    if (this->is_integer() && p.is_integer()) {
+        return this->int_arith('-', p);
     }
-    if (this->type == "float") {
-        if (p.type == "int") {
-            // float-int
-            return PyObject(this->f_value - p.i_value, "float");
-        }
-        if (p.type == "bool") {
-            // float-bool
-            return PyObject(this->f_value - p.b_value, "float");
-        }
-        // float-float
-        return PyObject(this->f_value - p.f_value, "float");
+    if (this->is_number() && p.is_number()) {
+        return PyObject(this->as_double() - p.as_double(), "float");
     }
-    if (this->type == "bool") {
-        if (p.type == "int") {
-            // bool-int
-            return PyObject(this->b_value - p.i_value, "int");
-        }
-        if (p.type == "float") {
-            // bool-float
-            return PyObject(this->b_value - p.f_value, "float");
-        }
-        // bool-bool
-        return PyObject(this->b_value - p.b_value, "int");
+    if (this->is_set() && p.is_set()) {
+        return PyObject(PySet::set_difference(*this->set_value, *p.set_value), this->type);
     }
-    if (this->type == "int") {
-        if (p.type == "float") {
-            // int-float
-            return PyObject(this->i_value - p.f_value, "float");
-        }
-        if (p.type == "bool") {
-            // int-bool
-            return PyObject(this->i_value - p.b_value, "int");
-        }
-        // int-int
-        return PyObject(this->i_value - p.i_value, "int");
+    // string-(any) or (any)-string
+    if (this->type == "str" || p.type == "str") {
+        this->error_unsupported_operand("-", this->type, p.type);
     }
     this->error_undefined("-", this->type, p.type);
     return PyObject();
 }
 
 PyObject PyObject::operator*(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " * " + p.type);
+    MemScope mem_scope(payload_category(this->type));
+    if (this->is_integer() && p.is_integer()) {
+        return this->int_arith('*', p);
+    }
+    if (this->is_number() && p.is_number()) {
+        return PyObject(this->as_double() * p.as_double(), "float");
+    }
     // string*string
     if (this->type == "str" && p.type == "str") {
-        throw runtime_error("can't multiply sequence by non-int of type " + p.type);
+        throw PyException("TypeError", "can't multiply sequence by non-int of type \'" + p.type + "\'");
+    }
+    // list*int and int*list, packed lists repeat the raw numbers
+    if ((this->type == "list" || this->type == "tuple") && p.is_integer()) {
+        int64_t amt;
+        if (!p.as_int64(amt)) {
+            throw PyException("OverflowError", "cannot fit 'int' into an index-sized integer");
+        }
+        PyList items = *this->li_value;
+        items.repeat(amt);
+        return PyObject(move(items), this->type);
+    }
+    if ((p.type == "list" || p.type == "tuple") && this->is_integer()) {
+        return p * *this;
+    }
+    // string*int or int*string
+    if ((this->type == "str" && p.is_integer()) || (this->is_integer() && p.type == "str")) {
+        const PyObject& s = this->type == "str" ? *this : p;
+        int64_t amt;
+        if (!(this->type == "str" ? p : *this).as_int64(amt)) {
+            throw PyException("OverflowError", "cannot fit 'int' into an index-sized integer");
+        }
+        return PyObject(string_mul(s.s_value, amt), "str");
     }
     // string*float or float*string
     if ( (this->type == "str" && p.type == "float") ||
@@ -394,152 +1080,94 @@ PyObject PyObject::operator*(const PyObject& p) const {
         }
         return PyObject(string_mul(s, amt), "str");
     }
-    if (this->type == "float") {
-        if (p.type == "int") {
-            // float*int
-            return PyObject(this->f_value * p.i_value, "float");
-        }
-        if (p.type == "bool") {
-            // float*bool
-            return PyObject(this->f_value * p.b_value, "float");
-        }
-        // float*float
-        return PyObject(this->f_value * p.f_value, "float");
-    }
-    if (this->type == "bool") {
-        if (p.type == "int") {
-            // bool*int
-            return PyObject(this->b_value * p.i_value, "int");
-        }
-        if (p.type == "float") {
-            // bool*float
-            return PyObject(this->b_value * p.f_value, "float");
-        }
-        // bool*bool
-        return PyObject(this->b_value * p.b_value, "bool");
-    }
-    if (this->type == "int") {
-        if (p.type == "float") {
-            // int*float
-            return PyObject(this->i_value * p.f_value, "float");
-        }
-        if (p.type == "bool") {
-            // int*bool
-            return PyObject(this->i_value * p.b_value, "int");
-        }
-        // int*int
-        return PyObject(this->i_value * p.i_value, "int");
-    }
     this->error_undefined("*", this->type, p.type);
     return PyObject();
 }
 
 PyObject PyObject::operator/(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " / " + p.type);
     // string/(any) or (any)/string
     if (this->type == "str" || p.type == "str") {
         this->error_unsupported_operand("/", this->type, p.type);
     }
-    if (this->type == "float") {
-        if (p.type == "int") {
-            // float/int
-            return PyObject(this->f_value / p.i_value, "float");
-        }
-        if (p.type == "bool") {
-            // float/bool
-            return PyObject(this->f_value / p.b_value, "float");
-        }
-        // float/float
-        return PyObject(this->f_value / p.f_value, "float");
-    }
-    if (this->type == "bool") {
-        if (p.type == "int") {
-            // bool/int
-            return PyObject(this->b_value / p.i_value, "float");
-        }
-        if (p.type == "float") {
-            // bool/float
-            return PyObject(this->b_value / p.f_value, "float");
-        }
-        // bool/bool
-        return PyObject(this->b_value / p.b_value, "float");
-    }
-    if (this->type == "int") {
-        if (p.type == "float") {
-            // int/float
-            return PyObject(this->i_value / p.f_value, "float");
+    if (this->is_number() && p.is_number()) {
+        double divisor = p.as_double();
+        if (divisor == 0) {
+            throw PyException("ZeroDivisionError", "division by zero");
         }
-        if (p.type == "bool") {
-            // int/bool
-            return PyObject(this->i_value / p.b_value, "float");
-        }
-        // int/int
-        return PyObject(this->i_value / p.i_value, "float");
+        return PyObject(this->as_double() / divisor, "float");
     }
     this->error_undefined("/", this->type, p.type);
     return PyObject();
 }
 
 PyObject PyObject::operator%(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " % " + p.type);
     // NOTE/TODO: % works like a format string
     // >>> "%s %s" % ("Hello", "World")
     // 'Hello World'
 
-    if (this->type == "float") {
-        if (p.type == "int") {
-            // float%int
-            return PyObject(fmod(this->f_value, p.i_value), "float");
-        }
-        if (p.type == "bool") {
-            // float%bool
-            return PyObject(fmod(this->f_value,  p.b_value), "float");
+    if (this->is_integer() && p.is_integer()) {
+        return this->int_arith('%', p);
+    }
+    if (this->is_number() && p.is_number()) {
+        double a = this->as_double();
+        double b = p.as_double();
+        if (b == 0) {
+            throw PyException("ZeroDivisionError", "float modulo");
         }
-        // float%float
-        return PyObject(fmod(this->f_value, p.f_value), "float");
+        // the result takes the sign of the divisor like in Python
+        double m = fmod(a, b);
+        if (m != 0 && (m < 0) != (b < 0)) m += b;
+        return PyObject(m, "float");
     }
-    if (this->type == "bool") {
-        if (p.type == "int") {
-            // bool%int
-            return PyObject((int)(this->b_value % p.i_value), "int");
-        }
-        if (p.type == "float") {
-            // bool%float
-            return PyObject(fmod(this->b_value, p.f_value), "float");
-        }
-        // bool%bool
-        return PyObject((int)(this->b_value % p.b_value), "int");
-    }
-    if (this->type == "int") {
-        if (p.type == "float") {
-            // int%float
-            return PyObject(fmod(this->i_value, p.f_value), "float");
-        }
-        if (p.type == "bool") {
-            // int%bool
-            return PyObject((int)(this->i_value % p.b_value), "int");
+    this->error_undefined("%", this->type, p.type);
+    return PyObject();
+}
+
+// a // b, floored for ints and floats
+PyObject PyObject::floordiv(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " // " + p.type);
+    if (this->is_integer() && p.is_integer()) {
+        return this->int_arith('/', p);
+    }
+    if (this->is_number() && p.is_number()) {
+        double b = p.as_double();
+        if (b == 0) {
+            throw PyException("ZeroDivisionError", "float floor division by zero");
         }
-        // int%int
-        return PyObject((int)(this->i_value % p.i_value), "int");
+        return PyObject(floor(this->as_double() / b), "float");
     }
-    this->error_undefined("%", this->type, p.type);
+    this->error_unsupported_operand("//", this->type, p.type);
     return PyObject();
 }
 
 PyObject PyObject::operator==(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " == " + p.type);
+    if (this->is_number() && p.is_number()) {
+        return PyObject(this->equals(p), "bool");
+    }
+    if ((this->is_set() && p.is_set()) || (this->type == p.type && (this->type == "list" || this->type == "tuple"))) {
+        return PyObject(this->equals(p), "bool");
+    }
     if (this->type != p.type) {
         return PyObject(false, "bool");
     }
     if (this->type == "str") {
         return PyObject(this->s_value == p.s_value, "bool");
     }
-    if (this->type == "float" || this->type == "bool") {
-        return PyObject(this->as_bool() == p.as_bool(), "bool");
-    }
-    if (this->type == "int") {
-        return PyObject(this->i_value == p.i_value, "bool");
-    }
     if (this->type == "None") {
         return PyObject(this->type == p.type, "bool");
     }
+    if (this->type == "function") {
+        return PyObject(this->func_value == p.func_value, "bool");
+    }
+    if (this->type == "builtin_function_or_method") {
+        return PyObject(this->builtin_value == p.builtin_value, "bool");
+    }
+    if (this->type == "range") {
+        return PyObject(same_range(this->range_value, p.range_value), "bool");
+    }
     // TODO: implement list and dict
 
     this->error_undefined("==", this->type, p.type);
@@ -547,21 +1175,31 @@ PyObject PyObject::operator==(const PyObject& p) const {
 }
 
 PyObject PyObject::operator!=(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " != " + p.type);
+    if (this->is_number() && p.is_number()) {
+        return PyObject(!this->equals(p), "bool");
+    }
+    if ((this->is_set() && p.is_set()) || (this->type == p.type && (this->type == "list" || this->type == "tuple"))) {
+        return PyObject(!this->equals(p), "bool");
+    }
     if (this->type != p.type) {
         return PyObject(true, "bool");
     }
     if (this->type == "str") {
         return PyObject(this->s_value != p.s_value, "bool");
     }
-    if (this->type == "float" || this->type == "bool") {
-        return PyObject(this->as_bool() != p.as_bool(), "bool");
-    }
-    if (this->type == "int") {
-        return PyObject(this->i_value != p.i_value, "bool");
-    }
     if (this->type == "None") {
         return PyObject(this->type != p.type, "bool");
     }
+    if (this->type == "function") {
+        return PyObject(this->func_value != p.func_value, "bool");
+    }
+    if (this->type == "builtin_function_or_method") {
+        return PyObject(this->builtin_value != p.builtin_value, "bool");
+    }
+    if (this->type == "range") {
+        return PyObject(!same_range(this->range_value, p.range_value), "bool");
+    }
     // TODO: implement list and dict
 
     this->error_undefined("!=", this->type, p.type);
@@ -569,6 +1207,10 @@ PyObject PyObject::operator!=(const PyObject& p) const {
 }
 
 PyObject PyObject::operator<=(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " <= " + p.type);
+    if (this->is_number() && p.is_number()) {
+        return PyObject(this->compare_numbers(p) <= 0, "bool");
+    }
     if ( (this->type == "str" && p.type != "str") || 
          (this->type != "str" && p.type == "str") ) {
         this->error_unsupported_op("<=", this->type, p.type);
@@ -577,12 +1219,6 @@ PyObject PyObject::operator<=(const PyObject& p) const {
     if (this->type == "str" && p.type == "str") {  
         return PyObject(this->s_value <= p.s_value, "bool");
     }
-    if (this->type == "float" || this->type == "bool") {
-        return PyObject(this->as_bool() <= p.as_bool(), "bool");
-    }
-    if (this->type == "int") {
-        return PyObject(this->i_value <= p.i_value, "bool");
-    }
     // TODO: implement list and dict
 
     this->error_undefined("<=", this->type, p.type);
@@ -590,6 +1226,10 @@ PyObject PyObject::operator<=(const PyObject& p) const {
 }
 
 PyObject PyObject::operator<(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " < " + p.type);
+    if (this->is_number() && p.is_number()) {
+        return PyObject(this->compare_numbers(p) < 0, "bool");
+    }
     if ( (this->type == "str" && p.type != "str") || 
          (this->type != "str" && p.type == "str") ) {
         this->error_unsupported_op("<", this->type, p.type);
@@ -598,12 +1238,6 @@ PyObject PyObject::operator<(const PyObject& p) const {
     if (this->type == "str" && p.type == "str") {  
         return PyObject(this->s_value < p.s_value, "bool");
     }
-    if (this->type == "float" || this->type == "bool") {
-        return PyObject(this->as_bool() < p.as_bool(), "bool");
-    }
-    if (this->type == "int") {
-        return PyObject(this->i_value < p.i_value, "bool");
-    }
     // TODO: implement list and dict
     
     this->error_undefined("<", this->type, p.type);
@@ -611,6 +1245,10 @@ PyObject PyObject::operator<(const PyObject& p) const {
 }
 
 PyObject PyObject::operator>=(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " >= " + p.type);
+    if (this->is_number() && p.is_number()) {
+        return PyObject(this->compare_numbers(p) >= 0, "bool");
+    }
     if ( (this->type == "str" && p.type != "str") || 
          (this->type != "str" && p.type == "str") ) {
         this->error_unsupported_op(">=", this->type, p.type);
@@ -619,12 +1257,6 @@ PyObject PyObject::operator>=(const PyObject& p) const {
     if (this->type == "str" && p.type == "str") {  
         return PyObject(this->s_value >= p.s_value, "bool");
     }
-    if (this->type == "float" || this->type == "bool") {
-        return PyObject(this->as_bool() >= p.as_bool(), "bool");
-    }
-    if (this->type == "int") {
-        return PyObject(this->i_value >= p.i_value, "bool");
-    }
     // TODO: implement list and dict
     
     this->error_undefined(">=", this->type, p.type);
@@ -632,6 +1264,10 @@ PyObject PyObject::operator>=(const PyObject& p) const {
 }
 
 PyObject PyObject::operator>(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " > " + p.type);
+    if (this->is_number() && p.is_number()) {
+        return PyObject(this->compare_numbers(p) > 0, "bool");
+    }
     if ( (this->type == "str" && p.type != "str") || 
          (this->type != "str" && p.type == "str") ) {
         this->error_unsupported_op(">", this->type, p.type);
@@ -640,30 +1276,288 @@ PyObject PyObject::operator>(const PyObject& p) const {
     if (this->type == "str" && p.type == "str") {  
         return PyObject(this->s_value > p.s_value, "bool");
     }
-    if (this->type == "float" || this->type == "bool") {
-        return PyObject(this->as_bool() > p.as_bool(), "bool");
-    }
-    if (this->type == "int") {
-        return PyObject(this->i_value > p.i_value, "bool");
-    }
     // TODO: implement list and dict
     
     this->error_undefined(">", this->type, p.type);
     return PyObject();
 }
 
-PyObject PyObject::operator~() {
-    if (this->type != "int") {
+// | & ^ are integer bitwise ops, or union, intersection and symmetric
+// difference for sets (the result has the left operand's type)
+PyObject PyObject::operator|(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " | " + p.type);
+    if (this->is_set() && p.is_set()) {
+        return PyObject(PySet::set_union(*this->set_value, *p.set_value), this->type);
+    }
+    if (this->is_integer() && p.is_integer()) {
+        return this->int_bitwise('|', p);
+    }
+    this->error_unsupported_operand("|", this->type, p.type);
+    return PyObject();
+}
+
+PyObject PyObject::operator&(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " & " + p.type);
+    if (this->is_set() && p.is_set()) {
+        return PyObject(PySet::set_intersection(*this->set_value, *p.set_value), this->type);
+    }
+    if (this->is_integer() && p.is_integer()) {
+        return this->int_bitwise('&', p);
+    }
+    this->error_unsupported_operand("&", this->type, p.type);
+    return PyObject();
+}
+
+PyObject PyObject::operator^(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " ^ " + p.type);
+    if (this->is_set() && p.is_set()) {
+        return PyObject(PySet::set_symmetric_difference(*this->set_value, *p.set_value), this->type);
+    }
+    if (this->is_integer() && p.is_integer()) {
+        return this->int_bitwise('^', p);
+    }
+    this->error_unsupported_operand("^", this->type, p.type);
+    return PyObject();
+}
+
+// a negative count is an error like in Python
+PyObject PyObject::operator<<(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " << " + p.type);
+    if (!this->is_integer() || !p.is_integer()) {
+        this->error_unsupported_operand("<<", this->type, p.type);
+    }
+    int64_t n;
+    if (!p.as_int64(n)) {
+        throw PyException("OverflowError", "too many digits in integer");
+    }
+    if (n < 0) {
+        throw PyException("ValueError", "negative shift count");
+    }
+    if (this->big_value == nullptr) {
+        // stays inline while the shift leaves a copy of the sign bit
+        int64_t a = this->small_int();
+        uint64_t bits = a < 0 ? ~a : a;
+        int free = bits == 0 ? 64 : __builtin_clzll(bits);
+        if (n < free) {
+            return PyObject((int64_t)((uint64_t)a << n), "int");
+        }
+    }
+    return PyObject(this->to_bigint() << n, "int");
+}
+
+PyObject PyObject::operator>>(const PyObject& p) const {
+    INSTRUMENT_DYNAMIC(this->type + " >> " + p.type);
+    if (!this->is_integer() || !p.is_integer()) {
+        this->error_unsupported_operand(">>", this->type, p.type);
+    }
+    bool negative = this->big_value != nullptr ? this->big_value->is_negative() 
+                                               : this->small_int() < 0;
+    int64_t n;
+    if (!p.as_int64(n)) {
+        // every bit is shifted out
+        if (p.big_value->is_negative()) throw PyException("ValueError", "negative shift count");
+        return PyObject(negative ? -1 : 0, "int");
+    }
+    if (n < 0) {
+        throw PyException("ValueError", "negative shift count");
+    }
+    if (this->big_value == nullptr) {
+        if (n >= 64) return PyObject(negative ? -1 : 0, "int");
+        return PyObject(this->small_int() >> n, "int");  // arithmetic, floors
+    }
+    return PyObject(*this->big_value >> n, "int");
+}
+
+PyObject PyObject::operator-() const {
+    INSTRUMENT_DYNAMIC("-" + this->type);
+    if (this->type == "float") {
+        return PyObject(-this->f_value, "float");
+    }
+    if (this->is_integer()) {
+        if (this->big_value == nullptr && this->small_int() != INT64_MIN) {
+            return PyObject(-this->small_int(), "int");
+        }
+        return PyObject(-this->to_bigint(), "int");
+    }
+    this->error_unsupported_unary_op("-", this->type);
+    return PyObject();
+}
+
+PyObject PyObject::operator~() const {
+    INSTRUMENT_DYNAMIC("~" + this->type);
+    if (!this->is_integer()) {
         this->error_unsupported_unary_op("~", this->type);
     }
-    return PyObject(~((int)(*this)), "int");
+    if (this->big_value == nullptr) {
+        return PyObject(~this->small_int(), "int");
+    }
+    return PyObject(-this->to_bigint() - BigInt(1), "int");
 }
 
+// int ** int stays exact, squaring inline until a step overflows and
+// finishing with BigInts. A negative exponent gives a float
 PyObject PyObject::_pow(PyObject p) {
-    if (this->type == "int" && p.type == "int") {
-        return PyObject((int)pow((int)*this, (int)p), "int");
+    INSTRUMENT_DYNAMIC(this->type + " ** " + p.type);
+    if (this->is_integer() && p.is_integer()) {
+        int64_t exp;
+        int64_t base;
+        if (!p.as_int64(exp) && !p.big_value->is_negative()) {
+            // only 0, 1 and -1 have a power this large that fits in memory
+            if (!this->as_int64(base) || base < -1 || base > 1) {
+                throw PyException("OverflowError", "exponent too large");
+            }
+            bool odd = !p.to_bigint().bitwise(BigInt(1), '&').is_zero();
+            return PyObject(base == -1 && !odd ? 1 : base, "int");
+        }
+        if (exp >= 0 && this->as_int64(base)) {
+            int64_t result = 1;
+            bool overflow = false;
+            for (uint64_t k=exp; k != 0 && !overflow; ) {
+                if (k & 1) overflow |= __builtin_mul_overflow(result, base, &result);
+                k >>= 1;
+                if (k != 0) overflow |= __builtin_mul_overflow(base, base, &base);
+            }
+            if (!overflow) {
+                return PyObject(result, "int");
+            }
+        }
+        if (exp >= 0) {
+            return PyObject(this->to_bigint().pow(exp), "int");
+        }
+    }
+    if (this->is_number() && p.is_number()) {
+        double base = this->as_double();
+        double exp = p.as_double();
+        if (base == 0 && exp < 0) {
+            throw PyException("ZeroDivisionError", "0.0 cannot be raised to a negative power");
+        }
+        return PyObject(pow(base, exp), "float");
+    }
+    this->error_unsupported_operand("** or pow()", this->type, p.type);
+    return PyObject();
+}
+
+// ==============================================================
+// ints
+
+bool PyObject::is_integer() const {
+    return this->type == "int" || this->type == "bool";
+}
+
+bool PyObject::is_number() const {
+    return this->type == "int" || this->type == "float" || this->type == "bool";
+}
+
+// an inline int or a bool, bools act as 0 and 1
+int64_t PyObject::small_int() const {
+    return this->type == "bool" ? this->b_value : this->i_value;
+}
+
+BigInt PyObject::to_bigint() const {
+    if (this->big_value != nullptr) {
+        return *this->big_value;
+    }
+    return BigInt(this->small_int());
+}
+
+double PyObject::as_double() const {
+    if (this->type == "float") {
+        return this->f_value;
+    }
+    if (this->big_value != nullptr) {
+        return this->big_value->to_double();
+    }
+    return this->small_int();
+}
+
+// false for anything that is not an int or does not fit in 64 bits
+bool PyObject::as_int64(int64_t& out) const {
+    if (!this->is_integer() || this->big_value != nullptr) {
+        return false;
     }
-    return PyObject((float)pow((float)*this, (float)p), "float"); 
+    out = this->small_int();
+    return true;
+}
+
+// + - * // % for ints, op '/' is floor division here. Done inline with
+// checked 64 bit arithmetic, and redone with BigInts only when the
+// result does not fit
+PyObject PyObject::int_arith(char op, const PyObject& p) const {
+    if (this->big_value == nullptr && p.big_value == nullptr) {
+        int64_t a = this->small_int();
+        int64_t b = p.small_int();
+        int64_t r;
+        if (op == '+' && !__builtin_add_overflow(a, b, &r)) return PyObject(r, "int");
+        if (op == '-' && !__builtin_sub_overflow(a, b, &r)) return PyObject(r, "int");
+        if (op == '*' && !__builtin_mul_overflow(a, b, &r)) return PyObject(r, "int");
+        if ((op == '/' || op == '%') && b != 0 && !(a == INT64_MIN && b == -1)) {
+            // C++ truncates, Python floors so the remainder takes the divisor's sign
+            int64_t q = a / b;
+            int64_t m = a % b;
+            if (m != 0 && (m < 0) != (b < 0)) {
+                q--;
+                m += b;
+            }
+            return PyObject(op == '/' ? q : m, "int");
+        }
+    }
+    BigInt a = this->to_bigint();
+    BigInt b = p.to_bigint();
+    if (op == '+') return PyObject(a + b, "int");
+    if (op == '-') return PyObject(a - b, "int");
+    if (op == '*') return PyObject(a * b, "int");
+    if (b.is_zero()) {
+        throw PyException("ZeroDivisionError", "integer division or modulo by zero");
+    }
+    BigInt q, m;
+    BigInt::divmod(a, b, q, m);
+    return PyObject(op == '/' ? q : m, "int");
+}
+
+PyObject PyObject::int_bitwise(char op, const PyObject& p) const {
+    if (this->big_value == nullptr && p.big_value == nullptr) {
+        int64_t a = this->small_int();
+        int64_t b = p.small_int();
+        return PyObject(op == '&' ? a & b : op == '|' ? a | b : a ^ b, "int");
+    }
+    return PyObject(this->to_bigint().bitwise(p.to_bigint(), op), "int");
+}
+
+// <0, 0 or >0, ints compare exactly, two floats as doubles
+int PyObject::compare_numbers(const PyObject& p) const {
+    if (this->is_integer() && p.is_integer()) {
+        if (this->big_value == nullptr && p.big_value == nullptr) {
+            int64_t a = this->small_int();
+            int64_t b = p.small_int();
+            return (a > b) - (a < b);
+        }
+        return this->to_bigint().compare(p.to_bigint());
+    }
+    if (this->is_integer()) return -p.compare_int_float(*this);
+    if (p.is_integer()) return this->compare_int_float(p);
+    double a = this->as_double();
+    double b = p.as_double();
+    return (a > b) - (a < b);
+}
+
+// this is a float and i an int. Converting i to a double rounds past
+// 2**53, so the float's integral part becomes an int instead and the
+// two compare exactly, the fraction only breaks a tie
+int PyObject::compare_int_float(const PyObject& i) const {
+    double f = this->f_value;
+    if (isnan(f)) return 0;
+    if (isinf(f)) return f > 0 ? 1 : -1;
+    double whole = floor(f);
+    int c;
+    if (whole >= -0x1p63 && whole < 0x1p63 && i.big_value == nullptr) {
+        int64_t a = (int64_t)whole;
+        int64_t b = i.small_int();
+        c = (a > b) - (a < b);
+    } else {
+        c = BigInt::from_double(whole).compare(i.to_bigint());
+    }
+    if (c != 0) return c;
+    return f > whole ? 1 : 0;
 }
 
 ostream& operator<<(ostream& os, const PyObject& s) {
@@ -685,21 +1579,21 @@ PyObject::operator int() {
     if (this->type == "bool") {
         return this->b_value ? 1 : 0;
     }
+    if (this->big_value != nullptr || this->i_value < INT32_MIN || this->i_value > INT32_MAX) {
+        throw PyException("OverflowError", "Python int too large to convert to C int");
+    }
     return this->i_value;
 }
 
-PyObject::operator float() {
-    if (this->type == "int") {
-        return this->i_value;
-    }
-    if (this->type == "bool") {
-        return this->b_value ? 1.0 : 0.0;
-    }
-    return this->f_value;
+PyObject::operator double() {
+    return this->as_double();
 }
 
 PyObject::operator long() {
     if (this->type == "int") {
+        if (this->big_value != nullptr) {
+            throw PyException("OverflowError", "Python int too large to convert to C long");
+        }
         return this->i_value;
     }
     if (this->type == "bool") {
@@ -713,9 +1607,7 @@ PyObject::operator bool() {
 }
 
 PyObject::operator vector<PyObject>() {
-    return this->li_value;
+    return this->li_value->items();
 }
 
-PyObject::operator map<string, PyObject>() {
-    return this->dict_value;
-}
+
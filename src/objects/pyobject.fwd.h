@@ -2,3 +2,10 @@
 
 #pragma once
 class PyObject;
+class PyDict;
+struct Builtin;
+
+// builtin functions are plain function pointers, see builtins.cpp. The
+// positional arguments are a span, args[0] to args[nargs-1], and keywords
+// is nullptr unless the call had some
+typedef PyObject (*FnPtr)(const PyObject* args, int nargs, const PyDict* keywords);
@@ -9,40 +9,104 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <cstdint>
 using namespace std;
 
+class PyDict;
+class PySet;
+class PyList;
+class BigInt;
+class Writer;
+
+// range(start, stop, step), never materialized into a list
+struct PyRange {
+    int64_t start;
+    int64_t stop;
+    int64_t step;
+
+    // can be past INT64_MAX, range(-2**63, 2**63 - 1) has 2**64 - 1 items
+    uint64_t length() const;
+    // the i-th value, i must be below length()
+    int64_t item(uint64_t i) const;
+};
+
 class PyObject {
 private:
     string s_value;
-    int i_value;
-    float f_value;
+    int64_t i_value;
+    shared_ptr<BigInt> big_value;  // only for ints that do not fit i_value
+    double f_value;
     bool b_value;
-    vector<PyObject> li_value;
-    map<string, PyObject> dict_value;
+    // containers live on the heap and copies share them, so assigning or
+    // passing a list aliases it like in Python and costs a refcount bump
+    shared_ptr<PyList> li_value;
+    shared_ptr<PyDict> dict_value;  // also a call's keyword arguments, see keywords()
+    shared_ptr<PySet> set_value;
     void* class_value;  // TODO: when implementing classes
     AST* func_value;
+    const Builtin* builtin_value;
+    PyRange range_value;
 
     bool is_valid_type(string type);
     void check_valid_type();
+    int normalize_index(const PyObject& key) const;
+    int64_t small_int() const;
+    BigInt to_bigint() const;
+    PyObject int_arith(char op, const PyObject& p) const;
+    PyObject int_bitwise(char op, const PyObject& p) const;
+    int compare_numbers(const PyObject& p) const;
+    int compare_int_float(const PyObject& i) const;
+    void reset_as(const char* type);
 public:
     string type;
 
     PyObject();
     PyObject(int i, string type);
+    PyObject(int64_t i, string type);
+    PyObject(BigInt big, string type);
     PyObject(float d, string type);
     PyObject(double d, string type);
     PyObject(string s, string type);
     PyObject(bool b, string type);
     PyObject(vector<PyObject> li, string type);
-    PyObject(map<string, PyObject> m, string type);
+    PyObject(PyList list, string type);
+    PyObject(PyDict dict, string type);
+    PyObject(PySet set, string type);
     PyObject(AST* function, string type);
+    PyObject(const Builtin* builtin, string type);
+    PyObject(string name, vector<PyObject> args, string type);
+    PyObject(PyRange range, string type);
 
     string as_string() const;
+    string as_repr() const;
+    void write(Writer& w, bool repr) const;
     bool as_bool() const;
-    vector<PyObject> as_list() const;
+    double as_double() const;
+    bool as_int64(int64_t& out) const;
+    const PyList& as_list() const;
+    const PyRange& as_range() const;
     AST* get_function() const;
+    const Builtin* get_builtin() const;
+    string get_class_name() const;
+    string get_name() const;  // of a function, builtin or class
+    bool is_callable() const;
     int size() const;
     PyObject at(int i) const;
+    bool iter_next(int64_t& idx, PyObject& out) const;
+    PyObject get_item(const PyObject& key) const;
+    void set_item(const PyObject& key, PyObject value);
+    PyObject& item_ref(const PyObject& key);
+    bool inplace_op(const string& op, const PyObject& p);
+    // a call's arguments are a tuple, keyword arguments ride along with it
+    void set_keywords(PyDict keywords);
+    const PyDict* keywords() const;  // nullptr when there are none
+    size_t hash() const;
+    bool equals(const PyObject& p) const;
+    bool contains(const PyObject& item) const;
+    bool is_set() const;
+    bool is_integer() const;
+    bool is_number() const;
     void error_undefined(string op, string t1, string t2) const;
     void error_unsupported_op(string op, string t1, string t2) const;
     void error_unsupported_unary_op(string op, string t1) const;
@@ -50,27 +114,34 @@ public:
 
     PyObject operator+(const PyObject& p) const;
     PyObject operator-(const PyObject& p) const;
+    PyObject operator|(const PyObject& p) const;
+    PyObject operator&(const PyObject& p) const;
+    PyObject operator^(const PyObject& p) const;
     PyObject operator*(const PyObject& p) const;
     PyObject operator/(const PyObject& p) const;
     PyObject operator%(const PyObject& p) const;
+    PyObject floordiv(const PyObject& p) const;
+    PyObject operator<<(const PyObject& p) const;
+    PyObject operator>>(const PyObject& p) const;
     PyObject operator==(const PyObject& p) const;
     PyObject operator!=(const PyObject& p) const;
     PyObject operator<=(const PyObject& p) const;
     PyObject operator<(const PyObject& p) const;
     PyObject operator>=(const PyObject& p) const;
     PyObject operator>(const PyObject& p) const;
-    PyObject operator~();
+    PyObject operator-() const;
+    PyObject operator~() const;
     PyObject _pow(PyObject p);
 
     friend ostream& operator<<(ostream& os, const PyObject& s);
+    friend class PyList;  // packs and unboxes numbers without the constructors
     
     operator string();
     operator int();
-    operator float();
+    operator double();
     operator long();
     operator bool();
     operator vector<PyObject>();
-    operator map<string, PyObject>();
 };
 
 
@@ -0,0 +1,230 @@
+#include <string>
+#include <vector>
+#include "pyset.h"
+#include "pyobject.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+using namespace std;
+
+
+PySet::PySet() {
+    this->used = 0;
+    this->growth_left = 0;
+}
+
+int PySet::size() const {
+    return this->used;
+}
+
+// keys like small ints hash to themselves, spread the bits so both the
+// group index and the 7 bit tag in the control byte get good entropy
+size_t PySet::mix(size_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// bit i set when group[i] == b
+uint32_t PySet::match_byte(const int8_t* group, int8_t b) {
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(b)));
+#else
+    uint32_t mask = 0;
+    for (int i=0; i < GROUP; i++) {
+        if (group[i] == b) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+// bit i set when group[i] is free, EMPTY and DELETED are the only
+// negative control bytes so this is just the sign bits
+uint32_t PySet::match_empty_or_deleted(const int8_t* group) {
+#ifdef __SSE2__
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    uint32_t mask = 0;
+    for (int i=0; i < GROUP; i++) {
+        if (group[i] < 0) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+long PySet::find_slot(const PyObject& key, size_t hash) const {
+    if (this->ctrl.size() == 0) {
+        return -1;
+    }
+    size_t groups_mask = this->ctrl.size() / GROUP - 1;
+    int8_t tag = hash & 0x7f;
+    size_t g = (hash >> 7) & groups_mask;
+    // triangular probing over groups visits every group once
+    for (size_t step=1; step <= groups_mask+1; step++) {
+        const int8_t* group = &this->ctrl[g * GROUP];
+        uint32_t candidates = match_byte(group, tag);
+        while (candidates != 0) {
+            int i = __builtin_ctz(candidates);
+            size_t slot = g * GROUP + i;
+            if (this->hashes[slot] == hash && this->slots[slot].equals(key)) {
+                return slot;
+            }
+            candidates &= candidates - 1;
+        }
+        if (match_byte(group, EMPTY) != 0) {
+            return -1;  // the key would have been placed in this group
+        }
+        g = (g + step) & groups_mask;
+    }
+    return -1;
+}
+
+void PySet::insert_new(const PyObject& key, size_t hash) {
+    size_t groups_mask = this->ctrl.size() / GROUP - 1;
+    size_t g = (hash >> 7) & groups_mask;
+    for (size_t step=1; ; step++) {
+        uint32_t free = match_empty_or_deleted(&this->ctrl[g * GROUP]);
+        if (free != 0) {
+            size_t slot = g * GROUP + __builtin_ctz(free);
+            if (this->ctrl[slot] == EMPTY) this->growth_left--;
+            this->ctrl[slot] = hash & 0x7f;
+            this->slots[slot] = key;
+            this->hashes[slot] = hash;
+            this->used++;
+            return;
+        }
+        g = (g + step) & groups_mask;
+    }
+}
+
+void PySet::rehash(size_t capacity) {
+    vector<int8_t> old_ctrl;
+    vector<PyObject> old_slots;
+    vector<size_t> old_hashes;
+    old_ctrl.swap(this->ctrl);
+    old_slots.swap(this->slots);
+    old_hashes.swap(this->hashes);
+
+    this->ctrl.assign(capacity, EMPTY);
+    this->slots.resize(capacity);
+    this->hashes.resize(capacity);
+    this->used = 0;
+    this->growth_left = capacity * 7 / 8;
+    for (size_t i=0; i < old_ctrl.size(); i++) {
+        if (old_ctrl[i] >= 0) this->insert_new(old_slots[i], old_hashes[i]);
+    }
+}
+
+void PySet::reserve(size_t n) {
+    // capacity is a power of two number of groups, at most 7/8 full
+    size_t capacity = GROUP;
+    while (capacity * 7 / 8 < n) capacity <<= 1;
+    if (capacity > this->ctrl.size() || this->used + this->growth_left < n) {
+        this->rehash(max(capacity, this->ctrl.size()));
+    }
+}
+
+bool PySet::contains(const PyObject& key) const {
+    return this->find_slot(key, mix(key.hash())) >= 0;
+}
+
+bool PySet::insert(const PyObject& key) {
+    size_t hash = mix(key.hash());
+    if (this->find_slot(key, hash) >= 0) {
+        return false;
+    }
+    if (this->growth_left == 0) {
+        // mostly tombstones means a same size rehash is enough to clean up
+        size_t capacity = this->ctrl.size() == 0 ? GROUP : this->ctrl.size();
+        if (this->used + 1 > capacity * 7 / 16) capacity <<= 1;
+        this->rehash(capacity);
+    }
+    this->insert_new(key, hash);
+    return true;
+}
+
+bool PySet::erase(const PyObject& key) {
+    long slot = this->find_slot(key, mix(key.hash()));
+    if (slot < 0) {
+        return false;
+    }
+    // a tombstone keeps probe chains through this slot intact
+    this->ctrl[slot] = DELETED;
+    this->slots[slot] = PyObject();
+    this->used--;
+    return true;
+}
+
+bool PySet::next(int& idx, PyObject& out) const {
+    while (idx < this->ctrl.size()) {
+        if (this->ctrl[idx] >= 0) {
+            out = this->slots[idx];
+            idx++;
+            return true;
+        }
+        idx++;
+    }
+    return false;
+}
+
+PySet PySet::set_union(const PySet& a, const PySet& b) {
+    PySet result;
+    result.reserve(a.size() + b.size());
+    for (size_t i=0; i < a.ctrl.size(); i++) {
+        if (a.ctrl[i] >= 0) result.insert_new(a.slots[i], a.hashes[i]);
+    }
+    for (size_t i=0; i < b.ctrl.size(); i++) {
+        if (b.ctrl[i] >= 0 && result.find_slot(b.slots[i], b.hashes[i]) < 0) {
+            result.insert_new(b.slots[i], b.hashes[i]);
+        }
+    }
+    return result;
+}
+
+PySet PySet::set_intersection(const PySet& a, const PySet& b) {
+    // walk the smaller one, probe the bigger one
+    const PySet& small = a.size() <= b.size() ? a : b;
+    const PySet& big = a.size() <= b.size() ? b : a;
+    PySet result;
+    result.reserve(small.size());
+    for (size_t i=0; i < small.ctrl.size(); i++) {
+        if (small.ctrl[i] >= 0 && big.find_slot(small.slots[i], small.hashes[i]) >= 0) {
+            result.insert_new(small.slots[i], small.hashes[i]);
+        }
+    }
+    return result;
+}
+
+PySet PySet::set_difference(const PySet& a, const PySet& b) {
+    PySet result;
+    result.reserve(a.size());
+    for (size_t i=0; i < a.ctrl.size(); i++) {
+        if (a.ctrl[i] >= 0 && b.find_slot(a.slots[i], a.hashes[i]) < 0) {
+            result.insert_new(a.slots[i], a.hashes[i]);
+        }
+    }
+    return result;
+}
+
+PySet PySet::set_symmetric_difference(const PySet& a, const PySet& b) {
+    PySet result;
+    result.reserve(a.size() + b.size());
+    for (size_t i=0; i < a.ctrl.size(); i++) {
+        if (a.ctrl[i] >= 0 && b.find_slot(a.slots[i], a.hashes[i]) < 0) {
+            result.insert_new(a.slots[i], a.hashes[i]);
+        }
+    }
+    for (size_t i=0; i < b.ctrl.size(); i++) {
+        if (b.ctrl[i] >= 0 && a.find_slot(b.slots[i], b.hashes[i]) < 0) {
+            result.insert_new(b.slots[i], b.hashes[i]);
+        }
+    }
+    return result;
+}
+
+size_t PySet::memory_usage() const {
+    return this->ctrl.capacity() + this->slots.capacity() * sizeof(PyObject) 
+         + this->hashes.capacity() * sizeof(size_t);
+}
@@ -0,0 +1,57 @@
+#ifndef PYSET_H
+#define PYSET_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "pyobject.h"
+using namespace std;
+
+// open addressing hash set in the style of Abseil's Swiss tables. Every
+// slot has a control byte, EMPTY, DELETED or the low 7 bits of the
+// key's hash, and probing tests a whole group of 16 control bytes at
+// once (one SSE2 compare) so most lookups touch a single key
+class PySet {
+    public:
+        PySet();
+
+        int size() const;
+        void reserve(size_t n);
+
+        bool contains(const PyObject& key) const;
+        bool insert(const PyObject& key);  // false if it was already there
+        bool erase(const PyObject& key);   // false if it was not there
+
+        // iteration protocol, idx is a slot position owned by the caller
+        bool next(int& idx, PyObject& out) const;
+
+        // the result is sized once up front, never rehashed while filling
+        static PySet set_union(const PySet& a, const PySet& b);
+        static PySet set_intersection(const PySet& a, const PySet& b);
+        static PySet set_difference(const PySet& a, const PySet& b);
+        static PySet set_symmetric_difference(const PySet& a, const PySet& b);
+
+        size_t memory_usage() const;
+
+    private:
+        static constexpr int GROUP = 16;
+        static constexpr int8_t EMPTY = -128;
+        static constexpr int8_t DELETED = -2;
+
+        vector<int8_t> ctrl;     // capacity bytes, full slots are >= 0
+        vector<PyObject> slots;
+        vector<size_t> hashes;   // cached so growing never rehashes a key
+        size_t used;
+        size_t growth_left;      // inserts before the table is 7/8 full
+
+        static size_t mix(size_t hash);
+        static uint32_t match_byte(const int8_t* group, int8_t b);
+        static uint32_t match_empty_or_deleted(const int8_t* group);
+
+        // slot holding key, or -1
+        long find_slot(const PyObject& key, size_t hash) const;
+        void insert_new(const PyObject& key, size_t hash);
+        void rehash(size_t capacity);
+};
+
+#endif
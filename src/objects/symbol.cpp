@@ -0,0 +1,28 @@
+#include <string>
+#include <unordered_set>
+#include "symbol.h"
+using namespace std;
+
+
+SymbolTable* SymbolTable::symbol_table = nullptr;
+
+SymbolTable::SymbolTable() {}
+
+SymbolTable* SymbolTable::get_instance() {
+    if (symbol_table == nullptr) {
+        symbol_table = new SymbolTable();
+    }
+    return symbol_table;
+}
+
+Symbol SymbolTable::intern(const string& name) {
+    return &*this->names.insert(name).first;
+}
+
+size_t SymbolTable::size() {
+    return this->names.size();
+}
+
+Symbol intern(const string& name) {
+    return SymbolTable::get_instance()->intern(name);
+}
@@ -0,0 +1,38 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <string>
+#include <unordered_set>
+using namespace std;
+
+// an identifier the parser has interned. There is one copy of each name,
+// so two names are the same exactly when their Symbols are and the
+// namespaces hash and compare the pointer instead of the characters
+typedef const string* Symbol;
+
+class SymbolTable {
+    private:
+        // set nodes never move, a Symbol stays valid for the whole run
+        unordered_set<string> names;
+
+    protected:
+        SymbolTable();
+
+        static SymbolTable* symbol_table;
+
+    public:
+        // not cloneable
+        SymbolTable(SymbolTable &other) = delete;
+        // not assignable
+        void operator=(const SymbolTable&) = delete;
+
+        static SymbolTable* get_instance();
+
+        Symbol intern(const string& name);
+        size_t size();
+};
+
+// SymbolTable::get_instance()->intern(name)
+Symbol intern(const string& name);
+
+#endif
@@ -0,0 +1,44 @@
+#include <string>
+#include <iostream>
+#include "writer.h"
+using namespace std;
+
+
+Writer::Writer() {
+    this->out = nullptr;
+}
+
+Writer::Writer(ostream* out) {
+    this->out = out;
+    this->text.reserve(FLUSH_AT);
+}
+
+Writer::~Writer() {
+    this->flush();
+}
+
+void Writer::write(char c) {
+    this->text.push_back(c);
+    if (this->out != nullptr && this->text.size() >= FLUSH_AT) this->flush();
+}
+
+void Writer::write(const char* s, size_t n) {
+    this->text.append(s, n);
+    if (this->out != nullptr && this->text.size() >= FLUSH_AT) this->flush();
+}
+
+void Writer::write(const string& s) {
+    this->write(s.data(), s.size());
+}
+
+void Writer::flush() {
+    if (this->out == nullptr || this->text.empty()) {
+        return;
+    }
+    this->out->write(this->text.data(), this->text.size());
+    this->text.clear();
+}
+
+string& Writer::buffer() {
+    return this->text;
+}
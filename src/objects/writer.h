@@ -0,0 +1,34 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <string>
+#include <iostream>
+using namespace std;
+
+// text for str() and repr() is appended into one growing buffer instead
+// of concatenating a string per item. With a stream attached the buffer
+// is handed over every time it fills, so printing a large container
+// takes a fixed amount of memory instead of the whole text at once
+class Writer {
+    public:
+        Writer();
+        Writer(ostream* out);
+        ~Writer();  // flushes to the stream, if any
+
+        void write(char c);
+        void write(const char* s, size_t n);
+        void write(const string& s);
+        void flush();
+
+        // everything written so far, only whole for a Writer with no stream
+        string& buffer();
+
+    private:
+        // how much is kept before handing it to the stream
+        static constexpr size_t FLUSH_AT = 1 << 16;
+
+        string text;
+        ostream* out;
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include "parser.h"
 #include "objects/token.h"
 #include "util.h"
+#include "memstats.h"
 #include "ast/ast.h"
 #include "ast/ast_helpers.h"
 using namespace std;
@@ -14,6 +15,7 @@ Parser::Parser(Tokenizer* tokenizer) {
 }
 
 AST* Parser::parse(string mode) {
+    MemScope mem_scope(MEM_AST);
     tokenizer->begin();
 	if (mode == "file") {
 		return new File(tokenizer, "");
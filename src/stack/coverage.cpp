@@ -0,0 +1,123 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include "coverage.h"
+#include "stack.h"
+using namespace std;
+
+
+Coverage* Coverage::coverage = nullptr;
+
+static void set_bit(vector<uint64_t>& bits, int line) {
+    if ((size_t)(line >> 6) >= bits.size()) {
+        bits.resize((line >> 6) + 1, 0);
+    }
+    bits[line >> 6] |= (uint64_t)1 << (line & 63);
+}
+
+static bool test_bit(const vector<uint64_t>& bits, int line) {
+    return (size_t)(line >> 6) < bits.size() && (bits[line >> 6] >> (line & 63)) & 1;
+}
+
+Coverage::Coverage() {
+    this->running = false;
+    this->counting = false;
+}
+
+Coverage* Coverage::get_instance() {
+    if (coverage == nullptr) {
+        coverage = new Coverage();
+    }
+    return coverage;
+}
+
+void Coverage::start(string source, bool counting) {
+    this->source = source;
+    this->counting = counting;
+    this->statements.clear();
+    this->executed.clear();
+    this->counts.clear();
+    this->functions.clear();
+    this->running = true;
+    Tracer::settrace(on_event, this);
+}
+
+void Coverage::stop() {
+    if (this->running) {
+        Tracer::settrace(nullptr);
+        this->running = false;
+    }
+}
+
+bool Coverage::is_running() {
+    return this->running;
+}
+
+void Coverage::add_statement(int line) {
+    if (this->running) {
+        set_bit(this->statements, line);
+    }
+}
+
+void Coverage::add_function(int line, const string& name) {
+    if (this->running) {
+        this->functions[line].name = name;
+    }
+}
+
+void Coverage::hit(int line) {
+    if (this->counting) {
+        if ((size_t)line >= this->counts.size()) {
+            this->counts.resize(line + 1, 0);
+        }
+        this->counts[line]++;
+    } else {
+        set_bit(this->executed, line);
+    }
+}
+
+uint64_t Coverage::line_count(int line) {
+    if (this->counting) {
+        return (size_t)line < this->counts.size() ? this->counts[line] : 0;
+    }
+    return test_bit(this->executed, line) ? 1 : 0;
+}
+
+void Coverage::on_event(Stack& stack, TraceEvent event, int line, const PyObject& arg, void* data) {
+    Coverage* coverage = static_cast<Coverage*>(data);
+    if (event == TRACE_LINE) {
+        coverage->hit(line);
+    } else if (event == TRACE_CALL) {
+        coverage->functions[line].calls++;
+    }
+}
+
+void Coverage::write_lcov(ostream& os) {
+    os << "TN:" << endl
+       << "SF:" << filesystem::absolute(this->source).lexically_normal().string() << endl;
+    int functions_hit = 0;
+    for (auto& it : this->functions) {
+        os << "FN:" << it.first << "," << it.second.name << endl;
+    }
+    for (auto& it : this->functions) {
+        os << "FNDA:" << it.second.calls << "," << it.second.name << endl;
+        if (it.second.calls > 0) functions_hit++;
+    }
+    os << "FNF:" << this->functions.size() << endl
+       << "FNH:" << functions_hit << endl;
+    int found = 0;
+    int hit = 0;
+    for (size_t word=0; word < this->statements.size(); word++) {
+        for (uint64_t bits = this->statements[word]; bits != 0; bits &= bits - 1) {
+            int line = word * 64 + __builtin_ctzll(bits);
+            uint64_t count = this->line_count(line);
+            os << "DA:" << line << "," << count << endl;
+            found++;
+            if (count > 0) hit++;
+        }
+    }
+    os << "LF:" << found << endl
+       << "LH:" << hit << endl
+       << "end_of_record" << endl;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "stack.fwd.h"
+
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include "pyobject.h"
+#include "tracer.h"
+using namespace std;
+
+// --coverage: the lines a program ran, as lcov tracefile data for
+// genhtml or any CI coverage tool. The parser marks every statement's
+// first line and every def as it builds them, a Tracer hook marks the
+// lines that run. Executed lines are one bit each, --coverage-counts
+// keeps a dense array of run counts instead. A settrace() in the
+// program replaces the hook, like it does coverage.py's
+class Coverage {
+    private:
+        struct Function {
+            string name;
+            uint64_t calls = 0;
+        };
+        bool running;
+        bool counting;
+        string source;
+        // bit per line, the statements the parser found and the ones run
+        vector<uint64_t> statements;
+        vector<uint64_t> executed;
+        vector<uint32_t> counts;
+        // by def line
+        map<int, Function> functions;
+
+        static void on_event(Stack& stack, TraceEvent event, int line, const PyObject& arg, void* data);
+
+    protected:
+        Coverage();
+
+        static Coverage* coverage;
+
+    public:
+        // not cloneable
+        Coverage(Coverage &other) = delete;
+        // not assignable
+        void operator=(const Coverage&) = delete;
+
+        static Coverage* get_instance();
+
+        // before parsing, so the parser's calls below are kept
+        void start(string source, bool counting);
+        void stop();
+        bool is_running();
+
+        // the parser's side
+        void add_statement(int line);
+        void add_function(int line, const string& name);
+
+        // the hook's side
+        void hit(int line);
+        uint64_t line_count(int line);
+
+        // one lcov record: SF, FN/FNDA/FNF/FNH, DA, LF/LH
+        void write_lcov(ostream& os);
+};
+
+#endif
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <csignal>
+#include <sys/time.h>
+#include <time.h>
+#include "profiler.h"
+#include "symbol.h"
+using namespace std;
+
+
+Profiler* Profiler::profiler = nullptr;
+
+static void on_sigprof(int) {
+    Profiler::get_instance()->sample();
+}
+
+static double process_cpu_seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// module level code is the bottom frame, it is never popped
+Profiler::Profiler() {
+    this->retired.emplace_back(new ProfileFrame[PROFILE_INITIAL_DEPTH]);
+    this->capacity = PROFILE_INITIAL_DEPTH;
+    this->frames = this->retired.back().get();
+    this->frames[0] = ProfileFrame{intern("<module>"), 0};
+    this->depth = 1;
+    this->cpu_start = 0;
+    this->cpu_seconds = 0;
+    this->used = 0;
+    this->n_samples = 0;
+    this->dropped = 0;
+    this->running = false;
+}
+
+Profiler* Profiler::get_instance() {
+    if (profiler == nullptr) {
+        profiler = new Profiler();
+    }
+    return profiler;
+}
+
+// the copy is complete before the new array is published, and the old
+// one stays allocated, so a sample sees one or the other whole
+void Profiler::grow() {
+    int d = this->depth;
+    ProfileFrame* larger = new ProfileFrame[2 * this->capacity];
+    copy(this->frames.load(), this->frames.load() + d, larger);
+    this->retired.emplace_back(larger);
+    this->frames = larger;
+    this->capacity *= 2;
+}
+
+// the frame is filled in before depth is raised so a sample never
+// sees a half written one
+void Profiler::enter(Symbol function) {
+    int d = this->depth;
+    if (d >= this->capacity) {
+        this->grow();
+    }
+    this->frames[d] = ProfileFrame{function, 0};
+    this->depth = d + 1;
+}
+
+// a tail call reuses the frame for another function
+void Profiler::set_function(Symbol function) {
+    this->frames[this->depth - 1].function = function;
+}
+
+void Profiler::leave() {
+    this->depth = this->depth - 1;
+}
+
+void Profiler::set_line(int line) {
+    this->frames[this->depth - 1].line = line;
+}
+
+int Profiler::current_line() {
+    return this->frames[this->depth - 1].line;
+}
+
+void Profiler::start(string script) {
+    this->script = script;
+    if (this->samples == nullptr) {
+        // not value initialized, nothing is touched until it is written
+        this->samples.reset(new uintptr_t[PROFILE_BUFFER_WORDS]);
+    }
+    this->running = true;
+    this->cpu_start = process_cpu_seconds();
+
+    struct sigaction action = {};
+    action.sa_handler = on_sigprof;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, nullptr);
+
+    // ITIMER_PROF counts CPU time, so time blocked on input is not sampled
+    struct itimerval timer = {};
+    timer.it_interval.tv_usec = PROFILE_INTERVAL_US;
+    timer.it_value.tv_usec = PROFILE_INTERVAL_US;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+void Profiler::stop() {
+    struct itimerval timer = {};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    // SIGPROF terminates by default, one still pending must not
+    signal(SIGPROF, SIG_IGN);
+    if (this->running) {
+        this->cpu_seconds += process_cpu_seconds() - this->cpu_start;
+    }
+    this->running = false;
+}
+
+bool Profiler::is_running() {
+    return this->running;
+}
+
+// runs in the signal handler: no locks, no allocation, only copies
+void Profiler::sample() {
+    if (!this->running || this->samples == nullptr) {
+        return;
+    }
+    const ProfileFrame* frames = this->frames.load();
+    int d = this->depth;
+    int recorded = d < PROFILE_SAMPLE_DEPTH ? d : PROFILE_SAMPLE_DEPTH;
+    size_t need = 2 + 2 * recorded;
+    if (this->used + need > PROFILE_BUFFER_WORDS) {
+        this->dropped = this->dropped + 1;
+        return;
+    }
+    uintptr_t* out = this->samples.get() + this->used;
+    out[0] = d;
+    out[1] = recorded;
+    for (int i=0; i < recorded; i++) {
+        const ProfileFrame& frame = frames[d - recorded + i];
+        out[2 + 2*i] = (uintptr_t)frame.function;
+        out[3 + 2*i] = frame.line;
+    }
+    this->used = this->used + need;
+    this->n_samples = this->n_samples + 1;
+}
+
+void Profiler::clear() {
+    this->used = 0;
+    this->n_samples = 0;
+    this->dropped = 0;
+    this->cpu_seconds = 0;
+}
+
+size_t Profiler::sample_count() {
+    return this->n_samples;
+}
+
+// calls fn(depth, recorded, frames) for every sample, frames are
+// (function, line) pairs with the innermost last
+template <typename F>
+static void each_sample(const uintptr_t* samples, size_t used, F fn) {
+    size_t i = 0;
+    while (i < used) {
+        int depth = samples[i];
+        int recorded = samples[i+1];
+        fn(depth, recorded, samples + i + 2);
+        i += 2 + 2 * recorded;
+    }
+}
+
+static string function_name(uintptr_t function) {
+    return function == 0 ? "?" : *(Symbol)function;
+}
+
+struct ProfileRow {
+    string label;
+    size_t self = 0;
+    size_t total = 0;
+};
+
+// seconds is the CPU time of all n samples
+static void write_rows(ostream& os, string title, map<string, ProfileRow>& rows, size_t n, double seconds) {
+    vector<ProfileRow> sorted;
+    for (auto& row : rows) sorted.push_back(row.second);
+    stable_sort(sorted.begin(), sorted.end(), [](const ProfileRow& a, const ProfileRow& b) {
+        return a.self != b.self ? a.self > b.self : a.total > b.total;
+    });
+    double interval = seconds / n;
+    os << endl << "   self s   self %   total s  total %  " << title << endl;
+    for (const ProfileRow& row : sorted) {
+        os << fixed << setprecision(3)
+           << setw(9) << row.self * interval << setprecision(1)
+           << setw(8) << 100.0 * row.self / n << "%"
+           << setprecision(3) << setw(10) << row.total * interval << setprecision(1)
+           << setw(8) << 100.0 * row.total / n << "%  "
+           << row.label << endl;
+    }
+}
+
+void Profiler::write_report(ostream& os) {
+    size_t n = this->n_samples;
+    os << "profile of " << this->script << ": " << n << " samples, "
+       << fixed << setprecision(3) << this->cpu_seconds << " s of CPU time";
+    if (n > 0) {
+        os << " (" << 1000 * this->cpu_seconds / n << " ms per sample)";
+    }
+    if (this->dropped > 0) {
+        os << ", " << this->dropped << " dropped";
+    }
+    os << endl;
+    if (n == 0) {
+        return;
+    }
+
+    // total time counts a function or line once per sample, however
+    // many times it is on the stack
+    map<string, ProfileRow> functions;
+    map<string, ProfileRow> lines;
+    each_sample(this->samples.get(), this->used, [&](int depth, int recorded, const uintptr_t* frames) {
+        set<string> seen_functions;
+        set<string> seen_lines;
+        for (int i=0; i < recorded; i++) {
+            string function = function_name(frames[2*i]);
+            string line = this->script + ":" + to_string(frames[2*i+1]) + " (" + function + ")";
+            bool innermost = i == recorded - 1;
+            functions[function].label = function;
+            lines[line].label = line;
+            if (innermost) {
+                functions[function].self++;
+                lines[line].self++;
+            }
+            if (seen_functions.insert(function).second) functions[function].total++;
+            if (seen_lines.insert(line).second) lines[line].total++;
+        }
+    });
+    write_rows(os, "function", functions, n, this->cpu_seconds);
+    write_rows(os, "line", lines, n, this->cpu_seconds);
+}
+
+void Profiler::write_folded(ostream& os) {
+    map<string, size_t> stacks;
+    each_sample(this->samples.get(), this->used, [&](int depth, int recorded, const uintptr_t* frames) {
+        string stack = depth > recorded ? "[truncated]" : "";
+        for (int i=0; i < recorded; i++) {
+            if (stack.size() > 0) stack += ";";
+            stack += function_name(frames[2*i]) + " (" + this->script + ":"
+                     + to_string(frames[2*i+1]) + ")";
+        }
+        stacks[stack]++;
+    });
+    for (auto& stack : stacks) {
+        os << stack.first << " " << stack.second << endl;
+    }
+}
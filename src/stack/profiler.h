@@ -0,0 +1,98 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include "symbol.h"
+using namespace std;
+
+// frames the stack starts with room for, it doubles as calls go deeper
+#define PROFILE_INITIAL_DEPTH 4096
+// innermost frames kept per sample, deeper stacks are cut at the root
+#define PROFILE_SAMPLE_DEPTH 128
+// words of sample storage, reserved up front so the signal handler
+// never allocates. pages are only touched as samples are written
+#define PROFILE_BUFFER_WORDS (1 << 23)
+#define PROFILE_INTERVAL_US 1000
+
+// the Python level call stack as a flat array the SIGPROF handler can
+// copy without taking locks or allocating: the function running at each
+// depth and the line of the statement it is on. Stack::call_global
+// pushes and pops it and each Statement sets its line, which is cheap
+// enough to keep on all the time. --profile starts a CPU time timer,
+// every tick records the stack, and the report is built from the
+// samples once the program is done. The timer only fires on scheduler
+// ticks (4 ms at HZ=250, not the 1 ms asked for), so seconds come from
+// the CPU time measured between start() and stop(), split evenly over
+// the samples
+class Profiler {
+    private:
+        struct ProfileFrame {
+            Symbol function;
+            int line;
+        };
+        // grown by enter(), the handler loads the pointer once per
+        // sample. replaced arrays are kept in retired so a sample that
+        // started before the swap still reads valid memory
+        atomic<ProfileFrame*> frames;
+        int capacity;
+        vector<unique_ptr<ProfileFrame[]>> retired;
+        volatile sig_atomic_t depth;
+
+        // each sample is [depth, recorded, (function, line) * recorded]
+        // with the innermost frame last
+        unique_ptr<uintptr_t[]> samples;
+        volatile size_t used;
+        volatile size_t n_samples;
+        volatile size_t dropped;
+        bool running;
+        string script;
+        // process CPU time while running
+        double cpu_start;
+        double cpu_seconds;
+
+        void grow();
+
+    protected:
+        Profiler();
+
+        static Profiler* profiler;
+
+    public:
+        // not cloneable
+        Profiler(Profiler &other) = delete;
+        // not assignable
+        void operator=(const Profiler&) = delete;
+
+        static Profiler* get_instance();
+
+        // the interpreter's side
+        void enter(Symbol function);
+        void set_function(Symbol function);
+        void leave();
+        void set_line(int line);
+        // the line the innermost frame is on, 0 before the first statement
+        int current_line();
+
+        // --profile, script is only used to label the lines
+        void start(string script);
+        void stop();
+        bool is_running();
+        // called from the signal handler
+        void sample();
+        void clear();
+
+        size_t sample_count();
+        // per function and per line self and total time, most self time first
+        void write_report(ostream& os);
+        // one 'outer;...;inner count' line per distinct stack, the input
+        // flamegraph.pl and speedscope take
+        void write_folded(ostream& os);
+};
+
+#endif
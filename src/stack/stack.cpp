@@ -5,20 +5,43 @@
 #include <tuple>
 #include <map>
 #include <string>
+#include <exception>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include "logging.h"
 #include "stack.h"
 #include "builtins.h"
 #include "ast.h"
 #include "pyobject.h"
+#include "pyexception.h"
+#include "pylist.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "instrument.h"
+#include "memstats.h"
 using namespace std;
-    
-#define MAX_FRAMES 100
+
+// the evaluator recurses natively, so calls run on stack segments taken
+// from the heap as recursion deepens instead of one stack sized for the
+// limit up front. A segment holds a few hundred Python calls
+#define NATIVE_SEGMENT_SIZE (8 * 1024 * 1024)
+// a call moves to a new segment when less than this is left, headroom
+// for builtins and the error path
+#define NATIVE_STACK_MARGIN (256 * 1024)
+
+int Stack::recursion_limit = DEFAULT_RECURSION_LIMIT;
+
+// bounds of the native stack the evaluator is running on
+static char* native_stack_base = nullptr;
+static size_t native_stack_size = 0;
 
 
 //==========================================================
 
 Frame::Frame() {
-    this->id = id;
+    this->id = 0;
+    this->global_frame = this;
     this->builtins = build_builtins();
     this->set_default_values();
     Logger::get_instance()->log("Created Frame with id: " + to_string(this->id), INFO);
@@ -26,22 +49,16 @@ Frame::Frame() {
 
 Frame::Frame(int id, Frame* prev_frame) {
     this->id = id;
-    this->globals = map<string, AST*>(prev_frame->globals);
-    this->builtins = map<string, FnPtr>(prev_frame->builtins);
+    this->global_frame = prev_frame->global_frame;
     this->set_default_values();
     Logger::get_instance()->log("Created Frame with id: " + to_string(this->id), INFO);
 }
 
-Frame::Frame(int id, map<string, AST*> globals, map<string, FnPtr> builtins) {
-    this->id = id;
-    this->globals = map<string, AST*>(globals);
-    this->builtins = map<string, FnPtr>(builtins);
-    this->set_default_values();
-    Logger::get_instance()->log("Created Frame " + to_string(this->id), INFO);
-}
-
 void Frame::set_default_values() {
     this->returning = false;
+    this->breaking = false;
+    this->continuing = false;
+    this->tail_function = nullptr;
     this->return_value = PyObject();  // None
     this->parameters = PyObject();  // None
     this->parameter_idx = 0;
@@ -52,46 +69,93 @@ string Frame::get_function_name() {
 }
 
 PyObject Frame::next_param() {
+    if (this->parameter_idx >= this->parameters.size()) {
+        throw PyException("TypeError", this->function_name 
+                                       + "() missing required positional argument");
+    }
     PyObject next_p = this->parameters.at(this->parameter_idx);
     this->parameter_idx++;
 
     return next_p;
 }
 
-void Frame::assign(string name, PyObject value) {
-    this->locals.insert(pair<string, PyObject>(name, value));
-    Logger::get_instance()->log(
-        "Frame " + to_string(this->id) + (string)": " + name + " = " + (string)value,
-        DEBUG
-    );
+void Frame::assign(Symbol name, PyObject value) {
+    INSTRUMENT_SCOPE("Frame::assign");
+    this->get_slot(name) = value;
+    // printing the value is O(n) for containers, only build it when it is logged
+    if (Logger::get_instance()->enabled(DEBUG)) {
+        Logger::get_instance()->log(
+            "Frame " + to_string(this->id) + (string)": " + *name + " = " + (string)value,
+            DEBUG
+        );
+    }
 }
 
-PyObject Frame::get_value(string name) {
-    // check globals / builtins - if its a function then return its name
-    map<string, FnPtr>::iterator b_it = this->builtins.find(name);
-    map<string, AST*>::iterator g_it = this->globals.find(name);
-    if (b_it == this->builtins.end() && g_it == this->globals.end()) {
-        // not in globals / builtins
-        map<string, PyObject>::iterator locals_it = this->locals.find(name);
+// the local's storage, created as None if missing. map nodes dont move
+// so loops can hold on to it and write each item straight in
+PyObject& Frame::get_slot(Symbol name) {
+    MemScope mem_scope(MEM_FRAMES);
+    return this->locals[name];
+}
+
+// an existing local or global, for targets like 'x[0] = 1' that
+// modify the object in place
+PyObject& Frame::get_ref(Symbol name) {
+    unordered_map<Symbol, PyObject>::iterator it = this->locals.find(name);
+    if (it != this->locals.end()) {
+        return it->second;
+    }
+    it = this->global_frame->locals.find(name);
+    if (it != this->global_frame->locals.end()) {
+        return it->second;
+    }
+    throw PyException("NameError", "name '" + *name + "' is not defined");
+}
+
+// an existing local only, 'x += 1' never rebinds a global
+PyObject& Frame::get_local_ref(Symbol name) {
+    unordered_map<Symbol, PyObject>::iterator it = this->locals.find(name);
+    if (it != this->locals.end()) {
+        return it->second;
+    }
+    if (this->global_frame != this) {
+        throw PyException("UnboundLocalError", "local variable '" + *name 
+                                               + "' referenced before assignment");
+    }
+    throw PyException("NameError", "name '" + *name + "' is not defined");
+}
 
-        if (locals_it != this->locals.end()) {
-            return locals_it->second;
+PyObject Frame::get_value(Symbol name) {
+    INSTRUMENT_SCOPE("Frame::get_value");
+    // locals -> globals -> builtins, functions are regular objects
+    // so whatever is found can be called without another lookup
+    unordered_map<Symbol, PyObject>::iterator it = this->locals.find(name);
+    if (it != this->locals.end()) {
+        return it->second;
+    }
+    if (this->global_frame != this) {
+        it = this->global_frame->locals.find(name);
+        if (it != this->global_frame->locals.end()) {
+            return it->second;
         }
-        Logger::get_instance()->log(
-            "Frame " + to_string(this->id) + " failed to find Name '" + (string)name + "'",
-            DEBUG
-        );
-        throw runtime_error("NameError: name '" + (string)name + "' is not defined");
     }
-    else {
-        return PyObject(name, "str");
+    it = this->global_frame->builtins.find(name);
+    if (it != this->global_frame->builtins.end()) {
+        return it->second;
     }
+    Logger::get_instance()->log(
+        "Frame " + to_string(this->id) + " failed to find Name '" + *name + "'",
+        DEBUG
+    );
+    throw PyException("NameError", "name '" + *name + "' is not defined");
 }
 
 void Frame::set_return_value(PyObject value) {
     this->return_value = value;
     this->returning = true;
-    Logger::get_instance()->log("Set return value to: " + (string)value, DEBUG);
+    if (Logger::get_instance()->enabled(DEBUG)) {
+        Logger::get_instance()->log("Set return value to: " + (string)value, DEBUG);
+    }
 }
 
 PyObject Frame::get_return_value() {
@@ -102,61 +166,206 @@ bool Frame::is_returning() {
     return this->returning;
 }
 
+void Frame::set_breaking() {
+    this->breaking = true;
+}
 
-//==========================================================
+void Frame::set_continuing() {
+    this->continuing = true;
+}
+
+bool Frame::is_breaking() {
+    return this->breaking;
+}
+
+bool Frame::is_continuing() {
+    return this->continuing;
+}
 
-// TODO: Notes for later
-// print("a: ", a())
-// this is not working, each Frame needs its own arg_stack bc atm
-// the a() call is thrashing print()'s arg_stack
+void Frame::clear_loop_flags() {
+    this->breaking = false;
+    this->continuing = false;
+}
+
+// Blocks stop executing statements while any of these are set
+bool Frame::is_unwinding() {
+    return this->returning || this->breaking || this->continuing;
+}
+
+PendingJump Frame::take_pending_jump() {
+    PendingJump jump{this->returning, this->breaking, this->continuing, this->return_value};
+    this->returning = false;
+    this->breaking = false;
+    this->continuing = false;
+    return jump;
+}
+
+void Frame::restore_pending_jump(const PendingJump& jump) {
+    this->returning = jump.returning;
+    this->breaking = jump.breaking;
+    this->continuing = jump.continuing;
+    this->return_value = jump.return_value;
+}
+
+void Frame::set_tail_call(AST* function, PyObject arguments) {
+    // returning makes the enclosing Blocks unwind back to call_global
+    this->returning = true;
+    this->tail_function = function;
+    this->parameters = arguments;
+}
+
+AST* Frame::take_tail_call() {
+    // resets the frame for reuse, parameters stay for the next call
+    AST* function = this->tail_function;
+    if (function != nullptr) {
+        PyObject arguments = this->parameters;
+        this->locals.clear();
+        this->set_default_values();
+        this->parameters = arguments;
+    }
+    return function;
+}
+
+
+//==========================================================
 
 Stack::Stack() {
-    this->frames.push_back(new Frame());
+    {
+        MemScope mem_scope(MEM_FRAMES);
+        this->frames.push_back(new Frame());
+    }
+    MemStats::line_source = []() { return Profiler::get_instance()->current_line(); };
+    if (native_stack_base == nullptr) {
+        // not started through run_with_call_stack(), assume the main
+        // thread's stack starts about here
+        char marker;
+        struct rlimit rl;
+        getrlimit(RLIMIT_STACK, &rl);
+        native_stack_base = &marker;
+        native_stack_size = rl.rlim_cur == RLIM_INFINITY ? 8 * 1024 * 1024 : rl.rlim_cur;
+    }
     Logger::get_instance()->log("Created the Stack", INFO);
 }
 
+void Stack::set_recursion_limit(int limit) {
+    if (limit < 1) {
+        throw PyException("ValueError", "recursion limit must be greater or equal than 1");
+    }
+    recursion_limit = limit;
+}
+
+int Stack::get_recursion_limit() {
+    return recursion_limit;
+}
+
 void Stack::clean() {
     while (this->frames.size() > 0) this->pop_frame();
 }
 
-PyObject Stack::call_global(AST* functiondef) {
+PyObject Stack::call_global(AST* functiondef, PyObject arguments) {
+    INSTRUMENT_SCOPE("Stack::call_global");
+    // running out of native stack would kill the process, the call
+    // carries on in a fresh segment instead
+    char marker;
+    if ((size_t)(native_stack_base - &marker) > native_stack_size - NATIVE_STACK_MARGIN) {
+        PyObject ret;
+        run_with_call_stack([&]() { ret = this->call_global(functiondef, arguments); });
+        return ret;
+    }
+
     // need to push a new frame, update the params, then eval the block
-    Frame* new_frame = new Frame(next_id(), current_frame());
-    push_frame(new_frame);
-    FunctionDefRaw* raw = dynamic_cast<FunctionDefRaw*>(dynamic_cast<FunctionDef*>(functiondef)->raw);
-    Logger::get_instance()->log("calling function '" + raw->name + "'", DEBUG);
-    new_frame->function_name = raw->name;
-    raw->params->evaluate(*this);
-    raw->body->evaluate(*this);
+    Frame* new_frame;
+    {
+        MemScope mem_scope(MEM_FRAMES);
+        new_frame = new Frame(next_id(), current_frame());
+        push_frame(new_frame);
+    }
+    // the body's own allocations are not the caller's list or dict
+    MemScope mem_scope(MEM_OTHER);
+    Profiler::get_instance()->enter(dynamic_cast<FunctionDef*>(functiondef)->raw->symbol);
+    FunctionDefRaw* raw;
+
+    // a 'return f(...)' in the body hands back f here and the same
+    // frame is reused instead of nesting another call
+    try {
+        while (functiondef != nullptr) {
+            raw = dynamic_cast<FunctionDef*>(functiondef)->raw;
+            Logger::get_instance()->log("calling function '" + raw->name + "'", DEBUG);
+            new_frame->function_name = raw->name;
+            Profiler::get_instance()->set_function(raw->symbol);
+            new_frame->parameters = arguments;
+            raw->params->evaluate(*this);
+            if (new_frame->parameter_idx < arguments.size()) {
+                throw PyException("TypeError", raw->name + "() takes " 
+                    + to_string(new_frame->parameter_idx) + " positional arguments but " 
+                    + to_string(arguments.size()) + " were given");
+            }
+            if (Tracer::active) {
+                Tracer::call(*this, raw->line);
+            }
+            raw->body->evaluate(*this);
+            functiondef = new_frame->take_tail_call();
+            arguments = new_frame->parameters;
+            if (Tracer::active) {
+                // a function replaced by a tail call returns before its value is known
+                PyObject value = functiondef == nullptr ? new_frame->get_return_value() : PyObject();
+                Tracer::ret(*this, Profiler::get_instance()->current_line(), value);
+            }
+        }
+    } catch (...) {
+        // unwinding to a handler further up, the frame goes with it
+        if (Tracer::active) {
+            // the exception already on its way out wins over one from a hook
+            try {
+                Tracer::ret(*this, Profiler::get_instance()->current_line(), PyObject());
+            } catch (...) {}
+        }
+        Profiler::get_instance()->leave();
+        pop_frame();
+        throw;
+    }
+    Profiler::get_instance()->leave();
     PyObject ret = new_frame->get_return_value();
     pop_frame();
-    Logger::get_instance()->log("function '" + raw->name + "' returning: " + ret.as_string(), DEBUG);
+    if (Logger::get_instance()->enabled(DEBUG)) {
+        Logger::get_instance()->log("function '" + raw->name + "' returning: " + ret.as_string(), DEBUG);
+    }
     return ret;
 }
 
-PyObject Stack::call_function(PyObject func_name, PyObject arguments) {
-    Logger::get_instance()->log("searching for function: '" + (string)func_name + "'", DEBUG);
-    Frame* current_f = current_frame();
-
-    // check/call builtin
-    map<string, FnPtr>::iterator builtin_it = current_f->builtins.find((string)func_name);
-
-    if (builtin_it != current_f->builtins.end()) {
-        Logger::get_instance()->log("calling builtin: '" + (string)func_name + "'", DEBUG);
-        PyObject ret = builtin_it->second(arguments);
-        Logger::get_instance()->log("function '" + (string)func_name + "' returning: " + ret.as_string(), DEBUG);
-
-        return ret;
+PyObject Stack::call_function(PyObject function, PyObject arguments) {
+    INSTRUMENT_SCOPE("Stack::call_function");
+    // function objects carry their own pointer, no name resolution needed
+    if (function.type == "builtin_function_or_method") {
+        Logger::get_instance()->log("calling builtin: '" + function.as_string() + "'", DEBUG);
+        // most calls skip this, see Args::call_builtin
+        const PyList& items = arguments.as_list();
+        if (items.kind() != PyList::OBJECTS) {
+            vector<PyObject> boxed = items.items();
+            return call_builtin(function.get_builtin(), boxed.data(), boxed.size(), arguments.keywords());
+        }
+        return call_builtin(function.get_builtin(), items.objects().data(), items.size(), 
+                            arguments.keywords());
     }
-    
-    // check/call global
-    map<string, AST*>::iterator g_it = current_f->globals.find((string)func_name);
-
-    if (g_it != current_f->globals.end()) {
-        return call_global(g_it->second);
+    if (arguments.keywords() != nullptr) {
+        throw runtime_error("call: keyword arguments to '" + function.get_name() + "' not implemented");
+    }
+    if (function.type == "function") {
+        return call_global(function.get_function(), arguments);
     }
+    if (function.type == "type") {
+        return new_exception(function.get_class_name(), arguments);
+    }
+    throw PyException("TypeError", "'" + function.type + "' object is not callable");
+}
 
-    throw runtime_error("stack - function \'" + (string)func_name + "\' is not defined");
+void Stack::tail_call(PyObject function, PyObject arguments) {
+    if (function.type != "function" || this->frames.size() == 1) {
+        // builtins and module level code have no frame to reuse
+        this->set_return_value(this->call_function(function, arguments));
+        return;
+    }
+    this->current_frame()->set_tail_call(function.get_function(), arguments);
 }
 
 string Stack::get_function_name() {
@@ -168,18 +377,28 @@ PyObject Stack::next_param() {
 }
 
 void Stack::add_function(AST* function) {
-    Frame* cf = current_frame();
     FunctionDef* function_t = dynamic_cast<FunctionDef*>(function);
-    FunctionDefRaw* raw_t = dynamic_cast<FunctionDefRaw*>(function_t->raw);
-    cf->globals.insert(pair<string, AST*>(raw_t->name, function_t));
-    Logger::get_instance()->log("Added function '" + raw_t->name + "' to globals", INFO);
+    current_frame()->assign(function_t->raw->symbol, PyObject(function, "function"));
+    Logger::get_instance()->log("Added function '" + function_t->raw->name + "'", INFO);
 }
 
-void Stack::assign(PyObject name, PyObject value) {
+void Stack::assign(Symbol name, PyObject value) {
     this->current_frame()->assign(name, value);
 }
 
-PyObject Stack::get_value(string name) {
+PyObject& Stack::get_slot(Symbol name) {
+    return this->current_frame()->get_slot(name);
+}
+
+PyObject& Stack::get_ref(Symbol name) {
+    return this->current_frame()->get_ref(name);
+}
+
+PyObject& Stack::get_local_ref(Symbol name) {
+    return this->current_frame()->get_local_ref(name);
+}
+
+PyObject Stack::get_value(Symbol name) {
     return this->current_frame()->get_value(name);
 }
 
@@ -191,6 +410,53 @@ bool Stack::is_returning(){
     return this->current_frame()->is_returning();
 }
 
+void Stack::set_breaking() {
+    this->current_frame()->set_breaking();
+}
+
+void Stack::set_continuing() {
+    this->current_frame()->set_continuing();
+}
+
+bool Stack::is_breaking() {
+    return this->current_frame()->is_breaking();
+}
+
+bool Stack::is_continuing() {
+    return this->current_frame()->is_continuing();
+}
+
+void Stack::clear_loop_flags() {
+    this->current_frame()->clear_loop_flags();
+}
+
+bool Stack::is_unwinding() {
+    return this->current_frame()->is_unwinding();
+}
+
+PendingJump Stack::take_pending_jump() {
+    return this->current_frame()->take_pending_jump();
+}
+
+void Stack::restore_pending_jump(const PendingJump& jump) {
+    this->current_frame()->restore_pending_jump(jump);
+}
+
+void Stack::push_handled_exception(PyObject exception) {
+    this->handled_exceptions.push_back(exception);
+}
+
+void Stack::pop_handled_exception() {
+    this->handled_exceptions.pop_back();
+}
+
+PyObject Stack::current_exception() {
+    if (this->handled_exceptions.size() == 0) {
+        throw PyException("RuntimeError", "No active exception to reraise");
+    }
+    return this->handled_exceptions.back();
+}
+
 Frame* Stack::current_frame() {
     return this->frames.back();
 }
@@ -200,8 +466,10 @@ int Stack::next_id() {
 }
 
 void Stack::push_frame(Frame* f) {
-    if (this->frames.size() >= MAX_FRAMES) {
-        throw runtime_error("Stack Overflow (" + to_string(MAX_FRAMES) + ")");
+    // the module frame is not a call, the limit counts calls only
+    if (this->frames.size() - 1 >= (size_t)recursion_limit) {
+        delete f;  // never made it onto the stack
+        throw PyException("RecursionError", "maximum recursion depth exceeded");
     }
     frames.push_back(f);
 }
@@ -215,3 +483,81 @@ void Stack::pop_frame() {
     Logger::get_instance()->log("Popped Frame with id: " + to_string(b->id), INFO);
     delete b;
 }
+
+
+//==========================================================
+// native stack
+
+// released segments are kept for the next descent, up to this many
+#define NATIVE_SPARE_SEGMENTS 4
+
+struct CallStackArgs {
+    function<void()>* fn;
+    exception_ptr error;
+    ucontext_t caller;
+};
+
+static vector<char*> spare_segments;
+// read by call_stack_main() as soon as it starts on the new segment
+static CallStackArgs* pending_call = nullptr;
+
+static char* take_segment() {
+    if (spare_segments.size() > 0) {
+        char* segment = spare_segments.back();
+        spare_segments.pop_back();
+        return segment;
+    }
+    // only reserved, pages are touched as the calls go deeper
+    void* segment = mmap(nullptr, NATIVE_SEGMENT_SIZE, PROT_READ | PROT_WRITE, 
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (segment == MAP_FAILED) {
+        throw PyException("RecursionError", "maximum recursion depth exceeded");
+    }
+    return (char*)segment;
+}
+
+static void release_segment(char* segment) {
+    if (spare_segments.size() < NATIVE_SPARE_SEGMENTS) {
+        spare_segments.push_back(segment);
+    } else {
+        munmap(segment, NATIVE_SEGMENT_SIZE);
+    }
+}
+
+static void call_stack_main() {
+    CallStackArgs* args = pending_call;
+    try {
+        (*args->fn)();
+    } catch (...) {
+        // exceptions cannot unwind past the segment, the caller rethrows
+        args->error = current_exception();
+    }
+    // returning resumes args->caller through uc_link
+}
+
+void run_with_call_stack(function<void()> fn) {
+    char* segment = take_segment();
+    char* saved_base = native_stack_base;
+    size_t saved_size = native_stack_size;
+
+    CallStackArgs args{&fn, nullptr};
+    ucontext_t context;
+    getcontext(&context);
+    context.uc_stack.ss_sp = segment;
+    context.uc_stack.ss_size = NATIVE_SEGMENT_SIZE;
+    context.uc_link = &args.caller;
+    makecontext(&context, call_stack_main, 0);
+
+    pending_call = &args;
+    native_stack_base = segment + NATIVE_SEGMENT_SIZE;
+    native_stack_size = NATIVE_SEGMENT_SIZE;
+    swapcontext(&args.caller, &context);
+
+    // back on the caller's stack, and its bounds
+    native_stack_base = saved_base;
+    native_stack_size = saved_size;
+    release_segment(segment);
+    if (args.error) {
+        rethrow_exception(args.error);
+    }
+}
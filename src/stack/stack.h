@@ -10,16 +10,32 @@
 #include <deque>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <functional>
 #include "pyobject.h"
+#include "symbol.h"
 #include "ast.h"
 using namespace std;
 
-typedef PyObject (*FnPtr)(PyObject);
+#define DEFAULT_RECURSION_LIMIT 100000
+
+// a return/break/continue that is on hold while a finally block runs
+struct PendingJump {
+    bool returning;
+    bool breaking;
+    bool continuing;
+    PyObject return_value;
+};
 
 class Frame {
     private:
         PyObject return_value;
         bool returning;
+        // set by 'break' and 'continue', cleared by the enclosing loop
+        bool breaking;
+        bool continuing;
+        // set by 'return f(...)', the call reuses this frame
+        AST* tail_function;
     public:
         int id;
         string function_name = "";
@@ -27,13 +43,14 @@ class Frame {
         PyObject parameters;
         int parameter_idx;
 
-        map<string, FnPtr> builtins;
-        map<string, AST*> globals;
-        map<string, PyObject> locals;
+        // the module level frame, owns the builtins and globals
+        Frame* global_frame;
+        // keyed by interned name, see symbol.h
+        unordered_map<Symbol, PyObject> builtins;
+        unordered_map<Symbol, PyObject> locals;
 
         Frame();
         Frame(int id, Frame* prev_frame);
-        Frame(int id, map<string, AST*> globals, map<string, FnPtr> builtins);
         void set_default_values();
 
         // functions
@@ -41,35 +58,77 @@ class Frame {
         PyObject next_param();
 
         // locals
-        void assign(string name, PyObject value);
-        PyObject get_value(string name);
+        void assign(Symbol name, PyObject value);
+        PyObject& get_slot(Symbol name);
+        PyObject& get_ref(Symbol name);
+        PyObject& get_local_ref(Symbol name);
+        PyObject get_value(Symbol name);
 
         // for ReturnStmt
         PyObject get_return_value();
         void set_return_value(PyObject value);
         bool is_returning();
+
+        // for loops
+        void set_breaking();
+        void set_continuing();
+        bool is_breaking();
+        bool is_continuing();
+        void clear_loop_flags();
+        bool is_unwinding();
+
+        // for finally blocks
+        PendingJump take_pending_jump();
+        void restore_pending_jump(const PendingJump& jump);
+
+        // tail calls
+        void set_tail_call(AST* function, PyObject arguments);
+        AST* take_tail_call();
 };
 
 class Stack {
     private:
         vector<Frame*> frames;
+        static int recursion_limit;
+        // exceptions being handled by an except block, innermost last
+        vector<PyObject> handled_exceptions;
     public:
 
         Stack();
 
+        static void set_recursion_limit(int limit);
+        static int get_recursion_limit();
+
         // === ast management ===
         // functions
-        PyObject call_global(AST* functiondef);
-        PyObject call_function(PyObject func_name, PyObject arguments);
+        PyObject call_global(AST* functiondef, PyObject arguments);
+        PyObject call_function(PyObject function, PyObject arguments);
+        void tail_call(PyObject function, PyObject arguments);
         string get_function_name();
         PyObject next_param();
         void add_function(AST* function);
         // locals
-        void assign(PyObject name, PyObject value);
-        PyObject get_value(string name);
+        void assign(Symbol name, PyObject value);
+        PyObject& get_slot(Symbol name);
+        PyObject& get_ref(Symbol name);
+        PyObject& get_local_ref(Symbol name);
+        PyObject get_value(Symbol name);
         // for ReturnStmt
         void set_return_value(PyObject value);
         bool is_returning();
+        // for loops
+        void set_breaking();
+        void set_continuing();
+        bool is_breaking();
+        bool is_continuing();
+        void clear_loop_flags();
+        bool is_unwinding();
+        PendingJump take_pending_jump();
+        void restore_pending_jump(const PendingJump& jump);
+        // for TryStmt and bare 'raise'
+        void push_handled_exception(PyObject exception);
+        void pop_handled_exception();
+        PyObject current_exception();
 
         // === frame management ===
         void clean();
@@ -79,4 +138,8 @@ class Stack {
         void pop_frame();
 };
 
+// runs fn on a heap allocated native stack segment, call_global() takes
+// another one whenever the current segment is nearly full
+void run_with_call_stack(function<void()> fn);
+
 #endif
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "tracer.h"
+#include "pyexception.h"
+#include "stack.h"
+using namespace std;
+
+
+TraceHook Tracer::trace_hook = nullptr;
+void* Tracer::trace_data = nullptr;
+TraceHook Tracer::profile_hook = nullptr;
+void* Tracer::profile_data = nullptr;
+PyObject Tracer::trace_function;
+PyObject Tracer::profile_function;
+bool Tracer::in_hook = false;
+bool Tracer::active = false;
+
+// the arg of call and line events, built once since line events come
+// with every statement
+static const PyObject none;
+
+void Tracer::update_active() {
+    active = trace_hook != nullptr || profile_hook != nullptr;
+}
+
+void Tracer::settrace(TraceHook hook, void* data) {
+    trace_hook = hook;
+    trace_data = data;
+    trace_function = PyObject();
+    update_active();
+}
+
+void Tracer::setprofile(TraceHook hook, void* data) {
+    profile_hook = hook;
+    profile_data = data;
+    profile_function = PyObject();
+    update_active();
+}
+
+// a python hook gets (frame, event, arg). there are no frame objects,
+// the frame is a (function name, line) tuple. what the hook returns is
+// ignored, it gets every event rather than returning a local tracer
+static void call_python_hook(Stack& stack, TraceEvent event, int line, const PyObject& arg, void* data) {
+    string name = stack.get_function_name();
+    vector<PyObject> frame = {PyObject(name == "" ? string("<module>") : name, "str"), PyObject(line, "int")};
+    vector<PyObject> args = {
+        PyObject(frame, "tuple"),
+        PyObject(Tracer::event_name(event), "str"),
+        arg,
+    };
+    stack.call_function(*static_cast<PyObject*>(data), PyObject(args, "tuple"));
+}
+
+void Tracer::settrace(PyObject function) {
+    if (function.type == "None") {
+        settrace(nullptr);
+        return;
+    }
+    if (!function.is_callable()) {
+        throw PyException("TypeError", "settrace() argument must be callable or None");
+    }
+    settrace(call_python_hook, &trace_function);
+    trace_function = function;
+}
+
+void Tracer::setprofile(PyObject function) {
+    if (function.type == "None") {
+        setprofile(nullptr);
+        return;
+    }
+    if (!function.is_callable()) {
+        throw PyException("TypeError", "setprofile() argument must be callable or None");
+    }
+    setprofile(call_python_hook, &profile_function);
+    profile_function = function;
+}
+
+PyObject Tracer::gettrace() {
+    return trace_function;
+}
+
+PyObject Tracer::getprofile() {
+    return profile_function;
+}
+
+string Tracer::event_name(TraceEvent event) {
+    switch (event) {
+        case TRACE_CALL: return "call";
+        case TRACE_LINE: return "line";
+        case TRACE_RETURN: return "return";
+    }
+    return "?";
+}
+
+void Tracer::dispatch(Stack& stack, TraceEvent event, int line, const PyObject& arg) {
+    if (in_hook) {
+        return;
+    }
+    in_hook = true;
+    bool profiling = false;
+    try {
+        if (trace_hook != nullptr) {
+            trace_hook(stack, event, line, arg, trace_data);
+        }
+        if (profile_hook != nullptr && event != TRACE_LINE) {
+            profiling = true;
+            profile_hook(stack, event, line, arg, profile_data);
+        }
+    } catch (...) {
+        // a hook that raises is removed, then the error goes on
+        in_hook = false;
+        if (profiling) setprofile(nullptr);
+        else settrace(nullptr);
+        throw;
+    }
+    in_hook = false;
+}
+
+void Tracer::call(Stack& stack, int line) {
+    dispatch(stack, TRACE_CALL, line, none);
+}
+
+void Tracer::line(Stack& stack, int line) {
+    dispatch(stack, TRACE_LINE, line, none);
+}
+
+void Tracer::ret(Stack& stack, int line, const PyObject& value) {
+    dispatch(stack, TRACE_RETURN, line, value);
+}
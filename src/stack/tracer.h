@@ -0,0 +1,62 @@
+#pragma once
+#include "stack.fwd.h"
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <string>
+#include "pyobject.h"
+using namespace std;
+
+enum TraceEvent {
+    TRACE_CALL,
+    TRACE_LINE,
+    TRACE_RETURN
+};
+
+// a C++ hook: the stack the event happened on, the event, its line and
+// for a return the value returned (None for the others)
+typedef void (*TraceHook)(Stack& stack, TraceEvent event, int line, const PyObject& arg, void* data);
+
+// sys.settrace/sys.setprofile for the evaluator. Statement::evaluate and
+// Stack::call_global test 'active' and call in only when it is set, so
+// with no hook installed tracing costs that one branch. A trace hook
+// sees call, line and return events, a profile hook call and return.
+// Lines are the ones the statements' first tokens were on, a call is
+// reported on its def line and a return on the last line run
+class Tracer {
+    private:
+        static TraceHook trace_hook;
+        static void* trace_data;
+        static TraceHook profile_hook;
+        static void* profile_data;
+        // set by the settrace()/setprofile() builtins
+        static PyObject trace_function;
+        static PyObject profile_function;
+        // hooks are not traced, like CPython
+        static bool in_hook;
+
+        static void update_active();
+        static void dispatch(Stack& stack, TraceEvent event, int line, const PyObject& arg);
+
+    public:
+        static bool active;
+
+        // nullptr removes the hook
+        static void settrace(TraceHook hook, void* data = nullptr);
+        static void setprofile(TraceHook hook, void* data = nullptr);
+        // a python function called as f(frame, event, arg), None removes it
+        static void settrace(PyObject function);
+        static void setprofile(PyObject function);
+        static PyObject gettrace();
+        static PyObject getprofile();
+
+        static string event_name(TraceEvent event);
+
+        // the evaluator's side, only called while active
+        static void call(Stack& stack, int line);
+        static void line(Stack& stack, int line);
+        static void ret(Stack& stack, int line, const PyObject& value);
+};
+
+#endif
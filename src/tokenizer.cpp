@@ -7,6 +7,7 @@
 #include <string>
 #include <tuple>
 #include "logging.h"
+#include "memstats.h"
 #include "util.h"
 #include "token.h"
 #include "tokenizer.h"
@@ -64,8 +65,25 @@ string sub(string s, int prev, int i) {
     return _sub(s, prev, i);
 }
 
+// the sign in 1.5e-05, a '+' or '-' right after the e of a number literal
+bool is_exponent_sign(const string& line, int i) {
+    if (i < 2 || i+1 >= line.size() || !isdigit(line[i+1])) {
+        return false;
+    }
+    if (line[i-1] != 'e' && line[i-1] != 'E') {
+        return false;
+    }
+    int start = i-1;
+    while (start > 0 && (isdigit(line[start-1]) || line[start-1] == '.')) {
+        start--;
+    }
+    // 'x1e-5' is a name minus five
+    bool literal = start < i-1 && (start == 0 || !(isalnum(line[start-1]) || line[start-1] == '_'));
+    return literal && line.find_first_of("0123456789", start) < i-1;
+}
+
 string get_type(string s) {
-	string ops = "&|;:,.()+-=*/%[]<>";
+	string ops = "&|^~;:,.()+-=*/%[]{}<>!";
     if (ops.find(s) != string::npos) {
         return "OP";
     }
@@ -105,6 +123,7 @@ bool Tokenizer::should_append_op(char c1, char c2, char c3) {
     }
     else if (c1 == '-') {
         if (c2 == '=') return true;  // -=
+        if (c2 == '>') return true;  // ->
     }
     else if (c1 == '*') {
         if (c2 == '=') return true;  // *=
@@ -114,11 +133,22 @@ bool Tokenizer::should_append_op(char c1, char c2, char c3) {
         if (c2 == '=') return true;  // /=
         if (c2 == '/') return true;  // //
     }
+    else if (c1 == '%') {
+        if (c2 == '=') return true;  // %=
+    }
     else if (c1 == '>') {
         if (c2 == '=') return true;  // >=
+        if (c2 == '>') return true;  // >>
     }
     else if (c1 == '<') {
         if (c2 == '=') return true;  // <=
+        if (c2 == '<') return true;  // <<
+    }
+    else if (c1 == '!') {
+        if (c2 == '=') return true;  // !=
+    }
+    else if (c1 == '&' || c1 == '|' || c1 == '^') {
+        if (c2 == '=') return true;  // &=, |=, ^=
     }
     else if (c1 == '.') {
         if (c2 == '.' && c3 == '.') return true;  // ..
@@ -134,6 +164,11 @@ bool Tokenizer::tokenize_default(int ln, int& prev, int i) {
     int temp_i;
     char c1, c2, c3;
 
+    // spaces left over from the previous token
+    while (prev < i && input[ln][prev] == ' ') {
+        prev++;
+    }
+
     // check for 2+ character ops, push if found
     if (special_delimiters.find(input[ln][prev]) != string::npos) {
         c1 = input[ln][prev];
@@ -149,10 +184,18 @@ bool Tokenizer::tokenize_default(int ln, int& prev, int i) {
             }
             else if (input[ln][i] != '.') {
                 temp_s = string(1, c1) + c2;
+                if (c3 == '=' && (temp_s == "**" || temp_s == "//" || 
+                                  temp_s == "<<" || temp_s == ">>")) {
+                    temp_s += c3;  // **=, //=, <<=, >>=
+                }
                 if (DEBUG_TOK) cout << "pushed in default 2: '" << temp_s << "'" << endl;
                 tokens.push_back(
-                    Token(get_type(temp_s), temp_s, {ln+1, prev}, {ln+1, prev+2}));
-                prev = i+1;
+                    Token(get_type(temp_s), temp_s, {ln+1, prev}, {ln+1, prev+(int)temp_s.size()}));
+                prev += temp_s.size();
+            }
+            // skip the spaces after the op, otherwise they end up in the next token
+            while (prev < input[ln].size() && input[ln][prev] == ' ') {
+                prev++;
             }
             return false;
         }
@@ -206,7 +249,8 @@ void Tokenizer::tokenize_string(int ln, int& prev, int i, bool& in_str,
             // dont want to ommit leading whitespace, prev = code_start at this point
             str_value += sub(input[ln], 0, i);
         }
-        else {
+        else if (i > prev) {
+            // NOTE: sub() returns a char even when prev == i, "" is empty
             str_value += sub(input[ln], prev, i);
         }
         str_value += termination_char;
@@ -377,6 +421,7 @@ void Tokenizer::eof(int ln, int prev, vector<int> indents) {
 
 
 void Tokenizer::tokenize() {
+    MemScope mem_scope(MEM_TOKENS);
     const string whitespace = "\n\r\t ";
     vector<int> indents{0};
 
@@ -443,6 +488,10 @@ void Tokenizer::tokenize() {
                     // 1.00 vs var.attr, continue on floating point cases
                     continue;
                 }
+                else if ((input[ln][i] == '+' || input[ln][i] == '-') && !in_str
+                         && is_exponent_sign(input[ln], i)) {
+                    continue;
+                }
                 else if (input[ln][i] == '\r' || i == input[ln].size()-1) {
                     // reached end of line
                     end_of_line(ln, prev, i, in_str, string_line_start, str_value);
@@ -500,9 +549,9 @@ int Tokenizer::size() {
     return this->length;
 }
 
-void Tokenizer::print() {
-    for (Token t : this->tokens) {
-        cout << t << endl;
+void Tokenizer::print(ostream& os) {
+    for (const Token& t : this->tokens) {
+        os << t << '\n';
     }
 }
 
@@ -518,19 +567,26 @@ void Tokenizer::strip() {
     // for COMMENT's, the NEWLINE following also needs removed
     int before = tokens.size();
 
-    tokens.erase(
-        remove_if(tokens.begin(), tokens.end(), [](Token t){return t.type == "NL";})
-        , tokens.end());
-    auto it = tokens.begin();
-    while (it != tokens.end()) {
-        if (it->type == "COMMENT") {
-            it = tokens.erase(it);
-            if (it->type == "NEWLINE") it = tokens.erase(it);
+    // one pass that moves the kept tokens down, erasing them one at a
+    // time shifted the rest of the vector each time
+    size_t kept = 0;
+    bool after_comment = false;
+    for (size_t i=0; i < tokens.size(); i++) {
+        const string& type = tokens[i].type;
+        if (type == "NL") continue;
+        if (type == "COMMENT") {
+            after_comment = true;
+            continue;
         }
-        else {
-            it++;
+        if (after_comment) {
+            after_comment = false;
+            if (type == "NEWLINE") continue;
         }
+        if (kept != i) tokens[kept] = move(tokens[i]);
+        kept++;
     }
+    tokens.erase(tokens.begin() + kept, tokens.end());
+    length = tokens.size();
 
     Logger::get_instance()->log("strip() before = " + to_string(before) 
                                 + ", after = " + to_string(tokens.size()), DEBUG);
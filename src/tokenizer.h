@@ -1,6 +1,7 @@
 #ifndef TOKENIZER_H
 #define TOKENIZER_H
 
+#include <iostream>
 #include <string>
 #include <vector>
 #include "token.h"
@@ -12,9 +13,9 @@ class Tokenizer {
 		vector<Token> tokens;
 		int length, pos;
 
-		const string delimiters = "\"'&|;:,.()+-=*/%[]#<>*";
-		const string delimiters_not_string = "&|;:,.()+-=*/%[]#<>*";
-		const string special_delimiters = "=.+-*/";  // 2+ char op's
+		const string delimiters = "\"'&|^~;:,.()+-=*/%[]{}#<>*!";
+		const string delimiters_not_string = "&|;:,.()+-=*/%[]{}#<>*!";
+		const string special_delimiters = "=.+-*/%<>!&|^";  // 2+ char op's
 
 		// tokenize helpers
 		bool is_delim(char c);
@@ -41,7 +42,7 @@ class Tokenizer {
 		void begin();
 		void reset();
 		int size();
-		void print();
+		void print(ostream& os = cout);
 		void log();
 
 		void strip();
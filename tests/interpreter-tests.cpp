@@ -1,4 +1,5 @@
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_NO_POSIX_SIGNALS  // glibc 2.34+ made MINSIGSTKSZ non-constant
 #include "../lib/catch.hpp"
 
 #include <string>
@@ -11,149 +12,524 @@
 #include "ast.h"
 #include "interpreter.h"
 #include "stack.h"
+#include "coverage.h"
+#include "ast_dump.h"
 
 
 // TODO: write many, many, test cases
-// NOTE: this will break when I change interpret
-
-
-// EXAMPLE CODE FOR LATER WHEN I WRITE MORE CASES
-/*
-tuple<PyObject, string> run_test_string(string s) {
-	vector<string> tmp_vec;
-	tmp_vec.push_back(s);
-
-	cout << "\ninitial input:" << endl;
-	cout << s << endl;
-
-	Tokenizer tokenizer(tmp_vec);
-	if (PRINT_TOKENS) {
-		Token token;
-		cout << "tokens:" << endl;
-		if (tokenizer.size() == 0) {
-			cout << "empty" << endl << endl;
-			return tuple<PyObject, string>(PyObject(), "");
-		}
-		while ((token = tokenizer.next_token()).value != "EOF") {
-			cout << token.line_num << ": " << token.value << endl;
-		}
-		cout << endl;
-	}
-
-	Parser parser(&tokenizer);
-    Statements parse_tree = parser.parse();
-	cout << "running parse_tree:\n" << parse_tree << endl << endl;
-
-	stringstream buffer;
-	streambuf *old = cout.rdbuf(buffer.rdbuf());
-
-	Stack stack;
-    PyObject res = interpret(parse_tree, stack);
-
-	string stdout_res = buffer.str();
-	cout.rdbuf(old);
-
-	return tuple<PyObject, string>(res, stdout_res);
-}
-*/
-
-/*
-// some hard coded tests
-    vector<string> contents;
-    contents.push_back("1.0 - 1.0 - 1.0 * 1.0");
-    contents.push_back("1 - 1.0");
-    contents.push_back("print(\"1+2\")");
-    contents.push_back("print(\"1+2:\", 1+2)");
-    
-    for (int i=0; i < contents.size(); i++) {
-        cout << "==============" << endl;
-        tuple<PyObject, string> res = run_test_string(contents.at(i));
-        cout << "result:\n" << get<0>(res).as_string() << endl;
-        if (get<1>(res) != "") {
-            cout << "\nstdout_res:\n" << get<1>(res) << endl;
-        }
-        if (i < contents.size()-1) {
-            cout << endl;
-        }
+
+// runs a single line in interactive mode so the value of the expression
+// comes back, stdout is captured and returned alongside it
+tuple<PyObject, string> run_line(string line) {
+    Tokenizer tokenizer;
+    tokenizer.tokenize_input(line + "\r\n");
+    Parser parser(&tokenizer);
+    Interactive* parse_tree = dynamic_cast<Interactive*>(parser.parse("interactive"));
+
+    stringstream buffer;
+    streambuf *old = cout.rdbuf(buffer.rdbuf());
+
+    Stack stack;
+    PyObject res;
+    try {
+        res = (*parse_tree).evaluate(stack);
+    } catch (exception& e) {
+        cout.rdbuf(old);
+        delete parse_tree;
+        throw;
     }
-    cout << "==============" << endl;
-    cout << "Done." << endl;
-*/
 
-TEST_CASE("Interpreter Test - 1 + 2", "[interpreter]") {
-    vector<string> contents{"1 + 2"};
-	Tokenizer tokenizer(contents);
+    cout.rdbuf(old);
+    delete parse_tree;
+    return tuple<PyObject, string>(res, buffer.str());
+}
+
+// runs a whole program in file mode, returns stdout
+string run_lines(vector<string> lines) {
+    for (string& line : lines) line += "\r";  // see read_lines()
+    Tokenizer tokenizer(lines);
+    tokenizer.strip();
     Parser parser(&tokenizer);
-    Statements parse_tree = parser.parse();
+    File* parse_tree = dynamic_cast<File*>(parser.parse("file"));
+
+    stringstream buffer;
+    streambuf *old = cout.rdbuf(buffer.rdbuf());
+
     Stack stack;
-    PyObject res = interpret(parse_tree, stack);
+    try {
+        (*parse_tree).evaluate(stack);
+    } catch (exception& e) {
+        cout.rdbuf(old);
+        delete parse_tree;
+        throw;
+    }
+
+    cout.rdbuf(old);
+    delete parse_tree;
+    return buffer.str();
+}
+
+TEST_CASE("Interpreter Test - 1 + 2", "[interpreter]") {
+    PyObject res = get<0>(run_line("1 + 2"));
     REQUIRE( res == PyObject(3, "int") );
 }
 
 TEST_CASE("Interpreter Test - 1 - 2", "[interpreter]") {
-    vector<string> contents{"1 - 2"};
-	Tokenizer tokenizer(contents);
-    Parser parser(&tokenizer);
-    Statements parse_tree = parser.parse();
-    Stack stack;
-    PyObject res = interpret(parse_tree, stack);
+    PyObject res = get<0>(run_line("1 - 2"));
     REQUIRE( res == PyObject(-1, "int") );
 }
 
 TEST_CASE("Interpreter Test - 1 * 2", "[interpreter]") {
-    vector<string> contents{"1 * 2"};
-	Tokenizer tokenizer(contents);
-    Parser parser(&tokenizer);
-    Statements parse_tree = parser.parse();
-    Stack stack;
-    PyObject res = interpret(parse_tree, stack);
+    PyObject res = get<0>(run_line("1 * 2"));
     REQUIRE( res == PyObject(2, "int") );
 }
 
 TEST_CASE("Interpreter Test - 1.0 * 2", "[interpreter]") {
-    vector<string> contents{"1.0 * 2"};
-	Tokenizer tokenizer(contents);
-    Parser parser(&tokenizer);
-    Statements parse_tree = parser.parse();
-    Stack stack;
-    PyObject res = interpret(parse_tree, stack);
+    PyObject res = get<0>(run_line("1.0 * 2"));
     REQUIRE( res == PyObject(2.0, "float") );
 }
 
 TEST_CASE("Interpreter Test - print(1 + 2)", "[interpreter]") {
-    vector<string> contents{"print(1 + 2)"};
-	Tokenizer tokenizer(contents);
-    Parser parser(&tokenizer);
-    Statements parse_tree = parser.parse();
+    tuple<PyObject, string> res = run_line("print(1 + 2)");
+    REQUIRE( get<0>(res) == PyObject() );
+    REQUIRE( get<1>(res) == "3\n" );
+}
 
-    stringstream buffer;
-	streambuf *old = cout.rdbuf(buffer.rdbuf());
+TEST_CASE("Interpreter Test - print(1 - 2 + 1.0)", "[interpreter]") {
+    tuple<PyObject, string> res = run_line("print(1 - 2 + 1.0)");
+    REQUIRE( get<0>(res) == PyObject() );
+    REQUIRE( get<1>(res) == "0.0\n" );
+}
 
-    Stack stack;
-    PyObject res = interpret(parse_tree, stack);
+TEST_CASE("Interpreter Test - functions are objects", "[interpreter]") {
+    string out = run_lines({
+        "def add(a, b):",
+        "    return a + b",
+        "def apply(f, x, y):",
+        "    return f(x, y)",
+        "print(apply(add, 1, 2))",
+        "print(apply(print, 1, 2))",
+        "print(add)",
+        "print(print)",
+    });
+    REQUIRE( out == "3\n1 2\nNone\n<function add>\n<built-in function print>\n" );
+}
 
-    string stdout_res = buffer.str();
-	cout.rdbuf(old);
+TEST_CASE("Interpreter Test - calling errors", "[interpreter]") {
+    REQUIRE_THROWS_WITH( run_line("1(2)"), "TypeError: 'int' object is not callable" );
+    REQUIRE_THROWS_WITH( run_lines({"def f(a):", "    return a", "f(1, 2)"}),
+        "TypeError: f() takes 1 positional arguments but 2 were given" );
+}
 
-    REQUIRE( res == PyObject() );
-    REQUIRE( stdout_res == "3\n" );
+TEST_CASE("Interpreter Test - tail calls reuse the frame", "[interpreter]") {
+    Stack::set_recursion_limit(100);
+    string out = run_lines({
+        "def loop(n, acc):",
+        "    if n < 1:",
+        "        return acc",
+        "    return loop(n - 1, acc + 2)",
+        "print(loop(5000, 0))",
+    });
+    Stack::set_recursion_limit(DEFAULT_RECURSION_LIMIT);
+    REQUIRE( out == "10000\n" );
 }
 
-TEST_CASE("Interpreter Test - print(1 - 2 + 1.0)", "[interpreter]") {
-    vector<string> contents{"print(1 - 2 + 1.0)"};
-	Tokenizer tokenizer(contents);
-    Parser parser(&tokenizer);
-    Statements parse_tree = parser.parse();
+TEST_CASE("Interpreter Test - deep recursion", "[interpreter]") {
+    vector<string> program = {
+        "def count(n):",
+        "    if n < 1:",
+        "        return 0",
+        "    return 1 + count(n - 1)",
+        "print(count(20000))",
+    };
+    string out;
+    run_with_call_stack([&]() { out = run_lines(program); });
+    REQUIRE( out == "20000\n" );
+    // the calls move to new segments, no stack is sized up front
+    REQUIRE( run_lines(program) == "20000\n" );
 
-    stringstream buffer;
-	streambuf *old = cout.rdbuf(buffer.rdbuf());
+    Stack::set_recursion_limit(1000);
+    REQUIRE_THROWS_WITH( run_lines(program), "RecursionError: maximum recursion depth exceeded" );
+    // the limit counts calls, not the module frame, count(999) makes 1000
+    program.back() = "print(count(999))";
+    REQUIRE( run_lines(program) == "999\n" );
+    program.back() = "print(count(1000))";
+    REQUIRE_THROWS_WITH( run_lines(program), "RecursionError: maximum recursion depth exceeded" );
+    Stack::set_recursion_limit(DEFAULT_RECURSION_LIMIT);
+}
 
-    Stack stack;
-    PyObject res = interpret(parse_tree, stack);
+TEST_CASE("Interpreter Test - for loops", "[interpreter]") {
+    string out = run_lines({
+        "for i in range(3):",
+        "    print(i)",
+        "for c in 'ab':",
+        "    print(c)",
+        "for a, b in [(1, 2), (3, 4)]:",
+        "    print(a + b)",
+        "for i in range(10, 0, -4):",
+        "    print(i)",
+        "print(i)",
+    });
+    REQUIRE( out == "0\n1\n2\na\nb\n3\n7\n10\n6\n2\n2\n" );
+}
 
-    string stdout_res = buffer.str();
-	cout.rdbuf(old);
+TEST_CASE("Interpreter Test - break, continue and else", "[interpreter]") {
+    string out = run_lines({
+        "for x in [1, 2, 3, 4]:",
+        "    if x == 2:",
+        "        continue",
+        "    if x == 4:",
+        "        break",
+        "    print(x)",
+        "else:",
+        "    print('not reached')",
+        "for x in []:",
+        "    pass",
+        "else:",
+        "    print('empty')",
+        "while True:",
+        "    print('once')",
+        "    break",
+    });
+    REQUIRE( out == "1\n3\nempty\nonce\n" );
+    REQUIRE_THROWS_WITH( run_lines({"break"}), "SyntaxError: 'break' outside loop" );
+}
 
-    REQUIRE( res == PyObject() );
-    REQUIRE( stdout_res == "0.0\n" );
+TEST_CASE("Interpreter Test - constants", "[interpreter]") {
+    REQUIRE( get<1>(run_line("print(None, [None], None == None)")) == "None [None] True\n" );
+    REQUIRE_THROWS_WITH( run_line("None = 1"), "SyntaxError: cannot assign to None" );
+    REQUIRE_THROWS_WITH( run_line("True = 1"), "SyntaxError: cannot assign to True" );
+    REQUIRE_THROWS_WITH( run_lines({"for None in []:", "    pass"}), "SyntaxError: cannot assign to None" );
+    REQUIRE_THROWS_WITH( run_lines({"def f(None):", "    pass"}), "SyntaxError: cannot assign to None" );
+}
+
+TEST_CASE("Interpreter Test - range", "[interpreter]") {
+    REQUIRE( get<1>(run_line("print(range(4), range(1, 9, 2))")) == "range(0, 4) range(1, 9, 2)\n" );
+    REQUIRE( get<0>(run_line("range(0, 10, 3)")).size() == 4 );
+    REQUIRE_THROWS_WITH( run_line("range(1, 2, 0)"), "ValueError: range() arg 3 must not be zero" );
+    REQUIRE( run_lines({"r = range(2**31 + 5)",
+                        "print(len(r), r[-1], 2**31 in r, list(range(2**63 - 3, 2**63 - 1, 5)))"})
+             == "2147483653 2147483652 True [9223372036854775805]\n" );
+    REQUIRE_THROWS_WITH( run_line("range(2**64)"), "OverflowError: Python int too large to convert to C long" );
+}
+
+TEST_CASE("Interpreter Test - assignment", "[interpreter]") {
+    string out = run_lines({
+        "a = b = 2",
+        "a, b = b, a + 1",
+        "print(a, b)",
+        "(c, [d, e]), f = (1, [2, 3]), 4",
+        "print(c + d + e + f)",
+        "m = [[1, 2], [3, 4]]",
+        "m[1][0] = 9",
+        "m[-1][-1] = 'x'",
+        "print(m)",
+        "k = 1,",
+        "print(k)",
+    });
+    REQUIRE( out == "2 3\n10\n[[1, 2], [9, 'x']]\n(1,)\n" );
+    REQUIRE_THROWS_WITH( run_line("a, b = 1, 2, 3"), "ValueError: too many values to unpack (expected 2)" );
+    REQUIRE_THROWS_WITH( run_lines({"t = (1, 2)", "t[0] = 3"}), "TypeError: 'tuple' object does not support item assignment" );
+}
+
+TEST_CASE("Interpreter Test - augmented assignment", "[interpreter]") {
+    string out = run_lines({
+        "n = 0",
+        "s = 'a'",
+        "li = [1]",
+        "while n < 9:",
+        "    n += 3",
+        "    s += 'b'",
+        "    li += [n]",
+        "li[-1] *= 2",
+        "n **= 2",
+        "print(n, s, li)",
+    });
+    REQUIRE( out == "81 abbb [1, 3, 6, 18]\n" );
+    REQUIRE_THROWS_WITH( run_lines({"x = 1", "def f():", "    x += 1", "f()"}),
+        "UnboundLocalError: local variable 'x' referenced before assignment" );
+}
+
+TEST_CASE("Interpreter Test - try, except and finally", "[interpreter]") {
+    string out = run_lines({
+        "def parse(s):",
+        "    try:",
+        "        return int(s)",
+        "    except ValueError:",
+        "        return -1",
+        "print(parse('12'), parse('x'))",
+        "try:",
+        "    [1][3]",
+        "except (KeyError, IndexError) as e:",
+        "    print(e)",
+        "else:",
+        "    print('not reached')",
+        "finally:",
+        "    print('finally')",
+        "def f(n):",
+        "    if n == 0:",
+        "        raise KeyError('deep')",
+        "    return f(n - 1)",
+        "try:",
+        "    f(20)",
+        "except LookupError as e:",
+        "    print(e)",
+    });
+    REQUIRE( out == "12 -1\nlist index out of range\nfinally\n'deep'\n" );
+    REQUIRE_THROWS_WITH( run_lines({"try:", "    raise TypeError('t')", "except ValueError:", "    pass"}),
+        "TypeError: t" );
+    REQUIRE_THROWS_WITH( run_lines({"try:", "    raise ValueError", "except ValueError:", "    raise"}),
+        "ValueError" );
+    // errors raised by the interpreter carry their class, KeyError shows the key's repr
+    REQUIRE( run_lines({"try:", "    {1: 2}['1']", "except KeyError as e:", "    print(e)",
+                        "try:", "    'a' < 1", "except TypeError as e:", "    print(e)"})
+             == "'1'\n'<' not supported between instances of 'str' and 'int'\n" );
+}
+
+TEST_CASE("Interpreter Test - finally with return, break and continue", "[interpreter]") {
+    string out = run_lines({
+        "def g():",
+        "    try:",
+        "        return 1",
+        "    finally:",
+        "        print('g')",
+        "def k():",
+        "    try:",
+        "        raise TypeError",
+        "    finally:",
+        "        return 2",
+        "print(g(), k())",
+        "for i in range(4):",
+        "    try:",
+        "        if i == 1:",
+        "            continue",
+        "        if i == 2:",
+        "            break",
+        "    finally:",
+        "        print(i)",
+    });
+    REQUIRE( out == "g\n1 2\n0\n1\n2\n" );
+}
+
+TEST_CASE("Interpreter Test - lists are shared, not copied", "[interpreter]") {
+    string out = run_lines({
+        "a = [1, 2]",
+        "b = a",
+        "b[0] = 9",
+        "def f(li):",
+        "    li[1] = 'x'",
+        "    li += [3]",
+        "f(a)",
+        "t = (a, 0)",
+        "a += a",
+        "print(b, t[0][5])",
+    });
+    REQUIRE( out == "[9, 'x', 3, 9, 'x', 3] 3\n" );
+}
+
+TEST_CASE("Interpreter Test - dicts", "[interpreter]") {
+    string out = run_lines({
+        "d = {'b': 1, 2: 'two', (1, 2): [3]}",
+        "d['b'] += 10",
+        "d[1.0] = 'one'",
+        "d[True] = 'uno'",
+        "for k in d:",
+        "    print(k, d[k])",
+        "print(len(d), d[1])",
+    });
+    REQUIRE( out == "b 11\n2 two\n(1, 2) [3]\n1.0 uno\n4 uno\n" );
+    REQUIRE_THROWS_WITH( run_line("{}['a']"), "KeyError: 'a'" );
+    REQUIRE_THROWS_WITH( run_line("{[1]: 2}"), "TypeError: unhashable type: 'list'" );
+    // integral floats find the int keys they equal, past int64 too
+    string big = run_lines({
+        "print(1e18 in {10**18: 'a'}, 2.0**64 in {2**64: 'b'}, {-2**63: 'c'}[-2.0**63])",
+    });
+    REQUIRE( big == "True True c\n" );
+}
+
+TEST_CASE("Interpreter Test - sets", "[interpreter]") {
+    string out = run_lines({
+        "a = {1, 2, 3}",
+        "b = set([3, 4, 4])",
+        "print(a | b, a & b, a - b, a ^ b)",
+        "a -= {1}",
+        "a |= b",
+        "print(a == {4, 3, 2}, len(a), 1 in a, 4 not in a)",
+        "f = frozenset([2, 1])",
+        "g = f",
+        "f |= {3}",
+        "d = {frozenset({1, 2}): 'x'}",
+        "print(d[g], f == {1, 2, 3}, set())",
+    });
+    REQUIRE( out == "{1, 2, 3, 4} {3} {1, 2} {1, 2, 4}\n"
+                    "True 3 False False\n"
+                    "x True set()\n" );
+    REQUIRE( get<0>(run_line("1 < 2 < 3 > 4")) == PyObject(false, "bool") );
+    REQUIRE( get<0>(run_line("6 ^ 3 & 5")) == PyObject(7, "int") );
+    REQUIRE_THROWS_WITH( run_line("{[1]}"), "TypeError: unhashable type: 'list'" );
+    REQUIRE( run_lines({"print(1e18 in {10**18}, 2**64 in {2.0**64}, 1e300 in {10**300})"})
+             == "True True False\n" );
+}
+
+TEST_CASE("Interpreter Test - numeric lists", "[interpreter]") {
+    string out = run_lines({
+        "a = [3, 1, 2]",
+        "a[0] += 10",
+        "print(a, sum(a), min(a), max(a), sorted(a))",
+        "a[2] = 2.5",
+        "print(a, sum(a), 2.5 in a)",
+        "f = [0.5] * 2 + [1.5]",
+        "f += f",
+        "print(f, sum(f), max(f), sorted(f) == [0.5, 0.5, 0.5, 0.5, 1.5, 1.5])",
+        "print(list(range(4)), max(4, 9, 2), sorted((3, 1, 2)))",
+    });
+    REQUIRE( out == "[13, 1, 2] 16 1 13 [1, 2, 13]\n"
+                    "[13, 1, 2.5] 16.5 True\n"
+                    "[0.5, 0.5, 1.5, 0.5, 0.5, 1.5] 5.0 1.5 True\n"
+                    "[0, 1, 2, 3] 9 [1, 2, 3]\n" );
+    REQUIRE_THROWS_WITH( run_line("min([])"), "ValueError: min() arg is an empty sequence" );
+    // NaN has no order, the sort keeps it in bounds and puts it last
+    REQUIRE( run_lines({"n = 1e400 - 1e400",
+                        "print(sorted([3.0, n, 1.0, n, 2.0]), sorted([2, n, 1, 0.5]), sorted([0.0, -0.0]))"})
+             == "[1.0, 2.0, 3.0, nan, nan] [0.5, 1, 2, nan] [0.0, -0.0]\n" );
+    // the length is checked before anything is reserved
+    REQUIRE( run_lines({"print([] * 2**62, [3] * 2)", "try:", "    x = [0] * 2**62",
+                        "except MemoryError:", "    print('too big')"}) == "[] [3, 3]\ntoo big\n" );
+    REQUIRE_THROWS_WITH( run_line("[1, 2] * 2**62"), "MemoryError" );
+    REQUIRE_THROWS_WITH( run_line("[1.5] * 2**62"), "MemoryError" );
+}
+
+TEST_CASE("Interpreter Test - big ints", "[interpreter]") {
+    string out = run_lines({
+        "print(2 ** 64, 2 ** 100 // 3, 1 << 70)",
+        "print(9223372036854775807 + 1, -9223372036854775808 - 1)",
+        "print(int('123456789012345678901234567890') * 10 ** 10 % 7)",
+        "print(-7 // 2, -7 % 2, 7 % -2, 7 / 2, -7.5 % 2)",
+        "x = 2 ** 62",
+        "x += x",
+        "print(x, -x, ~x, x >> 62, x == 2 ** 63, x > 2 ** 62)",
+        "d = {2 ** 70: 'big'}",
+        "print(d[1 << 70], sum([x, x]), +True)",
+    });
+    REQUIRE( out == "18446744073709551616 422550200076076467165567735125 1180591620717411303424\n"
+                    "9223372036854775808 -9223372036854775809\n"
+                    "0\n"
+                    "-4 1 -1 3.5 0.5\n"
+                    "9223372036854775808 -9223372036854775808 -9223372036854775809 2 True True\n"
+                    "big 18446744073709551616 1\n" );
+    REQUIRE( get<0>(run_line("2.5 < 3")) == PyObject(true, "bool") );
+    REQUIRE( run_lines({"print(2**53 + 1 == 2.0**53, 2**53 + 1 > 2.0**53, 2**64 == 2.0**64, 10**400 > 1e308, -3 > -3.5)"})
+             == "False True True True True\n" );
+    REQUIRE_THROWS_WITH( run_line("1 // 0"), "ZeroDivisionError: integer division or modulo by zero" );
+    REQUIRE_THROWS_WITH( run_line("1 << -1"), "ValueError: negative shift count" );
+}
+
+TEST_CASE("Interpreter Test - float repr", "[interpreter]") {
+    string out = run_lines({
+        "print(0.1 + 0.2, 1 / 3, 2.0, -0.0, 100.0 * 3)",
+        "print(1e16, 1e15, 1.5e-5, 0.0001, 2 ** 0.5, 1e300 * 1e10)",
+        "print([0.5, 2.25], 12345.678, 5e-324)",
+    });
+    REQUIRE( out == "0.30000000000000004 0.3333333333333333 2.0 -0.0 300.0\n"
+                    "1e+16 1000000000000000.0 1.5e-05 0.0001 1.4142135623730951 inf\n"
+                    "[0.5, 2.25] 12345.678 5e-324\n" );
+}
+
+TEST_CASE("Interpreter Test - str and repr", "[interpreter]") {
+    string out = run_lines({
+        "print(['a', \"b'\"], ('x',), {'k': 1.5}, 'top', repr('top'))",
+        "print(frozenset({'q'}), set(), repr([1, 'x']), str(7) + '!')",
+    });
+    REQUIRE( out == "['a', \"b'\"] ('x',) {'k': 1.5} top 'top'\n"
+                    "frozenset({'q'}) set() [1, 'x'] 7!\n" );
+}
+
+TEST_CASE("Interpreter Test - print keywords", "[interpreter]") {
+    string out = run_lines({
+        "print(1, 2, 3, sep='-')",
+        "print('a', end='')",
+        "print('b', end='!\\n', flush=True)",
+        "print('x', None, sep=None, file=None)",
+        "print('tab\\there')",
+    });
+    REQUIRE( out == "1-2-3\nab!\nx None\ntab\there\n" );
+    REQUIRE_THROWS_WITH( run_line("print(1, bad=2)"), "TypeError: 'bad' is an invalid keyword argument for print()" );
+    REQUIRE_THROWS_WITH( run_line("len([1], x=2)"), "TypeError: len() takes no keyword arguments" );
+}
+
+TEST_CASE("Interpreter Test - builtin arguments", "[interpreter]") {
+    REQUIRE( get<0>(run_line("sum([1, 2], start=10)")).as_string() == "13" );
+    REQUIRE( get<0>(run_line("max(3, 7, 5)")).as_string() == "7" );
+    REQUIRE_THROWS_WITH( run_line("len()"), "TypeError: len() takes exactly one argument (0 given)" );
+    REQUIRE_THROWS_WITH( run_line("range(1, 2, 3, 4)"), "TypeError: range expected at most 3 arguments, got 4" );
+}
+
+TEST_CASE("Interpreter Test - tracemalloc", "[interpreter]") {
+    string out = run_lines({
+        "print(tracemalloc_is_tracing())",
+        "tracemalloc_start()",
+        "x = []",
+        "for i in range(100):",
+        "    x += [str(i) * 40]",
+        "current, peak = tracemalloc_get_traced_memory()",
+        "print(tracemalloc_is_tracing(), current > 4000, peak >= current)",
+        "tracemalloc_stop()",
+        "print(tracemalloc_is_tracing(), tracemalloc_get_traced_memory())",
+    });
+    REQUIRE( out == "False\nTrue True True\nFalse (0, 0)\n" );
+}
+
+TEST_CASE("Interpreter Test - settrace", "[interpreter]") {
+    string out = run_lines({
+        "def hook(frame, event, arg):",
+        "    print(event, frame[1], arg)",
+        "def add(a, b):",
+        "    return a + b",
+        "settrace(hook)",
+        "x = add(1, 2)",
+        "settrace(None)",
+        "setprofile(hook)",
+        "x = add(3, 4)",
+        "setprofile(None)",
+        "print(gettrace(), getprofile())",
+    });
+    REQUIRE( out == "line 6 None\ncall 3 None\nline 4 None\nreturn 4 3\nline 7 None\n"
+                    "call 3 None\nreturn 4 7\nNone None\n" );
+    REQUIRE_THROWS_WITH( run_line("settrace(1)"), "TypeError: settrace() argument must be callable or None" );
+}
+
+TEST_CASE("Interpreter Test - coverage", "[interpreter]") {
+    Coverage* coverage = Coverage::get_instance();
+    coverage->start("covered.py", true);
+    run_lines({
+        "def f(n):",
+        "    if n > 1:",
+        "        return n",
+        "    return 0",
+        "def g():",
+        "    return 1",
+        "for i in range(3):",
+        "    f(i)",
+    });
+    coverage->stop();
+    stringstream lcov;
+    coverage->write_lcov(lcov);
+    string out = lcov.str();
+    REQUIRE( out.find("FNDA:3,f\nFNDA:0,g\nFNF:2\nFNH:1\n") != string::npos );
+    REQUIRE( out.find("DA:2,3\nDA:3,1\nDA:4,2\nDA:5,1\nDA:6,0\nDA:7,1\nDA:8,3\nLF:8\nLH:7\n") != string::npos );
+}
+
+TEST_CASE("Interpreter Test - AST dump", "[interpreter]") {
+    vector<string> lines = {"x = 'a\"b'\r", "x += 1\r"};
+    Tokenizer tokenizer(lines);
+    tokenizer.strip();
+    Parser parser(&tokenizer);
+    AST* tree = parser.parse("file");
+    stringstream json;
+    dump_ast_json(*tree, json);
+    delete tree;
+    string out = json.str();
+    REQUIRE( out.find("{\"type\": \"File\", \"children\": [") == 0 );
+    REQUIRE( out.find("{\"type\": \"Name\", \"source\": \"x\"}") != string::npos );
+    REQUIRE( out.find("{\"type\": \"Op\", \"source\": \"+=\"}") != string::npos );
 }